@@ -0,0 +1,298 @@
+/// @file flock_bench.cpp
+/// @brief headless benchmark of the flock simulation, no Qt widget and no GL context is created. Reads the
+/// command line and runs one table, each in a flock_bench_*.cpp file of its own. flock_bench --help lists the options.
+/// @author Dionysios Toufexis
+/// @version 1.0
+/// @date 17/10/2026
+
+#include "flock_bench.h"
+#include "avoidance.h"
+#include "ThreadPool.h"
+#include "Tracer.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the options of every table, printed by --help and after an unknown option
+static void printUsage(FILE *_file)
+{
+    std::fprintf(_file,
+        "usage : flock_bench [options] [boid counts...]\n"
+        "        flock_bench --compare [--verify [--k n]] [--brute-max n] [--layout soa|aos|both] [boid counts...]\n"
+        "        flock_bench --policies | --dense [options] [boid counts...]\n"
+        "\n"
+        "every boid count is run at every thread count through the full Flock::update unless a table is picked\n"
+        "\n"
+        "tables\n"
+        "  --compare            the fused steering against the three rules, the grid against every pair and the\n"
+        "                       arrays against the old Boid layout on the bare FlockState\n"
+        "  --verify             with --compare, checks the steering variants, SIMD kernels, topological sums and threads\n"
+        "  --brute-max n        with --compare, the largest flock the all pairs scan is timed for (10000)\n"
+        "  --layout l           with --compare, soa, aos or both (both), to count the cache misses of one with perf stat\n"
+        "  --policies           the steering pipeline specialised for the rules in use against the generic one\n"
+        "  --dense              flocks in the default spawn cube, with the neighbour mode used and the peak memory\n"
+        "\n"
+        "runs\n"
+        "  --steps n            the timed steps (3 with --compare, 20 otherwise)\n"
+        "  --warmup n           the untimed steps run first (2)\n"
+        "  --threads a,b,..     the thread counts, the first is the base of the efficiency (1, 2, 4 .. hardware)\n"
+        "  --obstacles n        the obstacles in the box, the GUI obstacle included (1)\n"
+        "  --mesh file.obj      adds a mesh obstacle through its distance field, baked or mapped from its cache\n"
+        "  --mesh-resolution n  the cells along the longest side of the mesh (64)\n"
+        "  --skin d             the margin of the Verlet neighbour lists, 0 turns them off\n"
+        "  --mode m,..          metric, topological, approximate or both, timed one after the other (metric)\n"
+        "  --k n                the neighbours of the topological mode (7)\n"
+        "  --theta a            the opening angle of the approximate mode (0.5)\n"
+        "  --distance d         --flock-distance d  --cohesion w  --separation w  --alignment w\n"
+        "                       the behaviour parameters (20, 4, 2, 9, 10)\n"
+        "\n"
+        "output\n"
+        "  --json file          the report as JSON, - for stdout\n"
+        "  --record file        records the timed steps, times the copy, the dropped frames and the replay\n"
+        "  --codec file         encodes the timed steps, times the encoder, the ratio, the error and a seek\n"
+        "  --snapshot file      saves each flock, loads it back, checks it and times both\n"
+        "  --profile file       the phase times of every run, the last one as JSON (FLOCK_PROFILE builds)\n"
+        "  --trace file         the timeline of every thread as a Chrome trace (FLOCK_TRACE builds)\n"
+        "  --counters           the hardware events of every phase (FLOCK_PERF builds)\n"
+        "  --help               this text\n");
+}
+//----------------------------------------------------------------------------------------------------------------------
+void createFlock(FlockState &_state, int _count, unsigned int _seed)
+{
+    std::mt19937 rng(_seed);
+    float halfSide = 0.5f * std::cbrt(_count * s_volumePerBoid);
+    std::uniform_real_distribution<float> position(-halfSide, halfSide);
+    _state.clear();
+    _state.reserve(_count);
+    for(int i=0; i<_count; ++i)
+    {
+        float x = position(rng);
+        float y = position(rng);
+        float z = position(rng);
+        _state.addBoid(ngl::Vector(x, y, z));
+    }
+}
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the value below which _fraction of the sorted samples fall, nearest rank
+double percentile(const std::vector <double> &_sorted, double _fraction)
+{
+    int rank = (int)std::ceil(_fraction * _sorted.size()) - 1;
+    return _sorted[std::min(std::max(rank, 0), (int)_sorted.size() - 1)];
+}
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief splits a comma separated list of numbers
+static std::vector <int> parseList(const char *_list)
+{
+    std::vector <int> values;
+    std::string list(_list);
+    size_t start = 0;
+    while(start <= list.size())
+    {
+        size_t end = list.find(',', start);
+        if(end == std::string::npos)
+        {
+            end = list.size();
+        }
+        if(end > start)
+        {
+            values.push_back(std::atoi(list.substr(start, end - start).c_str()));
+        }
+        start = end + 1;
+    }
+    return values;
+}
+//----------------------------------------------------------------------------------------------------------------------
+int main(int argc, char **argv)
+{
+    FLOCK_TRACE_THREAD("main");
+    Options options;
+    bool compare = false;
+    bool policies = false;
+    bool dense = false;
+    for(int i=1; i<argc; ++i)
+    {
+        if(std::strcmp(argv[i], "--steps") == 0 && i + 1 < argc)
+        {
+            options.m_steps = std::max(1, std::atoi(argv[++i]));
+        }
+        else if(std::strcmp(argv[i], "--warmup") == 0 && i + 1 < argc)
+        {
+            options.m_warmup = std::max(0, std::atoi(argv[++i]));
+        }
+        else if(std::strcmp(argv[i], "--obstacles") == 0 && i + 1 < argc)
+        {
+            options.m_obstacles = std::max(1, std::atoi(argv[++i]));
+        }
+        else if(std::strcmp(argv[i], "--mesh") == 0 && i + 1 < argc)
+        {
+            options.m_mesh = argv[++i];
+        }
+        else if(std::strcmp(argv[i], "--mesh-resolution") == 0 && i + 1 < argc)
+        {
+            options.m_meshResolution = std::max(2, std::atoi(argv[++i]));
+        }
+        else if(std::strcmp(argv[i], "--skin") == 0 && i + 1 < argc)
+        {
+            options.m_skin = std::max(0.0f, (float)std::atof(argv[++i]));
+        }
+        else if(std::strcmp(argv[i], "--mode") == 0 && i + 1 < argc)
+        {
+            options.m_mode = argv[++i];
+        }
+        else if(std::strcmp(argv[i], "--theta") == 0 && i + 1 < argc)
+        {
+            options.m_theta = std::max(0.0f, (float)std::atof(argv[++i]));
+        }
+        else if(std::strcmp(argv[i], "--k") == 0 && i + 1 < argc)
+        {
+            options.m_k = std::max(1, std::atoi(argv[++i]));
+        }
+        else if(std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+        {
+            options.m_threads = parseList(argv[++i]);
+        }
+        else if(std::strcmp(argv[i], "--distance") == 0 && i + 1 < argc)
+        {
+            options.m_behaviourDistance = std::atof(argv[++i]);
+        }
+        else if(std::strcmp(argv[i], "--flock-distance") == 0 && i + 1 < argc)
+        {
+            options.m_flockDistance = std::atof(argv[++i]);
+        }
+        else if(std::strcmp(argv[i], "--cohesion") == 0 && i + 1 < argc)
+        {
+            options.m_cohesion = std::atof(argv[++i]);
+        }
+        else if(std::strcmp(argv[i], "--separation") == 0 && i + 1 < argc)
+        {
+            options.m_separation = std::atof(argv[++i]);
+        }
+        else if(std::strcmp(argv[i], "--alignment") == 0 && i + 1 < argc)
+        {
+            options.m_alignment = std::atof(argv[++i]);
+        }
+        else if(std::strcmp(argv[i], "--record") == 0 && i + 1 < argc)
+        {
+            options.m_record = argv[++i];
+        }
+        else if(std::strcmp(argv[i], "--snapshot") == 0 && i + 1 < argc)
+        {
+            options.m_snapshot = argv[++i];
+        }
+        else if(std::strcmp(argv[i], "--codec") == 0 && i + 1 < argc)
+        {
+            options.m_codec = argv[++i];
+        }
+        else if(std::strcmp(argv[i], "--trace") == 0 && i + 1 < argc)
+        {
+            options.m_trace = argv[++i];
+        }
+        else if(std::strcmp(argv[i], "--counters") == 0)
+        {
+            options.m_counters = true;
+        }
+        else if(std::strcmp(argv[i], "--profile") == 0 && i + 1 < argc)
+        {
+            options.m_profile = argv[++i];
+        }
+        else if(std::strcmp(argv[i], "--json") == 0 && i + 1 < argc)
+        {
+            options.m_json = argv[++i];
+        }
+        else if(std::strcmp(argv[i], "--compare") == 0)
+        {
+            compare = true;
+        }
+        else if(std::strcmp(argv[i], "--policies") == 0)
+        {
+            policies = true;
+        }
+        else if(std::strcmp(argv[i], "--dense") == 0)
+        {
+            dense = true;
+        }
+        else if(std::strcmp(argv[i], "--brute-max") == 0 && i + 1 < argc)
+        {
+            options.m_bruteMax = std::atoi(argv[++i]);
+        }
+        else if(std::strcmp(argv[i], "--verify") == 0)
+        {
+            options.m_verify = true;
+        }
+        else if(std::strcmp(argv[i], "--layout") == 0 && i + 1 < argc)
+        {
+            options.m_layout = argv[++i];
+        }
+        else if(argv[i][0] != '-')
+        {
+            std::vector <int> counts = parseList(argv[i]);
+            options.m_counts.insert(options.m_counts.end(), counts.begin(), counts.end());
+        }
+        else if(std::strcmp(argv[i], "--help") == 0 || std::strcmp(argv[i], "-h") == 0)
+        {
+            printUsage(stdout);
+            return EXIT_SUCCESS;
+        }
+        else
+        {
+            std::fprintf(stderr, "unknown option %s\n\n", argv[i]);
+            printUsage(stderr);
+            return EXIT_FAILURE;
+        }
+    }
+    if(options.m_counts.empty() && dense)
+    {
+        options.m_counts.push_back(5000);
+        options.m_counts.push_back(20000);
+    }
+    if(options.m_counts.empty())
+    {
+        options.m_counts.push_back(10000);
+        options.m_counts.push_back(100000);
+        if(compare)
+        {
+            options.m_counts.push_back(1000000);
+        }
+    }
+    if(options.m_steps == 0)
+    {
+        options.m_steps = compare ? 3 : 20;
+    }
+    if(options.m_threads.empty())
+    {
+        options.m_threads.push_back(1);
+        for(int threads=2; threads<=ThreadPool::hardwareThreads(); threads*=2)
+        {
+            options.m_threads.push_back(threads);
+        }
+    }
+
+    Avoidance avoidance;
+    if(!options.m_mesh.empty())
+    {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        if(!avoidance.load(options.m_mesh, options.m_meshResolution))
+        {
+            std::fprintf(stderr, "can not read %s\n", options.m_mesh.c_str());
+            return EXIT_FAILURE;
+        }
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        std::printf("mesh %s %s in %.1f ms, %dx%dx%d grid\n", options.m_mesh.c_str(), avoidance.fromCache() ? "mapped" : "baked",
+                    elapsed.count(), avoidance.getSize(0), avoidance.getSize(1), avoidance.getSize(2));
+        options.m_avoidance = &avoidance;
+    }
+
+    if(policies)
+    {
+        return runPolicies(options);
+    }
+    if(dense)
+    {
+        return runDense(options);
+    }
+    return compare ? runCompare(options) : runScaling(options);
+}
@@ -0,0 +1,156 @@
+#ifndef FLOCK_BENCH_H
+#define FLOCK_BENCH_H
+#include "flock.h"
+#include "PerfCounters.h"
+#include "TrajectoryRecorder.h"
+#include "TrajectoryEncoder.h"
+#include <cstdio>
+#include <string>
+#include <vector>
+
+/// @file flock_bench.h
+/// @brief the settings and results shared by the tables of flock_bench. Each table and each feature timed
+/// inside the scaling runs lives in a flock_bench_*.cpp file of its own, main in flock_bench.cpp picks one.
+/// @author Dionysios Toufexis
+/// @version 1.0
+/// @date 17/10/2026
+
+class Avoidance;
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the space given to every boid, about 20 neighbours fall inside the default behaviour distance of 20.
+const static float s_volumePerBoid = 1700.0f;
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the command line settings
+struct Options
+{
+    Options() : m_steps(0), m_warmup(2), m_obstacles(1), m_meshResolution(64), m_avoidance(0), m_skin(-1.0f), m_mode("metric"), m_k(7), m_theta(0.5f), m_bruteMax(10000), m_verify(false), m_layout("both"), m_counters(false),
+                m_behaviourDistance(20.0), m_flockDistance(4.0), m_cohesion(2.0), m_separation(9.0), m_alignment(10.0) {}
+    /// @brief the timed steps, 0 picks the default of the mode
+    int m_steps;
+    /// @brief the untimed steps run first so the pool and the caches are warm
+    int m_warmup;
+    /// @brief the number of obstacles in the box, the GUI obstacle included
+    int m_obstacles;
+    /// @brief the OBJ file of the mesh obstacle, empty for none, and the cells along its longest side
+    std::string m_mesh;
+    int m_meshResolution;
+    /// @brief the loaded distance field of m_mesh
+    const Avoidance *m_avoidance;
+    /// @brief the skin of the neighbour lists, negative keeps the default of the flock
+    float m_skin;
+    /// @brief the neighbour modes to time, the neighbour count of the topological mode and the opening angle of
+    /// the approximate one
+    std::string m_mode;
+    int m_k;
+    float m_theta;
+    int m_bruteMax;
+    bool m_verify;
+    std::string m_layout;
+    std::string m_json;
+    /// @brief the trajectory file the timed steps are recorded to, empty for none
+    std::string m_record;
+    /// @brief the snapshot file each run is saved to and loaded back from, empty for none
+    std::string m_snapshot;
+    /// @brief the quantised trajectory the timed steps are encoded to, empty for none
+    std::string m_codec;
+    /// @brief the file the profile of the last run is written to, empty for none
+    std::string m_profile;
+    /// @brief the file the trace of the runs is written to, empty for none
+    std::string m_trace;
+    /// @brief count the hardware events of the phases
+    bool m_counters;
+    std::vector <int> m_counts;
+    std::vector <int> m_threads;
+    double m_behaviourDistance;
+    double m_flockDistance;
+    double m_cohesion;
+    double m_separation;
+    double m_alignment;
+};
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the step times of one run of the full Flock::update
+struct RunResult
+{
+    int m_boids;
+    int m_threads;
+    Flock::NeighbourMode m_mode;
+    double m_meanMs;
+    double m_p50Ms;
+    double m_p99Ms;
+    double m_nsPerBoidStep;
+    /// @brief the speed up over the smallest thread count of the same flock size divided by the thread ratio
+    double m_efficiency;
+    /// @brief the skin of the neighbour lists, the rebuilds during the timed steps, the share of steps that reused the lists
+    /// and the mean list length of the last build
+    float m_skin;
+    unsigned long m_rebuilds;
+    double m_hitRate;
+    double m_listLength;
+    /// @brief with --record, the mean ms record took per step, the frames written and dropped and the mean ms
+    /// to pack a mapped frame for the renderer
+    double m_recordMs;
+    unsigned long m_recorded;
+    unsigned long m_dropped;
+    double m_replayMs;
+    /// @brief with --snapshot, the ms to save and load the flock, negative if it failed or came back different
+    double m_saveMs;
+    double m_loadMs;
+    /// @brief with --codec, the mean ms to encode a step, the raw position bytes over the stream bytes, the
+    /// largest error of the last frame, the bound it has to stay under and the mean ms to decode a random frame
+    double m_encodeMs;
+    double m_ratio;
+    double m_codecError;
+    double m_errorBound;
+    double m_seekMs;
+    /// @brief with --counters, the hardware events of each phase over the timed steps
+    PerfCounters::Stats m_counters[PerfCounters::PHASES];
+};
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief spreads _count boids at the benchmark density, the same flock for the same seed
+void createFlock(FlockState &_state, int _count, unsigned int _seed);
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the value below which _fraction of the sorted samples fall, nearest rank
+double percentile(const std::vector <double> &_sorted, double _fraction);
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the tables, each returns the exit code of the program
+/// @brief --compare, the steering variants and the two layouts on the bare FlockState, flock_bench_compare.cpp
+int runCompare(const Options &_options);
+/// @brief the default report, every boid count at every thread count through Flock::update, flock_bench_scaling.cpp
+int runScaling(const Options &_options);
+/// @brief --policies, the specialised steering pipeline against the generic one, flock_bench_policies.cpp
+int runPolicies(const Options &_options);
+/// @brief --dense, flocks in the default spawn cube and the memory they take, flock_bench_dense.cpp
+int runDense(const Options &_options);
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the files a scaling run writes its timed steps to, --record, --codec and --snapshot,
+/// flock_bench_streams.cpp
+struct Streams
+{
+    TrajectoryRecorder m_recorder;
+    TrajectoryEncoder m_encoder;
+    /// @brief the summed ms the recorder and the encoder took over the timed steps
+    double m_recordMs;
+    double m_encodeMs;
+};
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief opens the streams asked for on the command line, a file that can not be written is reported and skipped
+void openStreams(const Options &_options, int _threads, Streams &_streams);
+/// @brief hands a timed step to the open streams, the time it takes is kept apart from the step
+void recordStep(Streams &_streams, const FlockState &_state);
+/// @brief closes the streams, reads them back and fills the stream fields of _result, the snapshot of _flock
+/// is saved and loaded here too
+void closeStreams(const Options &_options, const Flock &_flock, float _box, int _threads, Streams &_streams, RunResult &_result);
+/// @brief the stream lines under a row of the table and the stream fields of a run in the JSON
+void printStreams(const Options &_options, const RunResult &_result);
+void writeStreamsJson(FILE *_file, const Options &_options, const RunResult &_result);
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the phase times of --profile and the hardware events of --counters, flock_bench_counters.cpp
+void printCountersStatus(const Options &_options);
+void readCounters(RunResult &_result);
+void printProfile();
+void printCounters(const RunResult &_result);
+void writeCountersJson(FILE *_file, const RunResult &_result);
+//----------------------------------------------------------------------------------------------------------------------
+
+#endif // FLOCK_BENCH_H
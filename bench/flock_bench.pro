@@ -0,0 +1,51 @@
+# headless benchmark of the flock simulation, no Qt and no GL context is created.
+# only libflocksim and NGL are linked, there is no GL, GLEW or Qt in the binary
+TEMPLATE = app
+CONFIG += console
+CONFIG -= qt app_bundle
+
+INCLUDEPATH += ../include
+
+OBJECTS_DIR = obj/
+
+TARGET = ../bin/flock_bench
+
+SOURCES += \
+    flock_bench.cpp \
+    flock_bench_compare.cpp \
+    flock_bench_scaling.cpp \
+    flock_bench_streams.cpp \
+    flock_bench_counters.cpp \
+    flock_bench_policies.cpp \
+    flock_bench_dense.cpp
+
+HEADERS += \
+    flock_bench.h
+
+# the simulation comes from libflocksim, build ../flocksim/flocksim_static.pro first with the same CONFIG
+LIBS += ../bin/libflocksim.a
+PRE_TARGETDEPS += ../bin/libflocksim.a
+
+QMAKE_CXXFLAGS+= -msse -msse2 -msse3 -std=c++0x
+macx:QMAKE_CXXFLAGS+= -arch x86_64
+# qmake CONFIG+=profile times the phases of Flock::update for --profile
+profile:DEFINES += FLOCK_PROFILE
+# qmake CONFIG+=trace records the timeline of every thread for a Chrome trace
+trace:DEFINES += FLOCK_TRACE
+# qmake CONFIG+=perf counts the hardware events of the phases of Flock::update
+perf:DEFINES += FLOCK_PERF
+
+LIBS += -L/usr/local/lib
+LIBS +=  -L/$(HOME)/NGL/lib -l NGL
+INCLUDEPATH += $$(HOME)/NGL/include/
+INCLUDEPATH += $$(HOME)/boost-trunk/
+
+linux-g++ {
+    DEFINES += LINUX
+    LIBS+= -lpthread
+}
+linux-g++-64 {
+    DEFINES += LINUX
+    LIBS+= -lpthread
+}
+macx:DEFINES += DARWIN
@@ -0,0 +1,407 @@
+/// @file flock_bench_compare.cpp
+/// @brief --compare times a bare neighbour pass on the FlockState through the spatial grid against the old all
+/// pairs scan, the fused steering against the three separate rules and the arrays against the old heap allocated
+/// Boid layout. --verify checks the steering variants, the SIMD kernels and the topological sums against each other.
+/// @author Dionysios Toufexis
+/// @version 1.0
+/// @date 17/10/2026
+
+#include "flock_bench.h"
+#include "Behaviours.h"
+#include "SpatialGrid.h"
+#include "KdTree.h"
+#include "SteerKernels.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <utility>
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief a cell size larger than any test volume, puts every boid in the same neighbourhood which turns the
+/// grid back into the old all pairs scan.
+const static float s_bruteForceCellSize = 1.0e9f;
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief a copy of the boid layout before FlockState, nine vectors plus the colour, scale and flags, each
+/// boid allocated on its own. Only used to measure what the old layout costs.
+struct LegacyBoid
+{
+    bool m_hit;
+    ngl::Vector m_newDirection;
+    ngl::Vector m_direction;
+    ngl::Vector m_position;
+    ngl::Vector m_lastPosition;
+    ngl::Vector m_nextPosition;
+    ngl::Vector m_velocity;
+    ngl::Vector m_scale;
+    float m_maxVelocity;
+    float m_minVelocity;
+    ngl::Colour m_colour;
+    float m_size;
+    bool m_wireframe;
+};
+//----------------------------------------------------------------------------------------------------------------------
+static void createLegacyFlock(std::vector <LegacyBoid*> &_boidList, const FlockState &_state)
+{
+    for(int i=0; i<_state.size(); ++i)
+    {
+        LegacyBoid *b = new LegacyBoid();
+        b->m_position = _state.getPosition(i);
+        b->m_velocity = _state.getVelocity(i);
+        b->m_scale.set(1.0f, 1.0f, 1.0f);
+        b->m_maxVelocity = _state.m_maxVelocity;
+        b->m_minVelocity = _state.m_minVelocity;
+        b->m_size = 1.0f;
+        _boidList.push_back(b);
+    }
+}
+//----------------------------------------------------------------------------------------------------------------------
+static void destroyLegacyFlock(std::vector <LegacyBoid*> &_boidList)
+{
+    for(unsigned int i=0; i<_boidList.size(); ++i)
+    {
+        delete _boidList[i];
+    }
+    _boidList.clear();
+}
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief runs the same double buffered steps as Flock::update without the collisions and returns the mean
+/// step time in ms.
+/// @param [in] _fused use the single pass Steer instead of the three separate rules.
+/// @param [in] _pool the workers the boids are split over, _behaviours needs one entry per worker.
+static double timeSteps(FlockState &_state, std::vector <Behaviours> &_behaviours, SpatialGrid &_grid, float _cellSize, int _steps, bool _fused, ThreadPool &_pool)
+{
+    FlockState next;
+    std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+    for(int step=0; step<_steps; ++step)
+    {
+        _grid.rebuild(_state, _cellSize);
+        next.resizeMotion(_state.size());
+        _pool.parallelFor(_state.size(), 256, [&](int _begin, int _end, int _worker)
+        {
+            Behaviours &behaviours = _behaviours[_worker];
+            for(int count=_begin; count<_end; ++count)
+            {
+                if(_fused)
+                {
+                    behaviours.Steer(count, _state, _grid);
+                    _state.integrate(count, behaviours.steering<SteerKernels::ALL_RULES>(count, _state), next);
+                }
+                else
+                {
+                    behaviours.Cohesion(count, _state, _grid);
+                    behaviours.Alignment(count, _state, _grid);
+                    behaviours.Seperation(count, _state, _grid);
+                    _state.integrate(count, behaviours.BehaviourSetup(), next);
+                }
+            }
+        });
+        _state.swapMotion(next);
+    }
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+    return elapsed.count() / _steps;
+}
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the fused steering and the integration written against the old layout, every neighbour test reads
+/// the position through the boid pointer. Returns the mean step time in ms.
+static double timeLegacySteps(std::vector <LegacyBoid*> &_boidList, Behaviours &_behaviours, SpatialGrid &_grid, float _cellSize, int _steps)
+{
+    const float behaviourDistanceSq = _behaviours.getBehaviourDistance() * _behaviours.getBehaviourDistance();
+    const float flockDistanceSq = _behaviours.getFlockDistance() * _behaviours.getFlockDistance();
+    const int size = _boidList.size();
+    std::vector <float> x(size), y(size), z(size);
+    std::vector <int> neighbours;
+    ngl::Vector alignment;
+
+    std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+    for(int step=0; step<_steps; ++step)
+    {
+        // the grid takes coordinate arrays, copying them out is part of the cost of the old layout
+        for(int i=0; i<size; ++i)
+        {
+            x[i] = _boidList[i]->m_position.m_x;
+            y[i] = _boidList[i]->m_position.m_y;
+            z[i] = _boidList[i]->m_position.m_z;
+        }
+        _grid.rebuild(&x[0], &y[0], &z[0], size, _cellSize);
+
+        for(int count=0; count<size; ++count)
+        {
+            LegacyBoid *b = _boidList[count];
+            ngl::Vector cohesion, separation;
+            int neighbourCount = 1;
+            _grid.gatherNeighbours(b->m_position, neighbours);
+            for(unsigned int n=0; n<neighbours.size(); ++n)
+            {
+                int i = neighbours[n];
+                if(i != count)
+                {
+                    ngl::Vector d = b->m_position - _boidList[i]->m_position;
+                    float distanceSq = d.lengthSquared();
+                    if(distanceSq < behaviourDistanceSq)
+                    {
+                        cohesion += _boidList[i]->m_position;
+                        alignment += _boidList[i]->m_velocity;
+                        ++neighbourCount;
+                    }
+                    if(distanceSq < flockDistanceSq)
+                    {
+                        separation -= d;
+                    }
+                }
+            }
+            cohesion /= neighbourCount;
+            cohesion = cohesion - b->m_position;
+            cohesion.normalize();
+            if(alignment.lengthSquared() > behaviourDistanceSq)
+            {
+                alignment.normalize();
+            }
+            alignment /= neighbourCount;
+            alignment = alignment - b->m_velocity;
+
+            ngl::Vector steering = separation * -9.0f + cohesion * 2.0f + alignment * 10.0f;
+            if(steering.length() > 0.5f)
+            {
+                steering.normalize();
+                steering *= 0.5f;
+            }
+            b->m_velocity += steering;
+            float speed = b->m_velocity.length();
+            if(speed > b->m_maxVelocity)
+            {
+                b->m_velocity.normalize();
+                b->m_velocity *= b->m_maxVelocity;
+            }
+            else if(speed < b->m_minVelocity)
+            {
+                b->m_velocity *= b->m_minVelocity;
+            }
+            b->m_newDirection = b->m_position - b->m_lastPosition;
+            b->m_position += (b->m_velocity + b->m_newDirection) * 2.2f;
+            b->m_lastPosition = b->m_position;
+        }
+    }
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+    return elapsed.count() / _steps;
+}
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief evaluates the fused and the three pass steering over the same still flock and returns the largest
+/// difference of the steering relative to its length.
+static double verifyFused(const FlockState &_state, float _cellSize)
+{
+    Behaviours fused;
+    Behaviours threePass;
+    SpatialGrid grid;
+    grid.rebuild(_state, _cellSize);
+    double maxError = 0.0;
+    for(int count=0; count<_state.size(); ++count)
+    {
+        fused.Steer(count, _state, grid);
+        threePass.Cohesion(count, _state, grid);
+        threePass.Alignment(count, _state, grid);
+        threePass.Seperation(count, _state, grid);
+        ngl::Vector a = fused.steering<SteerKernels::ALL_RULES>(count, _state);
+        ngl::Vector b = threePass.BehaviourSetup();
+        double error = (a - b).length() / std::max(b.length(), 1.0e-6f);
+        maxError = std::max(maxError, error);
+    }
+    return maxError;
+}
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief runs a kernel over the grid candidates of every boid and returns the largest difference of the sums
+/// to the scalar kernel, relative to the size of the scalar sum.
+static double verifyKernel(AccumulateKernel _kernel, const FlockState &_state, float _cellSize)
+{
+    AccumulateKernel scalar = SteerKernels::kernel(SteerKernels::SCALAR);
+    Behaviours behaviours;
+    const float behaviourDistanceSq = behaviours.getBehaviourDistance() * behaviours.getBehaviourDistance();
+    const float flockDistanceSq = behaviours.getFlockDistance() * behaviours.getFlockDistance();
+    SpatialGrid grid;
+    grid.rebuild(_state, _cellSize);
+    std::vector <int> neighbours;
+    FloatArray x, y, z, vx, vy, vz;
+    double maxError = 0.0;
+    for(int count=0; count<_state.size(); ++count)
+    {
+        grid.gatherNeighbours(_state.getPosition(count), neighbours);
+        x.clear(); y.clear(); z.clear(); vx.clear(); vy.clear(); vz.clear();
+        for(unsigned int n=0; n<neighbours.size(); ++n)
+        {
+            int i = neighbours[n];
+            if(i != count)
+            {
+                x.push_back(_state.m_posX[i]); y.push_back(_state.m_posY[i]); z.push_back(_state.m_posZ[i]);
+                vx.push_back(_state.m_velX[i]); vy.push_back(_state.m_velY[i]); vz.push_back(_state.m_velZ[i]);
+            }
+        }
+        while(x.size() % SteerKernels::s_padding != 0 || x.empty())
+        {
+            x.push_back(SteerKernels::s_farAway); y.push_back(SteerKernels::s_farAway); z.push_back(SteerKernels::s_farAway);
+            vx.push_back(0.0f); vy.push_back(0.0f); vz.push_back(0.0f);
+        }
+        NeighbourBatch batch = {&x[0], &y[0], &z[0], &vx[0], &vy[0], &vz[0], (int)x.size()};
+        NeighbourSums a, b;
+        _kernel(batch, _state.m_posX[count], _state.m_posY[count], _state.m_posZ[count], behaviourDistanceSq, flockDistanceSq, a);
+        scalar(batch, _state.m_posX[count], _state.m_posY[count], _state.m_posZ[count], behaviourDistanceSq, flockDistanceSq, b);
+        if(a.m_count != b.m_count)
+        {
+            return 1.0;
+        }
+        const float *fa = &a.m_cohesionX;
+        const float *fb = &b.m_cohesionX;
+        for(int k=0; k<9; k+=3)
+        {
+            double difference = std::sqrt(double((fa[k] - fb[k]) * (fa[k] - fb[k]) + (fa[k+1] - fb[k+1]) * (fa[k+1] - fb[k+1]) + (fa[k+2] - fb[k+2]) * (fa[k+2] - fb[k+2])));
+            double length = std::sqrt(double(fb[k] * fb[k] + fb[k+1] * fb[k+1] + fb[k+2] * fb[k+2]));
+            maxError = std::max(maxError, difference / std::max(length, 1.0e-6));
+        }
+    }
+    return maxError;
+}
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief steers the first boids of the flock through the kd-tree and returns the largest difference of the
+/// cohesion and alignment sums to the _k nearest boids found by comparing every pair, relative to the size of
+/// the brute force sum, or 1 if a boid did not count exactly its _k neighbours.
+static double verifyTopological(const FlockState &_state, int _k)
+{
+    ThreadPool one(1);
+    KdTree tree;
+    tree.build(_state, one);
+    Behaviours behaviours;
+    const int k = std::min(_k, _state.size() - 1);
+    const int checked = std::min(_state.size(), 500);
+    std::vector <std::pair<float, int> > pairs;
+    double maxError = 0.0;
+    for(int count=0; count<checked; ++count)
+    {
+        behaviours.Steer(count, _state, tree, _k);
+        const NeighbourSums &sums = behaviours.getSums();
+        if(sums.m_count != k)
+        {
+            return 1.0;
+        }
+        pairs.clear();
+        for(int i=0; i<_state.size(); ++i)
+        {
+            if(i != count)
+            {
+                pairs.push_back(std::make_pair((_state.getPosition(i) - _state.getPosition(count)).lengthSquared(), i));
+            }
+        }
+        std::partial_sort(pairs.begin(), pairs.begin() + k, pairs.end());
+        double expected[6] = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+        for(int n=0; n<k; ++n)
+        {
+            int i = pairs[n].second;
+            expected[0] += _state.m_posX[i]; expected[1] += _state.m_posY[i]; expected[2] += _state.m_posZ[i];
+            expected[3] += _state.m_velX[i]; expected[4] += _state.m_velY[i]; expected[5] += _state.m_velZ[i];
+        }
+        const float *found = &sums.m_cohesionX;
+        for(int v=0; v<6; v+=3)
+        {
+            double dx = found[v] - expected[v], dy = found[v+1] - expected[v+1], dz = found[v+2] - expected[v+2];
+            double length = std::sqrt(expected[v] * expected[v] + expected[v+1] * expected[v+1] + expected[v+2] * expected[v+2]);
+            maxError = std::max(maxError, std::sqrt(dx * dx + dy * dy + dz * dz) / std::max(length, 1.0e-6));
+        }
+    }
+    return maxError;
+}
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief runs a few steps on one worker and on _threads workers from the same flock and returns true when
+/// every position and velocity is bit for bit the same.
+static bool verifyThreads(int _count, int _threads, float _cellSize)
+{
+    FlockState single, parallel;
+    createFlock(single, _count, 1234u);
+    createFlock(parallel, _count, 1234u);
+    SpatialGrid grid;
+    ThreadPool one(1);
+    ThreadPool many(_threads);
+    std::vector <Behaviours> behaviours(many.size());
+    timeSteps(single, behaviours, grid, _cellSize, 3, true, one);
+    timeSteps(parallel, behaviours, grid, _cellSize, 3, true, many);
+    size_t bytes = _count * sizeof(float);
+    return std::memcmp(&single.m_posX[0], &parallel.m_posX[0], bytes) == 0 &&
+           std::memcmp(&single.m_posY[0], &parallel.m_posY[0], bytes) == 0 &&
+           std::memcmp(&single.m_posZ[0], &parallel.m_posZ[0], bytes) == 0 &&
+           std::memcmp(&single.m_velX[0], &parallel.m_velX[0], bytes) == 0 &&
+           std::memcmp(&single.m_velY[0], &parallel.m_velY[0], bytes) == 0 &&
+           std::memcmp(&single.m_velZ[0], &parallel.m_velZ[0], bytes) == 0;
+}
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the --compare table, the steering variants and the two layouts on the bare FlockState.
+int runCompare(const Options &_options)
+{
+    const int steps = _options.m_steps;
+    const int bruteMax = _options.m_bruteMax;
+    const int threads = _options.m_threads[0];
+    const bool verify = _options.m_verify;
+    const std::string &layout = _options.m_layout;
+    const std::vector <int> &counts = _options.m_counts;
+    const bool runSoa = layout != "aos";
+    const bool runAos = layout != "soa";
+
+    ThreadPool pool(threads);
+    std::printf("simd kernel %s, %d threads\n", SteerKernels::name(SteerKernels::active()), pool.size());
+    std::printf("%10s %14s %14s %14s %14s %12s\n", "boids", "fused ms/step", "3 pass ms/step", "brute ms/step", "aos ms/step", "ns/boid");
+    for(unsigned int c=0; c<counts.size(); ++c)
+    {
+        int count = counts[c];
+        std::vector <Behaviours> workers(pool.size());
+        Behaviours &behaviours = workers[0];
+        SpatialGrid grid;
+        float cellSize = std::max(behaviours.getBehaviourDistance(), behaviours.getFlockDistance());
+        FlockState state;
+
+        if(verify)
+        {
+            createFlock(state, count, 1234u);
+            std::printf("%10d fused vs 3 pass max relative error %g\n", count, verifyFused(state, cellSize));
+            for(int isa=SteerKernels::SSE; isa<=SteerKernels::AVX512; ++isa)
+            {
+                AccumulateKernel kernel = SteerKernels::kernel((SteerKernels::ISA)isa);
+                if(kernel != 0)
+                {
+                    std::printf("%10d %s vs scalar max relative error %g\n", count, SteerKernels::name((SteerKernels::ISA)isa), verifyKernel(kernel, state, cellSize));
+                }
+            }
+            std::printf("%10d topological vs brute force k nearest max relative error %g\n", count, verifyTopological(state, _options.m_k));
+            int verifyThreadCount = std::max(4, pool.size());
+            std::printf("%10d 1 vs %d threads %s\n", count, verifyThreadCount, verifyThreads(count, verifyThreadCount, cellSize) ? "identical" : "DIFFERENT");
+        }
+
+        double fusedMs = 0.0;
+        char threePass[32] = "skipped";
+        char brute[32] = "skipped";
+        char aos[32] = "skipped";
+        if(runSoa)
+        {
+            createFlock(state, count, 1234u);
+            fusedMs = timeSteps(state, workers, grid, cellSize, steps, true, pool);
+
+            createFlock(state, count, 1234u);
+            std::snprintf(threePass, sizeof(threePass), "%.3f", timeSteps(state, workers, grid, cellSize, steps, false, pool));
+
+            // the brute force column is the original code path, three separate rules over every pair
+            if(count <= bruteMax)
+            {
+                createFlock(state, count, 1234u);
+                std::snprintf(brute, sizeof(brute), "%.3f", timeSteps(state, workers, grid, s_bruteForceCellSize, steps, false, pool));
+            }
+        }
+        if(runAos)
+        {
+            std::vector <LegacyBoid*> boidList;
+            createFlock(state, count, 1234u);
+            createLegacyFlock(boidList, state);
+            state.clear();
+            std::snprintf(aos, sizeof(aos), "%.3f", timeLegacySteps(boidList, behaviours, grid, cellSize, steps));
+            destroyLegacyFlock(boidList);
+        }
+
+        std::printf("%10d %14.3f %14s %14s %14s %12.1f\n", count, fusedMs, threePass, brute, aos, fusedMs * 1.0e6 / count);
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,117 @@
+/// @file flock_bench_counters.cpp
+/// @brief --profile prints the mean time of every phase of Flock::update in a build with FLOCK_PROFILE and
+/// --counters the mean cycles, instructions per cycle, last level cache and branch misses of every phase per timed
+/// step in a build with FLOCK_PERF, under the times of each scaling run.
+/// @author Dionysios Toufexis
+/// @version 1.0
+/// @date 17/10/2026
+
+#include "flock_bench.h"
+#include "Profiler.h"
+
+//----------------------------------------------------------------------------------------------------------------------
+void printCountersStatus(const Options &_options)
+{
+    if(_options.m_counters && !PerfCounters::isEnabled())
+    {
+        std::printf("counters empty, build with FLOCK_PERF\n");
+    }
+    else if(_options.m_counters && !PerfCounters::instance().isAvailable())
+    {
+        // the runs go on, timed as usual
+        std::printf("counters unavailable, %s\n", PerfCounters::instance().getError().c_str());
+    }
+}
+//----------------------------------------------------------------------------------------------------------------------
+void readCounters(RunResult &_result)
+{
+    for(int p=0; p<PerfCounters::PHASES; ++p)
+    {
+        _result.m_counters[p] = PerfCounters::instance().getStats((PerfCounters::Phase)p);
+    }
+}
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief prints the mean and p99 time of the phases of Flock::update over the timed steps of a run
+void printProfile()
+{
+    if(!Profiler::isEnabled())
+    {
+        std::printf("%10s profile empty, build with FLOCK_PROFILE\n", "");
+        return;
+    }
+    const Profiler::Phase phases[] = {Profiler::UPDATE, Profiler::COLLISIONS, Profiler::NEIGHBOURS, Profiler::STEER};
+    std::printf("%10s", "");
+    for(unsigned int p=0; p<sizeof(phases) / sizeof(phases[0]); ++p)
+    {
+        Profiler::Stats stats = Profiler::instance().getStats(phases[p]);
+        std::printf(" %s %.3f ms (p99 %.3f)", Profiler::name(phases[p]), stats.m_meanMs, stats.m_p99Ms);
+    }
+    std::printf("\n");
+}
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief prints a counter in thousands or millions, - if it was not counted
+static void printCount(const PerfCounters::Stats &_stats, PerfCounters::Counter _counter)
+{
+    double value = _stats.mean(_counter);
+    if(!_stats.m_valid[_counter])
+    {
+        std::printf("-");
+    }
+    else if(value >= 1.0e6)
+    {
+        std::printf("%.2fM", value * 1.0e-6);
+    }
+    else
+    {
+        std::printf("%.1fk", value * 1.0e-3);
+    }
+}
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief prints the mean hardware events per timed step of the phases of a run, after the mean time of the
+/// phase when the profiler is compiled in too
+void printCounters(const RunResult &_result)
+{
+    const Profiler::Phase timed[PerfCounters::PHASES] = {Profiler::UPDATE, Profiler::COLLISIONS, Profiler::NEIGHBOURS, Profiler::STEER};
+    for(int p=0; p<PerfCounters::PHASES; ++p)
+    {
+        const PerfCounters::Stats &stats = _result.m_counters[p];
+        std::printf("%10s %-10s", "", PerfCounters::name((PerfCounters::Phase)p));
+        if(Profiler::isEnabled())
+        {
+            std::printf(" %8.3f ms", Profiler::instance().getStats(timed[p]).m_meanMs);
+        }
+        std::printf(" cycles ");
+        printCount(stats, PerfCounters::CYCLES);
+        std::printf(" ipc %.2f llc misses ", stats.ipc());
+        printCount(stats, PerfCounters::LLC_MISSES);
+        std::printf(" branch misses ");
+        printCount(stats, PerfCounters::BRANCH_MISSES);
+        std::printf("\n");
+    }
+}
+//----------------------------------------------------------------------------------------------------------------------
+void writeCountersJson(FILE *_file, const RunResult &_result)
+{
+    // per timed step, null for the counters that could not be opened
+    std::fprintf(_file, ", \"counters\": {");
+    for(int p=0; p<PerfCounters::PHASES; ++p)
+    {
+        const PerfCounters::Stats &stats = _result.m_counters[p];
+        std::fprintf(_file, "%s\"%s\": {", p > 0 ? ", " : "", PerfCounters::name((PerfCounters::Phase)p));
+        for(int c=0; c<PerfCounters::COUNTERS; ++c)
+        {
+            std::fprintf(_file, "%s\"%s\": ", c > 0 ? ", " : "", PerfCounters::name((PerfCounters::Counter)c));
+            if(stats.m_valid[c])
+            {
+                std::fprintf(_file, "%.0f", stats.mean((PerfCounters::Counter)c));
+            }
+            else
+            {
+                std::fprintf(_file, "null");
+            }
+        }
+        std::fprintf(_file, ", \"ipc\": %.3f}", stats.ipc());
+    }
+    std::fprintf(_file, "}");
+}
+//----------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,60 @@
+/// @file flock_bench_dense.cpp
+/// @brief --dense spawns every flock in the small cube Flock::spawn uses by default, where every boid is within
+/// the skin of every other, and prints the step time, whether the neighbour lists or the grid were used and the
+/// peak memory of the process, so the lists can not quietly grow with the square of the flock again.
+/// @author Dionysios Toufexis
+/// @version 1.0
+/// @date 17/10/2026
+
+#include "flock_bench.h"
+#include <chrono>
+#include <cstdlib>
+#ifdef __linux__
+    #include <sys/resource.h>
+#endif
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the peak resident memory of the process in MB, -1 where it can not be read
+static double peakMemoryMB()
+{
+#ifdef __linux__
+    rusage usage;
+    if(getrusage(RUSAGE_SELF, &usage) == 0)
+    {
+        // Linux gives it in kB
+        return usage.ru_maxrss / 1024.0;
+    }
+#endif
+    return -1.0;
+}
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the --dense table, flocks spawned in the default cube of Flock::spawn as the GUI does, stepped with the
+/// default neighbour lists.
+int runDense(const Options &_options)
+{
+    const int threads = _options.m_threads[0];
+    std::printf("flocks in the default spawn cube, %d steps on %d threads\n", _options.m_steps, threads);
+    std::printf("%10s %12s %10s %10s %12s %12s\n", "boids", "ms/step", "neighbours", "overflows", "list pairs", "peak MB");
+    for(unsigned int c=0; c<_options.m_counts.size(); ++c)
+    {
+        const int count = _options.m_counts[c];
+        Flock flock(120.0f, 120.0f, 120.0f, 0);
+        if(_options.m_skin >= 0.0f)
+        {
+            flock.setNeighbourSkin(_options.m_skin);
+        }
+        flock.setThreadCount(threads);
+        flock.setFlockSize(count);
+        flock.resetBoids();
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for(int step=0; step<_options.m_steps; ++step)
+        {
+            flock.update();
+        }
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        const NeighbourListStats &stats = flock.getNeighbourStats();
+        std::printf("%10d %12.3f %10s %10lu %12lu %12.1f\n", count, elapsed.count() / _options.m_steps,
+                    flock.useNeighbourList() ? "lists" : "grid", stats.m_overflows, stats.m_pairs, peakMemoryMB());
+    }
+    return EXIT_SUCCESS;
+}
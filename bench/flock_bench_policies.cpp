@@ -0,0 +1,109 @@
+/// @file flock_bench_policies.cpp
+/// @brief --policies times Flock::update with the steering pipeline specialised for the rules whose weight is
+/// not 0 against the pipeline steering with every rule, in the settings the flock is most often run in, and checks
+/// both moved the boids to the same place.
+/// @author Dionysios Toufexis
+/// @version 1.0
+/// @date 17/10/2026
+
+#include "flock_bench.h"
+#include "obstacle.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief a setting the --policies table times the steering pipeline in
+struct Policy
+{
+    const char *m_name;
+    bool m_cohesion;
+    bool m_alignment;
+    Boundary::Mode m_boundary;
+    bool m_obstacle;
+};
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief times Flock::update in one setting with the pipeline specialised for its rules or steering with every
+/// rule, and keeps the positions of the last step. Returns the p50 step time in ms, the steps that rebuild the
+/// neighbour lists come at the same steps in both and are left out of it.
+static double timePolicy(const Options &_options, const Policy &_policy, int _count, int _threads, bool _specialised,
+                         std::vector <float> &_positions)
+{
+    float side = std::cbrt(_count * s_volumePerBoid);
+    Obstacle obstacle(ngl::Vector(0.1f * side, 0.25f * side, 0.0f), 4.0f);
+    Flock flock(side * 1.2f, side * 1.2f, side * 1.2f, _policy.m_obstacle ? &obstacle : 0);
+    if(_options.m_skin >= 0.0f)
+    {
+        flock.setNeighbourSkin(_options.m_skin);
+    }
+    flock.setThreadCount(_threads);
+    flock.setSimDistance(_options.m_behaviourDistance);
+    flock.setSimFlockDistance(_options.m_flockDistance);
+    flock.setSimCohesion(_policy.m_cohesion ? _options.m_cohesion : 0.0);
+    flock.setSimSeparation(_options.m_separation);
+    flock.setSimAlignment(_policy.m_alignment ? _options.m_alignment : 0.0);
+    flock.setBoundaryMode(_policy.m_boundary);
+    flock.setPipelineSpecialised(_specialised);
+    flock.setFlockSize(_count);
+    flock.resetBoids();
+    FlockState spread;
+    createFlock(spread, _count, 1234u);
+    for(int i=0; i<_count; ++i)
+    {
+        flock.getState().setPosition(i, spread.getPosition(i));
+    }
+
+    for(int step=0; step<_options.m_warmup; ++step)
+    {
+        flock.update();
+    }
+    std::vector <double> times;
+    for(int step=0; step<_options.m_steps; ++step)
+    {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        flock.update();
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        times.push_back(elapsed.count());
+    }
+    std::sort(times.begin(), times.end());
+
+    const FlockState &state = flock.getState();
+    _positions.assign(state.m_posX.begin(), state.m_posX.end());
+    _positions.insert(_positions.end(), state.m_posY.begin(), state.m_posY.end());
+    _positions.insert(_positions.end(), state.m_posZ.begin(), state.m_posZ.end());
+    return percentile(times, 0.5);
+}
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the --policies table, the step time of the pipeline steering with every rule against the one
+/// specialised for the rules in use, in the settings the flock is most often run in.
+int runPolicies(const Options &_options)
+{
+    static const Policy policies[] =
+    {
+        {"all rules", true, true, Boundary::REFLECT, true},
+        {"no cohesion", false, true, Boundary::REFLECT, true},
+        {"no alignment", true, false, Boundary::REFLECT, true},
+        {"separation only", false, false, Boundary::REFLECT, true},
+        {"all rules, wrap, no obstacle", true, true, Boundary::WRAP, false}
+    };
+    const int threads = _options.m_threads[0];
+    std::printf("steering pipeline, %d steps on %d threads, generic steers with every rule\n", _options.m_steps, threads);
+    std::printf("%-30s %10s %12s %12s %9s %7s\n", "setting", "boids", "generic p50", "special p50", "speedup", "same");
+    bool same = true;
+    for(unsigned int p=0; p<sizeof(policies) / sizeof(policies[0]); ++p)
+    {
+        for(unsigned int c=0; c<_options.m_counts.size(); ++c)
+        {
+            std::vector <float> generic, specialised;
+            double genericMs = timePolicy(_options, policies[p], _options.m_counts[c], threads, false, generic);
+            double specialisedMs = timePolicy(_options, policies[p], _options.m_counts[c], threads, true, specialised);
+            // a rule with a weight of 0 adds exactly 0, leaving it out must not move a single boid
+            bool match = generic == specialised;
+            same = same && match;
+            std::printf("%-30s %10d %12.3f %12.3f %8.2fx %7s\n", policies[p].m_name, _options.m_counts[c], genericMs,
+                        specialisedMs, genericMs / specialisedMs, match ? "yes" : "NO");
+        }
+    }
+    return same ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,246 @@
+/// @file flock_bench_scaling.cpp
+/// @brief the default table, every boid count at every thread count and neighbour mode through the full
+/// Flock::update, collisions included, with the mean, p50 and p99 step times, the ns per boid step and the thread
+/// scaling efficiency against the first thread count. --json writes the same report as JSON.
+/// @author Dionysios Toufexis
+/// @version 1.0
+/// @date 17/10/2026
+
+#include "flock_bench.h"
+#include "obstacle.h"
+#include "Profiler.h"
+#include "Tracer.h"
+#include "SteerKernels.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <random>
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief builds a Flock with no GL context, spreads the boids at the benchmark density inside a box that
+/// fits them and times every Flock::update, collisions included.
+static RunResult runFlock(const Options &_options, int _count, int _threads, Flock::NeighbourMode _mode)
+{
+    float side = std::cbrt(_count * s_volumePerBoid);
+    // the obstacle sits where the GUI puts it, scaled with the box
+    Obstacle obstacle(ngl::Vector(0.1f * side, 0.25f * side, 0.0f), 4.0f);
+    Flock flock(side * 1.2f, side * 1.2f, side * 1.2f, &obstacle);
+    std::mt19937 rng(4321u);
+    std::uniform_real_distribution<float> place(-0.6f * side, 0.6f * side);
+    for(int i=1; i<_options.m_obstacles; ++i)
+    {
+        float x = place(rng);
+        float y = place(rng);
+        float z = place(rng);
+        flock.getObstacles().add(ngl::Vector(x, y, z), 0.25f);
+    }
+    flock.setAvoidance(_options.m_avoidance);
+    if(_options.m_skin >= 0.0f)
+    {
+        flock.setNeighbourSkin(_options.m_skin);
+    }
+    flock.setNeighbourMode(_mode);
+    flock.setTopologicalCount(_options.m_k);
+    flock.setOpeningAngle(_options.m_theta);
+    flock.setThreadCount(_threads);
+    flock.setSimDistance(_options.m_behaviourDistance);
+    flock.setSimFlockDistance(_options.m_flockDistance);
+    flock.setSimCohesion(_options.m_cohesion);
+    flock.setSimSeparation(_options.m_separation);
+    flock.setSimAlignment(_options.m_alignment);
+    flock.setFlockSize(_count);
+    flock.resetBoids();
+    FlockState spread;
+    createFlock(spread, _count, 1234u);
+    for(int i=0; i<_count; ++i)
+    {
+        flock.getState().setPosition(i, spread.getPosition(i));
+    }
+
+    for(int step=0; step<_options.m_warmup; ++step)
+    {
+        flock.update();
+    }
+    flock.resetNeighbourStats();
+    // the profile only holds the timed steps
+    Profiler::instance().reset();
+    PerfCounters::instance().reset();
+    Streams streams;
+    openStreams(_options, _threads, streams);
+    std::vector <double> times;
+    for(int step=0; step<_options.m_steps; ++step)
+    {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        flock.update();
+        std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+        std::chrono::duration<double, std::milli> elapsed = end - start;
+        times.push_back(elapsed.count());
+        // the step is timed without the streams, their cost is reported on its own
+        recordStep(streams, flock.getState());
+    }
+    std::sort(times.begin(), times.end());
+
+    RunResult result;
+    result.m_boids = _count;
+    result.m_threads = flock.getThreadCount();
+    result.m_mode = _mode;
+    result.m_meanMs = 0.0;
+    for(unsigned int i=0; i<times.size(); ++i)
+    {
+        result.m_meanMs += times[i];
+    }
+    result.m_meanMs /= times.size();
+    result.m_p50Ms = percentile(times, 0.5);
+    result.m_p99Ms = percentile(times, 0.99);
+    result.m_nsPerBoidStep = result.m_meanMs * 1.0e6 / _count;
+    result.m_efficiency = 1.0;
+    const NeighbourListStats &stats = flock.getNeighbourStats();
+    result.m_skin = flock.getNeighbourSkin();
+    result.m_rebuilds = stats.m_builds;
+    result.m_hitRate = stats.hitRate();
+    result.m_listLength = (double)stats.m_pairs / _count;
+    closeStreams(_options, flock, side * 1.2f, _threads, streams, result);
+    readCounters(result);
+    return result;
+}
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the name of a neighbour mode as given to --mode
+static const char *modeName(Flock::NeighbourMode _mode)
+{
+    return _mode == Flock::TOPOLOGICAL ? "topological" : (_mode == Flock::APPROXIMATE ? "approximate" : "metric");
+}
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief reads a comma separated list of neighbour modes, returns false on a name it does not know
+static bool parseModes(const std::string &_list, std::vector <Flock::NeighbourMode> &_modes)
+{
+    size_t start = 0;
+    while(start <= _list.size())
+    {
+        size_t end = std::min(_list.find(',', start), _list.size());
+        std::string name = _list.substr(start, end - start);
+        if(name == "metric" || name == "both")
+        {
+            _modes.push_back(Flock::METRIC);
+        }
+        if(name == "topological" || name == "both")
+        {
+            _modes.push_back(Flock::TOPOLOGICAL);
+        }
+        if(name == "approximate")
+        {
+            _modes.push_back(Flock::APPROXIMATE);
+        }
+        if(name != "metric" && name != "topological" && name != "approximate" && name != "both")
+        {
+            return false;
+        }
+        start = end + 1;
+    }
+    return !_modes.empty();
+}
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief writes the runs and the settings they were made with as JSON
+static void writeJson(FILE *_file, const Options &_options, const std::vector <RunResult> &_results)
+{
+    std::fprintf(_file, "{\n");
+    std::fprintf(_file, "  \"simd\": \"%s\",\n", SteerKernels::name(SteerKernels::active()));
+    std::fprintf(_file, "  \"hardware_threads\": %d,\n", ThreadPool::hardwareThreads());
+    std::fprintf(_file, "  \"steps\": %d,\n", _options.m_steps);
+    std::fprintf(_file, "  \"warmup\": %d,\n", _options.m_warmup);
+    std::fprintf(_file, "  \"obstacles\": %d,\n", _options.m_obstacles);
+    std::fprintf(_file, "  \"k\": %d,\n", _options.m_k);
+    std::fprintf(_file, "  \"theta\": %g,\n", _options.m_theta);
+    std::fprintf(_file, "  \"behaviour\": {\"distance\": %g, \"flock_distance\": %g, \"cohesion\": %g, \"separation\": %g, \"alignment\": %g},\n",
+                 _options.m_behaviourDistance, _options.m_flockDistance, _options.m_cohesion, _options.m_separation, _options.m_alignment);
+    std::fprintf(_file, "  \"runs\": [\n");
+    for(unsigned int i=0; i<_results.size(); ++i)
+    {
+        const RunResult &r = _results[i];
+        std::fprintf(_file, "    {\"boids\": %d, \"threads\": %d, \"mode\": \"%s\", \"mean_ms\": %.4f, \"p50_ms\": %.4f, \"p99_ms\": %.4f, \"ns_per_boid_step\": %.2f, \"efficiency\": %.3f, "
+                     "\"skin\": %g, \"list_rebuilds\": %lu, \"list_hit_rate\": %.3f, \"list_length\": %.1f",
+                     r.m_boids, r.m_threads, modeName(r.m_mode), r.m_meanMs, r.m_p50Ms, r.m_p99Ms, r.m_nsPerBoidStep, r.m_efficiency,
+                     r.m_skin, r.m_rebuilds, r.m_hitRate, r.m_listLength);
+        writeStreamsJson(_file, _options, r);
+        if(_options.m_counters)
+        {
+            writeCountersJson(_file, r);
+        }
+        std::fprintf(_file, "}%s\n", i + 1 < _results.size() ? "," : "");
+    }
+    std::fprintf(_file, "  ]\n}\n");
+}
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the default report, every boid count at every thread count through the full Flock::update
+int runScaling(const Options &_options)
+{
+    std::vector <RunResult> results;
+    std::printf("simd kernel %s, %d hardware threads, %d steps after %d warm up\n",
+                SteerKernels::name(SteerKernels::active()), ThreadPool::hardwareThreads(), _options.m_steps, _options.m_warmup);
+    printCountersStatus(_options);
+    std::printf("%10s %8s %12s %12s %12s %12s %16s %11s %9s %9s\n", "boids", "threads", "mode", "mean ms", "p50 ms", "p99 ms", "ns/boid-step", "efficiency",
+                "rebuilds", "list hit");
+    std::vector <Flock::NeighbourMode> modes;
+    if(!parseModes(_options.m_mode, modes))
+    {
+        std::fprintf(stderr, "unknown mode %s\n", _options.m_mode.c_str());
+        return EXIT_FAILURE;
+    }
+    for(unsigned int c=0; c<_options.m_counts.size(); ++c)
+    {
+        for(unsigned int m=0; m<modes.size(); ++m)
+        {
+            // the first thread count of every flock size and mode is the base of the efficiency
+            unsigned int base = results.size();
+            for(unsigned int t=0; t<_options.m_threads.size(); ++t)
+            {
+                results.push_back(runFlock(_options, _options.m_counts[c], _options.m_threads[t], modes[m]));
+                RunResult &r = results.back();
+                r.m_efficiency = (results[base].m_meanMs * results[base].m_threads) / (r.m_meanMs * r.m_threads);
+                std::printf("%10d %8d %12s %12.3f %12.3f %12.3f %16.1f %10.1f%% %9lu %8.1f%%\n",
+                            r.m_boids, r.m_threads, modeName(r.m_mode), r.m_meanMs, r.m_p50Ms, r.m_p99Ms, r.m_nsPerBoidStep,
+                            r.m_efficiency * 100.0, r.m_rebuilds, r.m_hitRate * 100.0);
+                printStreams(_options, r);
+                if(!_options.m_profile.empty())
+                {
+                    printProfile();
+                }
+                if(_options.m_counters && PerfCounters::isEnabled() && PerfCounters::instance().isAvailable())
+                {
+                    printCounters(r);
+                }
+            }
+        }
+    }
+
+    if(!_options.m_trace.empty() && !Tracer::isEnabled())
+    {
+        std::printf("trace empty, build with FLOCK_TRACE\n");
+    }
+    if(!_options.m_trace.empty() && !Tracer::instance().writeJson(_options.m_trace))
+    {
+        std::fprintf(stderr, "can not write %s\n", _options.m_trace.c_str());
+        return EXIT_FAILURE;
+    }
+    if(!_options.m_profile.empty() && !Profiler::instance().writeJson(_options.m_profile))
+    {
+        std::fprintf(stderr, "can not write %s\n", _options.m_profile.c_str());
+        return EXIT_FAILURE;
+    }
+    if(!_options.m_json.empty())
+    {
+        FILE *file = _options.m_json == "-" ? stdout : std::fopen(_options.m_json.c_str(), "w");
+        if(file == 0)
+        {
+            std::fprintf(stderr, "can not write %s\n", _options.m_json.c_str());
+            return EXIT_FAILURE;
+        }
+        writeJson(file, _options, results);
+        if(file != stdout)
+        {
+            std::fclose(file);
+        }
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,258 @@
+/// @file flock_bench_streams.cpp
+/// @brief the files a scaling run writes its timed steps to. --record times the copy for the writer thread and
+/// packing the recorded frames for the renderer, --codec the quantised encoder and seeking in its stream and
+/// --snapshot saving the flock and loading it back unchanged.
+/// @author Dionysios Toufexis
+/// @version 1.0
+/// @date 17/10/2026
+
+#include "flock_bench.h"
+#include "obstacle.h"
+#include "TrajectoryReader.h"
+#include "TrajectoryDecoder.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <random>
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the floats per boid of the instance buffer of FlockRenderer, which is not linked into the headless tools
+const static int s_instanceFloats = 10;
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief maps a trajectory and packs its frames into instance data the way FlockRenderer does, jumping
+/// between frames in random order, returns the mean ms per frame or -1 if the file could not be read
+static double timeReplay(const std::string &_file)
+{
+    TrajectoryReader reader;
+    if(!reader.open(_file) || reader.getFrameCount() == 0)
+    {
+        return -1.0;
+    }
+    std::vector <int> order(reader.getFrameCount());
+    for(unsigned int i=0; i<order.size(); ++i)
+    {
+        order[i] = i;
+    }
+    std::mt19937 rng(99u);
+    std::shuffle(order.begin(), order.end(), rng);
+    std::vector <float> instances;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for(unsigned int f=0; f<order.size(); ++f)
+    {
+        TrajectoryFrame frame = reader.getFrame(order[f]);
+        instances.resize(frame.m_count * s_instanceFloats);
+        float *instance = instances.empty() ? 0 : &instances[0];
+        for(int i=0; i<frame.m_count; ++i)
+        {
+            instance[0] = frame.m_posX[i];
+            instance[1] = frame.m_posY[i];
+            instance[2] = frame.m_posZ[i];
+            instance[3] = instance[4] = instance[5] = 1.0f;
+            instance[6] = instance[7] = instance[8] = instance[9] = 1.0f;
+            instance += s_instanceFloats;
+        }
+    }
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / order.size();
+}
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief saves _flock, loads it into a flock of its own and compares the two, _saveMs and _loadMs are set to
+/// -1 if the save or the load failed or the boids did not come back the same
+static void timeSnapshot(const Flock &_flock, float _box, const std::string &_file, double &_saveMs, double &_loadMs)
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    bool saved = _flock.saveSnapshot(_file);
+    std::chrono::duration<double, std::milli> save = std::chrono::steady_clock::now() - start;
+    _saveMs = saved ? save.count() : -1.0;
+
+    Obstacle obstacle(ngl::Vector(0.0f, 0.0f, 0.0f), 1.0f);
+    Flock loaded(_box, _box, _box, &obstacle);
+    start = std::chrono::steady_clock::now();
+    bool read = saved && loaded.loadSnapshot(_file);
+    std::chrono::duration<double, std::milli> load = std::chrono::steady_clock::now() - start;
+    _loadMs = read ? load.count() : -1.0;
+
+    const FlockState &a = _flock.getState();
+    const FlockState &b = loaded.getState();
+    const int count = a.size();
+    bool same = read && b.size() == count;
+    for(int i=0; same && i<count; ++i)
+    {
+        same = a.m_posX[i] == b.m_posX[i] && a.m_posY[i] == b.m_posY[i] && a.m_posZ[i] == b.m_posZ[i] &&
+               a.m_velX[i] == b.m_velX[i] && a.m_velY[i] == b.m_velY[i] && a.m_velZ[i] == b.m_velZ[i] &&
+               a.m_lastX[i] == b.m_lastX[i] && a.m_newDirZ[i] == b.m_newDirZ[i] && a.m_size[i] == b.m_size[i] &&
+               a.m_hit[i] == b.m_hit[i] && a.m_scale[i].m_y == b.m_scale[i].m_y && a.m_colour[i].m_g == b.m_colour[i].m_g;
+    }
+    if(read && !same)
+    {
+        _loadMs = -1.0;
+    }
+}
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief decodes the last frame of a quantised trajectory and compares it with the flock it was encoded from,
+/// then decodes frames in random order, each from its keyframe as a seek would. _error is -1 if the stream
+/// could not be read.
+static void timeCodec(const std::string &_file, const FlockState &_last, int _threads, double &_error, double &_bound, double &_seekMs)
+{
+    _error = -1.0;
+    _bound = 0.0;
+    _seekMs = 0.0;
+    TrajectoryDecoder decoder;
+    if(!decoder.open(_file, _threads) || decoder.getFrameCount() == 0)
+    {
+        return;
+    }
+    const int last = decoder.getFrameCount() - 1;
+    const int count = decoder.getCount(last);
+    std::vector <float> x(count + 1), y(count + 1), z(count + 1);
+    if(count != _last.size() || !decoder.decode(last, &x[0], &y[0], &z[0]))
+    {
+        return;
+    }
+    _bound = decoder.getMaxError(last);
+    _error = 0.0;
+    for(int i=0; i<count; ++i)
+    {
+        _error = std::max(_error, (double)std::fabs(x[i] - _last.m_posX[i]));
+        _error = std::max(_error, (double)std::fabs(y[i] - _last.m_posY[i]));
+        _error = std::max(_error, (double)std::fabs(z[i] - _last.m_posZ[i]));
+    }
+
+    std::mt19937 rng(99u);
+    std::uniform_int_distribution<int> pick(0, last);
+    const int seeks = std::min(decoder.getFrameCount(), 16);
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for(int s=0; s<seeks; ++s)
+    {
+        int frame = pick(rng);
+        x.resize(decoder.getCount(frame) + 1);
+        y.resize(x.size());
+        z.resize(x.size());
+        decoder.decode(frame, &x[0], &y[0], &z[0]);
+    }
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    _seekMs = elapsed.count() / seeks;
+}
+//----------------------------------------------------------------------------------------------------------------------
+void openStreams(const Options &_options, int _threads, Streams &_streams)
+{
+    _streams.m_recordMs = 0.0;
+    _streams.m_encodeMs = 0.0;
+    if(!_options.m_record.empty() && !_streams.m_recorder.open(_options.m_record))
+    {
+        std::fprintf(stderr, "can not write %s\n", _options.m_record.c_str());
+    }
+    if(!_options.m_codec.empty() && !_streams.m_encoder.open(_options.m_codec, 30, _threads))
+    {
+        std::fprintf(stderr, "can not write %s\n", _options.m_codec.c_str());
+    }
+}
+//----------------------------------------------------------------------------------------------------------------------
+void recordStep(Streams &_streams, const FlockState &_state)
+{
+    if(_streams.m_recorder.isOpen())
+    {
+        std::chrono::steady_clock::time_point before = std::chrono::steady_clock::now();
+        _streams.m_recorder.record(_state);
+        std::chrono::duration<double, std::milli> copy = std::chrono::steady_clock::now() - before;
+        _streams.m_recordMs += copy.count();
+    }
+    if(_streams.m_encoder.isOpen())
+    {
+        std::chrono::steady_clock::time_point before = std::chrono::steady_clock::now();
+        _streams.m_encoder.encode(_state);
+        std::chrono::duration<double, std::milli> encode = std::chrono::steady_clock::now() - before;
+        _streams.m_encodeMs += encode.count();
+    }
+}
+//----------------------------------------------------------------------------------------------------------------------
+void closeStreams(const Options &_options, const Flock &_flock, float _box, int _threads, Streams &_streams, RunResult &_result)
+{
+    _result.m_recordMs = 0.0;
+    _result.m_recorded = 0;
+    _result.m_dropped = 0;
+    _result.m_replayMs = 0.0;
+    if(_streams.m_recorder.isOpen())
+    {
+        bool written = _streams.m_recorder.close();
+        _result.m_recordMs = _streams.m_recordMs / _options.m_steps;
+        _result.m_recorded = _streams.m_recorder.getFramesWritten();
+        _result.m_dropped = _streams.m_recorder.getFramesDropped();
+        if(written)
+        {
+            _result.m_replayMs = timeReplay(_options.m_record);
+        }
+        else
+        {
+            std::fprintf(stderr, "could not write all of %s\n", _options.m_record.c_str());
+        }
+    }
+    _result.m_saveMs = 0.0;
+    _result.m_loadMs = 0.0;
+    if(!_options.m_snapshot.empty())
+    {
+        timeSnapshot(_flock, _box, _options.m_snapshot, _result.m_saveMs, _result.m_loadMs);
+    }
+    _result.m_encodeMs = 0.0;
+    _result.m_ratio = 0.0;
+    _result.m_codecError = 0.0;
+    _result.m_errorBound = 0.0;
+    _result.m_seekMs = 0.0;
+    if(_streams.m_encoder.isOpen())
+    {
+        bool written = _streams.m_encoder.close();
+        const int count = _flock.getState().size();
+        _result.m_encodeMs = _streams.m_encodeMs / _options.m_steps;
+        _result.m_ratio = (double)_streams.m_encoder.getFramesWritten() * count * 3 * sizeof(float) / _streams.m_encoder.getBytesWritten();
+        if(written)
+        {
+            timeCodec(_options.m_codec, _flock.getState(), _threads, _result.m_codecError, _result.m_errorBound, _result.m_seekMs);
+        }
+        else
+        {
+            std::fprintf(stderr, "could not write all of %s\n", _options.m_codec.c_str());
+        }
+    }
+}
+//----------------------------------------------------------------------------------------------------------------------
+void printStreams(const Options &_options, const RunResult &_result)
+{
+    const RunResult &r = _result;
+    if(!_options.m_record.empty())
+    {
+        std::printf("%10s recorded %lu frames, %lu dropped, record %.3f ms/step, replay %.3f ms/frame\n",
+                    "", r.m_recorded, r.m_dropped, r.m_recordMs, r.m_replayMs);
+    }
+    if(!_options.m_snapshot.empty())
+    {
+        std::printf("%10s snapshot save %.1f ms, load %.1f ms%s\n", "", r.m_saveMs, r.m_loadMs,
+                    r.m_loadMs < 0.0 ? " (failed or different)" : "");
+    }
+    if(!_options.m_codec.empty())
+    {
+        std::printf("%10s codec encode %.3f ms/step (%.1fx real time at 60 Hz), %.2f:1, error %g of %g%s, seek %.3f ms\n", "",
+                    r.m_encodeMs, (1000.0 / 60.0) / r.m_encodeMs, r.m_ratio, r.m_codecError, r.m_errorBound,
+                    r.m_codecError < 0.0 || r.m_codecError > r.m_errorBound ? " (failed or over the bound)" : "", r.m_seekMs);
+    }
+}
+//----------------------------------------------------------------------------------------------------------------------
+void writeStreamsJson(FILE *_file, const Options &_options, const RunResult &_result)
+{
+    const RunResult &r = _result;
+    if(!_options.m_record.empty())
+    {
+        std::fprintf(_file, ", \"record_ms\": %.4f, \"frames_recorded\": %lu, \"frames_dropped\": %lu, \"replay_ms\": %.4f",
+                     r.m_recordMs, r.m_recorded, r.m_dropped, r.m_replayMs);
+    }
+    if(!_options.m_snapshot.empty())
+    {
+        std::fprintf(_file, ", \"snapshot_save_ms\": %.3f, \"snapshot_load_ms\": %.3f", r.m_saveMs, r.m_loadMs);
+    }
+    if(!_options.m_codec.empty())
+    {
+        std::fprintf(_file, ", \"encode_ms\": %.4f, \"compression_ratio\": %.2f, \"codec_error\": %g, \"codec_error_bound\": %g, \"seek_ms\": %.4f",
+                     r.m_encodeMs, r.m_ratio, r.m_codecError, r.m_errorBound, r.m_seekMs);
+    }
+}
+//----------------------------------------------------------------------------------------------------------------------
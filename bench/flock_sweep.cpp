@@ -0,0 +1,332 @@
+/// @file flock_sweep.cpp
+/// @brief headless parameter sweep of the behaviours, no Qt widget and no GL context is created.
+/// @brief every combination of the listed behaviour distances, flock distances, cohesions, separations and
+/// alignments is run once per seed as its own FlockSim of libflocksim. The runs are independent, so they are handed out one at a
+/// time over one shared thread pool and every flock steps on the worker that took it, which keeps every core
+/// busy without the runs splitting their boids. The boids start in the spawn cube of the seed flying in
+/// directions drawn from the same seed, so a run comes out the same on any machine and any thread count.
+/// @brief over the last --average steps of a run the polarization, the mean nearest neighbour distance and
+/// the number of clusters are measured through FlockMetrics and averaged. The clusters link boids closer than
+/// --link, the behaviour distance of the run by default. A row is written to the results table as soon as its
+/// run ends so a sweep stopped overnight keeps what it finished, the rows carry the index of their run because
+/// they come out in the order the runs end. The throughput of the whole machine in simulated boid steps per
+/// second is printed at the end.
+/// usage : flock_sweep [--distance a,b,..] [--flock-distance a,b,..] [--cohesion a,b,..] [--separation a,b,..]
+///                     [--alignment a,b,..] [--seeds a,b,..] [--boids n] [--steps n] [--average n] [--box size]
+///                     [--link d] [--threads n] [--out file.csv]
+/// @author Dionysios Toufexis
+/// @version 1.0
+/// @date 17/10/2026
+
+#include "FlockSim.h"
+#include "flock.h"
+#include "FlockMetrics.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <chrono>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <vector>
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the speed of the boids when they are spawned, the length of the start velocity of FlockState
+const static float s_spawnSpeed = 11.3137085f;
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the command line settings, the lists default to the values of the GUI
+struct Options
+{
+    Options() : m_boids(200), m_steps(600), m_average(60), m_box(120.0f), m_link(-1.0f), m_threads(0), m_out("sweep.csv")
+    {
+        m_distance.push_back(20.0);
+        m_flockDistance.push_back(4.0);
+        m_cohesion.push_back(2.0);
+        m_separation.push_back(9.0);
+        m_alignment.push_back(10.0);
+        m_seeds.push_back(1);
+    }
+    std::vector <double> m_distance;
+    std::vector <double> m_flockDistance;
+    std::vector <double> m_cohesion;
+    std::vector <double> m_separation;
+    std::vector <double> m_alignment;
+    std::vector <uint64_t> m_seeds;
+    int m_boids;
+    /// @brief the steps of every run and how many of the last ones the metrics are averaged over
+    int m_steps;
+    int m_average;
+    /// @brief the side of the box the boids are kept in
+    float m_box;
+    /// @brief the link distance of the clusters, negative for the behaviour distance of the run
+    float m_link;
+    /// @brief the workers of the shared pool, 0 for one per hardware thread
+    int m_threads;
+    /// @brief the results table, - for stdout
+    std::string m_out;
+};
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the settings of one run
+struct Run
+{
+    double m_distance;
+    double m_flockDistance;
+    double m_cohesion;
+    double m_separation;
+    double m_alignment;
+    uint64_t m_seed;
+};
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the metrics of a run averaged over its last steps
+struct RunMetrics
+{
+    double m_polarization;
+    double m_nearestDistance;
+    double m_clusters;
+};
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief steps one flock and returns the metrics averaged over the last steps of the run
+static RunMetrics runFlock(const Options &_options, const Run &_run)
+{
+    // the run gets one worker of the shared pool, a pool of one runs on the calling thread
+    FlockSim sim(_options.m_box, _options.m_box, _options.m_box, _options.m_boids, _run.m_seed, 1, s_spawnSpeed);
+    FlockSim::Parameters parameters;
+    parameters.m_behaviourDistance = _run.m_distance;
+    parameters.m_flockDistance = _run.m_flockDistance;
+    parameters.m_cohesion = _run.m_cohesion;
+    parameters.m_separation = _run.m_separation;
+    parameters.m_alignment = _run.m_alignment;
+    sim.setParameters(parameters);
+
+    const FlockState &state = sim.getFlock().getState();
+
+    ThreadPool serial(1);
+    FlockMetrics metrics;
+    const float link = _options.m_link >= 0.0f ? _options.m_link : (float)_run.m_distance;
+    const int average = std::min(_options.m_average, _options.m_steps);
+    RunMetrics sum = {0.0, 0.0, 0.0};
+    for(int step=0; step<_options.m_steps; ++step)
+    {
+        sim.step();
+        if(step >= _options.m_steps - average)
+        {
+            OrderMetrics m = metrics.measure(state, link, serial);
+            sum.m_polarization += m.m_polarization;
+            sum.m_nearestDistance += m.m_nearestDistance;
+            sum.m_clusters += m.m_clusters;
+        }
+    }
+    sum.m_polarization /= average;
+    sum.m_nearestDistance /= average;
+    sum.m_clusters /= average;
+    return sum;
+}
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief splits a comma separated list of numbers
+static std::vector <double> parseList(const char *_list)
+{
+    std::vector <double> values;
+    std::string list(_list);
+    size_t start = 0;
+    while(start <= list.size())
+    {
+        size_t end = list.find(',', start);
+        if(end == std::string::npos)
+        {
+            end = list.size();
+        }
+        if(end > start)
+        {
+            values.push_back(std::atof(list.substr(start, end - start).c_str()));
+        }
+        start = end + 1;
+    }
+    return values;
+}
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief splits a comma separated list of seeds, every one a whole number from 0 to 2^64 - 1
+/// @returns false if a seed is not such a number, the seeds are kept as they are then
+static bool parseSeeds(const char *_list, std::vector <uint64_t> &_seeds)
+{
+    std::vector <uint64_t> seeds;
+    std::string list(_list);
+    size_t start = 0;
+    while(start <= list.size())
+    {
+        size_t end = list.find(',', start);
+        if(end == std::string::npos)
+        {
+            end = list.size();
+        }
+        if(end > start)
+        {
+            // strtoull takes a leading minus and wraps it around, so only digits are let through
+            std::string seed = list.substr(start, end - start);
+            char *last = 0;
+            errno = 0;
+            unsigned long long value = std::strtoull(seed.c_str(), &last, 10);
+            if(seed.find_first_not_of("0123456789") != std::string::npos || *last != '\0' || errno == ERANGE)
+            {
+                return false;
+            }
+            seeds.push_back((uint64_t)value);
+        }
+        start = end + 1;
+    }
+    if(seeds.empty())
+    {
+        return false;
+    }
+    _seeds.swap(seeds);
+    return true;
+}
+//----------------------------------------------------------------------------------------------------------------------
+int main(int argc, char **argv)
+{
+    Options options;
+    for(int i=1; i<argc; ++i)
+    {
+        std::vector <double> *list = 0;
+        if(std::strcmp(argv[i], "--distance") == 0)
+        {
+            list = &options.m_distance;
+        }
+        else if(std::strcmp(argv[i], "--flock-distance") == 0)
+        {
+            list = &options.m_flockDistance;
+        }
+        else if(std::strcmp(argv[i], "--cohesion") == 0)
+        {
+            list = &options.m_cohesion;
+        }
+        else if(std::strcmp(argv[i], "--separation") == 0)
+        {
+            list = &options.m_separation;
+        }
+        else if(std::strcmp(argv[i], "--alignment") == 0)
+        {
+            list = &options.m_alignment;
+        }
+        if(list != 0 && i + 1 < argc)
+        {
+            *list = parseList(argv[++i]);
+            if(list->empty())
+            {
+                std::fprintf(stderr, "empty list for %s\n", argv[i - 1]);
+                return EXIT_FAILURE;
+            }
+        }
+        else if(std::strcmp(argv[i], "--seeds") == 0 && i + 1 < argc)
+        {
+            if(!parseSeeds(argv[++i], options.m_seeds))
+            {
+                std::fprintf(stderr, "--seeds takes whole numbers from 0 to 18446744073709551615, not %s\n", argv[i]);
+                return EXIT_FAILURE;
+            }
+        }
+        else if(std::strcmp(argv[i], "--boids") == 0 && i + 1 < argc)
+        {
+            options.m_boids = std::max(1, std::atoi(argv[++i]));
+        }
+        else if(std::strcmp(argv[i], "--steps") == 0 && i + 1 < argc)
+        {
+            options.m_steps = std::max(1, std::atoi(argv[++i]));
+        }
+        else if(std::strcmp(argv[i], "--average") == 0 && i + 1 < argc)
+        {
+            options.m_average = std::max(1, std::atoi(argv[++i]));
+        }
+        else if(std::strcmp(argv[i], "--box") == 0 && i + 1 < argc)
+        {
+            options.m_box = std::max(1.0f, (float)std::atof(argv[++i]));
+        }
+        else if(std::strcmp(argv[i], "--link") == 0 && i + 1 < argc)
+        {
+            options.m_link = std::max(0.0f, (float)std::atof(argv[++i]));
+        }
+        else if(std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+        {
+            options.m_threads = std::max(0, std::atoi(argv[++i]));
+        }
+        else if(std::strcmp(argv[i], "--out") == 0 && i + 1 < argc)
+        {
+            options.m_out = argv[++i];
+        }
+        else
+        {
+            std::fprintf(stderr, "unknown option %s\n", argv[i]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    // the seeds vary fastest so the runs of one setting end close together in the table
+    std::vector <Run> runs;
+    for(unsigned int a=0; a<options.m_distance.size(); ++a)
+    for(unsigned int b=0; b<options.m_flockDistance.size(); ++b)
+    for(unsigned int c=0; c<options.m_cohesion.size(); ++c)
+    for(unsigned int d=0; d<options.m_separation.size(); ++d)
+    for(unsigned int e=0; e<options.m_alignment.size(); ++e)
+    for(unsigned int s=0; s<options.m_seeds.size(); ++s)
+    {
+        Run run;
+        run.m_distance = options.m_distance[a];
+        run.m_flockDistance = options.m_flockDistance[b];
+        run.m_cohesion = options.m_cohesion[c];
+        run.m_separation = options.m_separation[d];
+        run.m_alignment = options.m_alignment[e];
+        run.m_seed = options.m_seeds[s];
+        runs.push_back(run);
+    }
+
+    FILE *file = options.m_out == "-" ? stdout : std::fopen(options.m_out.c_str(), "w");
+    if(file == 0)
+    {
+        std::fprintf(stderr, "can not write %s\n", options.m_out.c_str());
+        return EXIT_FAILURE;
+    }
+    std::fprintf(file, "run,distance,flock_distance,cohesion,separation,alignment,seed,polarization,nearest_distance,clusters,seconds\n");
+    std::fflush(file);
+
+    ThreadPool pool(options.m_threads);
+    // the summary goes to stderr when the table goes to stdout
+    FILE *log = file == stdout ? stderr : stdout;
+    std::fprintf(log, "%d runs of %d boids for %d steps on %d threads\n", (int)runs.size(), options.m_boids, options.m_steps, pool.size());
+
+    std::mutex mutex;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    pool.parallelFor((int)runs.size(), 1, [&](int _begin, int _end, int)
+    {
+        for(int r=_begin; r<_end; ++r)
+        {
+            std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+            RunMetrics metrics = runFlock(options, runs[r]);
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+            const Run &run = runs[r];
+            std::lock_guard <std::mutex> lock(mutex);
+            std::fprintf(file, "%d,%g,%g,%g,%g,%g,%llu,%.4f,%.4f,%.2f,%.3f\n", r, run.m_distance, run.m_flockDistance, run.m_cohesion,
+                         run.m_separation, run.m_alignment, (unsigned long long)run.m_seed, metrics.m_polarization,
+                         metrics.m_nearestDistance, metrics.m_clusters, elapsed.count());
+            std::fflush(file);
+        }
+    });
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    bool good = !std::ferror(file);
+    if(file != stdout)
+    {
+        good = std::fclose(file) == 0 && good;
+    }
+    double boidSteps = (double)runs.size() * options.m_boids * options.m_steps;
+    std::fprintf(log, "%.1f s, %.3g boid steps/s, %.3g boid steps/s per thread\n", elapsed.count(), boidSteps / elapsed.count(),
+                 boidSteps / elapsed.count() / pool.size());
+    if(!good)
+    {
+        std::fprintf(stderr, "can not write %s\n", options.m_out.c_str());
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+//----------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,37 @@
+# headless sweep of the behaviour parameters over many flocks, no Qt and no GL context is created.
+# only libflocksim and NGL are linked, there is no GL, GLEW or Qt in the binary
+TEMPLATE = app
+CONFIG += console
+CONFIG -= qt app_bundle
+
+INCLUDEPATH += ../include
+
+# kept apart from the objects of flock_bench, the two builds can run side by side
+OBJECTS_DIR = obj/sweep/
+
+TARGET = ../bin/flock_sweep
+
+SOURCES += \
+    flock_sweep.cpp
+
+# the simulation comes from libflocksim, build ../flocksim/flocksim_static.pro first with the same CONFIG
+LIBS += ../bin/libflocksim.a
+PRE_TARGETDEPS += ../bin/libflocksim.a
+
+QMAKE_CXXFLAGS+= -msse -msse2 -msse3 -std=c++0x
+macx:QMAKE_CXXFLAGS+= -arch x86_64
+
+LIBS += -L/usr/local/lib
+LIBS +=  -L/$(HOME)/NGL/lib -l NGL
+INCLUDEPATH += $$(HOME)/NGL/include/
+INCLUDEPATH += $$(HOME)/boost-trunk/
+
+linux-g++ {
+    DEFINES += LINUX
+    LIBS+= -lpthread
+}
+linux-g++-64 {
+    DEFINES += LINUX
+    LIBS+= -lpthread
+}
+macx:DEFINES += DARWIN
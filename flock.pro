@@ -16,30 +16,34 @@ SOURCES += \
     src/main.cpp \
     src/mainwindow.cpp \
     src/GLWindow.cpp \
-    src/boid.cpp \
-    src/flock.cpp \
-    src/obstacle.cpp \
-    src/Behaviours.cpp
+    src/FlockRenderer.cpp \
+    src/ObstacleRenderer.cpp
 
 HEADERS += \
     include/mainwindow.h \
     include/GLWindow.h \
-    include/boid.h \
-    include/flock.h \
-    include/obstacle.h \
-    include/Behaviours.h
+    include/FlockRenderer.h \
+    include/ObstacleRenderer.h
+
+# the simulation comes from libflocksim, build flocksim/flocksim_static.pro first with the same CONFIG
+LIBS += bin/libflocksim.a
+PRE_TARGETDEPS += bin/libflocksim.a
 
 FORMS += \
     ui/mainwindow.ui
 
-QMAKE_CXXFLAGS+= -msse -msse2 -msse3
+QMAKE_CXXFLAGS+= -msse -msse2 -msse3 -std=c++0x
 macx:QMAKE_CXXFLAGS+= -arch x86_64
 macx:INCLUDEPATH+=/usr/local/boost/
-linux-g++:QMAKE_CXXFLAGS +=  -march=native
-linux-g++-64:QMAKE_CXXFLAGS +=  -march=native
 
 # define the _DEBUG flag for the graphics lib
 DEFINES +=NGL_DEBUG
+# qmake CONFIG+=profile compiles in the phase timers and the overlay
+profile:DEFINES += FLOCK_PROFILE
+# qmake CONFIG+=trace records the timeline of every thread for a Chrome trace
+trace:DEFINES += FLOCK_TRACE
+# qmake CONFIG+=perf counts the hardware events of the phases of Flock::update
+perf:DEFINES += FLOCK_PERF
 
 
 LIBS += -L/usr/local/lib
@@ -49,11 +53,11 @@ INCLUDEPATH += $$(HOME)/NGL/include/
 # now if we are under unix and not on a Mac (i.e. linux) define GLEW
 linux-g++ {
     DEFINES += LINUX
-    LIBS+= -lGLEW
+    LIBS+= -lGLEW -lpthread
 }
 linux-g++-64 {
     DEFINES += LINUX
-    LIBS+= -lGLEW
+    LIBS+= -lGLEW -lpthread
 }
 DEPENDPATH+=include
 # if we are on a mac define DARWIN
@@ -0,0 +1,91 @@
+# the sources of libflocksim, the simulation without Qt, GL, NGLInit or GLEW. Included by the static and the
+# shared library, the GUI and the headless tools link one of them. NGL is only used for its Vector and Colour.
+CONFIG += console
+CONFIG -= qt app_bundle
+
+INCLUDEPATH += ../include
+DEPENDPATH += ../include
+
+SOURCES += \
+    ../src/FlockSim.cpp \
+    ../src/flock.cpp \
+    ../src/boid.cpp \
+    ../src/obstacle.cpp \
+    ../src/FlockState.cpp \
+    ../src/Behaviours.cpp \
+    ../src/SpatialGrid.cpp \
+    ../src/NeighbourList.cpp \
+    ../src/KdTree.cpp \
+    ../src/Octree.cpp \
+    ../src/FlockMetrics.cpp \
+    ../src/TrajectoryRecorder.cpp \
+    ../src/TrajectoryReader.cpp \
+    ../src/FlockSnapshot.cpp \
+    ../src/MappedFile.cpp \
+    ../src/RansCoder.cpp \
+    ../src/TrajectoryEncoder.cpp \
+    ../src/TrajectoryDecoder.cpp \
+    ../src/Profiler.cpp \
+    ../src/Tracer.cpp \
+    ../src/PerfCounters.cpp \
+    ../src/SteerKernels.cpp \
+    ../src/ThreadPool.cpp \
+    ../src/SimulationThread.cpp \
+    ../src/ObstacleSet.cpp \
+    ../src/avoidance.cpp
+
+HEADERS += \
+    ../include/FlockSim.h \
+    ../include/flock.h \
+    ../include/boid.h \
+    ../include/obstacle.h \
+    ../include/FlockState.h \
+    ../include/Behaviours.h \
+    ../include/SpatialGrid.h \
+    ../include/NeighbourList.h \
+    ../include/KdTree.h \
+    ../include/Octree.h \
+    ../include/FlockMetrics.h \
+    ../include/TrajectoryRecorder.h \
+    ../include/TrajectoryReader.h \
+    ../include/FlockSnapshot.h \
+    ../include/MappedFile.h \
+    ../include/RansCoder.h \
+    ../include/TrajectoryEncoder.h \
+    ../include/TrajectoryDecoder.h \
+    ../include/Profiler.h \
+    ../include/Tracer.h \
+    ../include/PerfCounters.h \
+    ../include/AlignedAllocator.h \
+    ../include/SteerKernels.h \
+    ../include/ThreadPool.h \
+    ../include/TripleBuffer.h \
+    ../include/SimulationThread.h \
+    ../include/CounterRng.h \
+    ../include/ObstacleSet.h \
+    ../include/avoidance.h \
+    ../include/Boundary.h
+
+QMAKE_CXXFLAGS+= -msse -msse2 -msse3 -std=c++0x
+macx:QMAKE_CXXFLAGS+= -arch x86_64
+# qmake CONFIG+=profile compiles in the phase timers, build the GUI and the tools with the same CONFIG
+profile:DEFINES += FLOCK_PROFILE
+# qmake CONFIG+=trace records the timeline of every thread for a Chrome trace
+trace:DEFINES += FLOCK_TRACE
+# qmake CONFIG+=perf counts the hardware events of the phases of Flock::update
+perf:DEFINES += FLOCK_PERF
+
+LIBS += -L/usr/local/lib
+LIBS +=  -L/$(HOME)/NGL/lib -l NGL
+INCLUDEPATH += $$(HOME)/NGL/include/
+INCLUDEPATH += $$(HOME)/boost-trunk/
+
+linux-g++ {
+    DEFINES += LINUX
+    LIBS+= -lpthread
+}
+linux-g++-64 {
+    DEFINES += LINUX
+    LIBS+= -lpthread
+}
+macx:DEFINES += DARWIN
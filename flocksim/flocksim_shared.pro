@@ -0,0 +1,9 @@
+# libflocksim.so, the simulation core as a shared library for tools outside this tree.
+TEMPLATE = lib
+CONFIG += shared
+
+include(flocksim.pri)
+
+OBJECTS_DIR = obj/shared/
+
+TARGET = ../bin/flocksim
@@ -0,0 +1,10 @@
+# libflocksim.a, the simulation core as a static library. Built before the GUI and the tools, which link it.
+TEMPLATE = lib
+CONFIG += staticlib
+
+include(flocksim.pri)
+
+# kept apart from the objects of the shared library, which are compiled position independent
+OBJECTS_DIR = obj/static/
+
+TARGET = ../bin/flocksim
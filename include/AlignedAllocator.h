@@ -0,0 +1,87 @@
+#ifndef ALIGNEDALLOCATOR_H
+#define ALIGNEDALLOCATOR_H
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#ifdef WIN32
+    #include <malloc.h>
+#endif
+
+/*! \brief an aligned allocator for the std containers */
+/// @file AlignedAllocator.h
+/// @brief a std allocator that returns memory aligned to a fixed boundary, so the flock arrays start on a
+/// cache line and can be loaded with aligned SIMD instructions.
+/// @author Dionysios Toufexis
+/// @version 1.0
+/// @date 17/10/2026
+/// @class AlignedAllocator
+
+
+template <typename T, std::size_t Alignment = 64>
+class AlignedAllocator
+{
+public:
+    typedef T value_type;
+    typedef T *pointer;
+    typedef const T *const_pointer;
+    typedef T &reference;
+    typedef const T &const_reference;
+    typedef std::size_t size_type;
+    typedef std::ptrdiff_t difference_type;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the same allocator for another type, needed by the containers.
+    template <typename U>
+    struct rebind
+    {
+        typedef AlignedAllocator<U, Alignment> other;
+    };
+    //----------------------------------------------------------------------------------------------------------------------
+    AlignedAllocator() {}
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment> &) {}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief allocates room for _count elements on an Alignment boundary.
+    pointer allocate(size_type _count, const void * = 0)
+    {
+        if(_count == 0)
+        {
+            return 0;
+        }
+        void *memory = 0;
+#ifdef WIN32
+        memory = _aligned_malloc(_count * sizeof(T), Alignment);
+#else
+        if(posix_memalign(&memory, Alignment, _count * sizeof(T)) != 0)
+        {
+            memory = 0;
+        }
+#endif
+        if(memory == 0)
+        {
+            throw std::bad_alloc();
+        }
+        return static_cast<pointer>(memory);
+    }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief releases memory returned by allocate.
+    void deallocate(pointer _memory, size_type)
+    {
+#ifdef WIN32
+        _aligned_free(_memory);
+#else
+        std::free(_memory);
+#endif
+    }
+    //----------------------------------------------------------------------------------------------------------------------
+    size_type max_size() const {return size_type(-1) / sizeof(T);}
+    void construct(pointer _p, const T &_value) {new(_p) T(_value);}
+    void destroy(pointer _p) {_p->~T();}
+    //----------------------------------------------------------------------------------------------------------------------
+};
+
+template <typename T, typename U, std::size_t Alignment>
+inline bool operator==(const AlignedAllocator<T, Alignment> &, const AlignedAllocator<U, Alignment> &) {return true;}
+template <typename T, typename U, std::size_t Alignment>
+inline bool operator!=(const AlignedAllocator<T, Alignment> &, const AlignedAllocator<U, Alignment> &) {return false;}
+
+#endif // ALIGNEDALLOCATOR_H
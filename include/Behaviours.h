@@ -1,6 +1,11 @@
 #ifndef BEHAVIOURS_H
 #define BEHAVIOURS_H
-#include "boid.h"
+#include "FlockState.h"
+#include "SpatialGrid.h"
+#include "NeighbourList.h"
+#include "KdTree.h"
+#include "Octree.h"
+#include "SteerKernels.h"
 #include "ngl/Vector.h"
 
 /*! \brief the behaviour class */
@@ -25,28 +30,112 @@ public:
     //----------------------------------------------------------------------------------------------------------------------
     /// @brief Calculates the cohesion behaviour of the flock
     /// @param [in] _boidNumber the current boid.
-    /// @param [in] _boidList a dynamic array of all the boids.
-    void Cohesion(int &_boidNumber, std::vector <Boid*> & _boidList);
+    /// @param [in] _state the boids of the flock.
+    /// @param [in] _grid the spatial grid of the flock, only the cells around the boid are visited.
+    void Cohesion(int &_boidNumber, const FlockState &_state, const SpatialGrid &_grid);
     //----------------------------------------------------------------------------------------------------------------------
     /// @brief Calculates the alignmenth behaviour of the flock
     /// @param [in] _boidNumber the current boid.
-    /// @param [in] _boidList a dynamic array of all the boids.
-    void Alignment(int & _boidNumber, std::vector <Boid*> & _boidList);
+    /// @param [in] _state the boids of the flock.
+    /// @param [in] _grid the spatial grid of the flock, only the cells around the boid are visited.
+    void Alignment(int & _boidNumber, const FlockState &_state, const SpatialGrid &_grid);
     //----------------------------------------------------------------------------------------------------------------------
     /// @brief Calculates the seperation behaviour of the flock
     /// @param [in] _boidNumber the current boid.
-    /// @param [in] _boidList a dynamic array of all the boids.
-    void Seperation(int & _boidNumber, std::vector <Boid*> & _boidList);
+    /// @param [in] _state the boids of the flock.
+    /// @param [in] _grid the spatial grid of the flock, only the cells around the boid are visited.
+    void Seperation(int & _boidNumber, const FlockState &_state, const SpatialGrid &_grid);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief Calculates the cohesion, alignment and seperation of the flock in one pass over the local boids.
+    /// Every pair is tested once on its squared distance, so no square root is taken for the radius tests.
+    /// The candidates are packed and handed to the widest SteerKernels kernel the machine supports, the one
+    /// instantiated for the rules set with setRules. Only the neighbour sums of _boidNumber are kept, steering
+    /// turns them into the steering of the boid, so boids can be steered in any order or on several Behaviours
+    /// at once. steering<SteerKernels::ALL_RULES> agrees with calling Cohesion, Alignment, Seperation and
+    /// BehaviourSetup in turn up to float rounding, a pair that sits exactly on one of the radii may fall on the
+    /// other side of the test, they differ by less than 1e-5 relative.
+    /// @param [in] _boidNumber the current boid.
+    /// @param [in] _state the boids of the flock.
+    /// @param [in] _grid the spatial grid of the flock, only the cells around the boid are visited.
+    void Steer(int & _boidNumber, const FlockState &_state, const SpatialGrid &_grid);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief Steer over the cached neighbour list of the boid instead of the grid cells around it. The list
+    /// holds every boid within the behaviour radius and a few more, the radius tests drop the extra ones so
+    /// the result is the same as with the grid apart from the order the neighbours are summed in.
+    /// @param [in] _boidNumber the current boid.
+    /// @param [in] _state the boids of the flock.
+    /// @param [in] _list the neighbour lists of the flock, up to date for _state.
+    void Steer(int & _boidNumber, const FlockState &_state, const NeighbourList &_list);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the topological version of Steer, cohesion and alignment take the _k nearest boids whatever their
+    /// distance instead of every boid within the behaviour distance, so the work per boid stays the same
+    /// however dense the flock gets. Separation still only pushes away from those within the flock distance.
+    /// @param [in] _boidNumber the current boid.
+    /// @param [in] _state the boids of the flock.
+    /// @param [in] _tree the kd-tree of the flock, built for _state.
+    /// @param [in] _k the number of neighbours.
+    void Steer(int & _boidNumber, const FlockState &_state, const KdTree &_tree, int _k);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the Barnes-Hut version of Steer for large behaviour distances. Groups of boids that lie inside the
+    /// behaviour distance, or far enough away under the opening angle, enter cohesion and alignment through
+    /// the sums of their octree node instead of one by one. Separation is always exact.
+    /// @param [in] _boidNumber the current boid.
+    /// @param [in] _state the boids of the flock.
+    /// @param [in] _tree the octree of the flock, built for _state.
+    /// @param [in] _theta the opening angle, larger is faster and less accurate.
+    void Steer(int & _boidNumber, const FlockState &_state, const Octree &_tree, float _theta);
     //----------------------------------------------------------------------------------------------------------------------
     /// @brief our behaviour set method. Sets the final velocity with all the behaviours
     ngl::Vector m_behaviourSet();
     //----------------------------------------------------------------------------------------------------------------------
-    /// @brief Calculates the destination behaviour of the flock
-    /// @param [in] _boidNumber the current boid.
-    /// @param [in] _boidList a dynamic array of all the boids.
-    void Destination(int & _boidNumber, std::vector <Boid*> & _boidList);
+    /// @brief the steering of the three pass version, from the last Cohesion, Alignment and Seperation.
+    ngl::Vector BehaviourSetup() const;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the steering of _boidNumber from the sums of the last Steer. Only the rules in Rules are worked
+    /// out and added, a rule left out costs nothing, so Rules should hold every rule whose weight is not 0
+    /// and at most the rules set with setRules.
+    /// @param [in] _boidNumber the boid Steer was last called for.
+    /// @param [in] _state the boids of the flock.
+    template <int Rules>
+    ngl::Vector steering(int _boidNumber, const FlockState &_state) const
+    {
+        const int count = m_sums.m_count + 1;
+        ngl::Vector cohesion, alignment, separation;
+        if(Rules & SteerKernels::COHESION)
+        {
+            cohesion.set(m_sums.m_cohesionX, m_sums.m_cohesionY, m_sums.m_cohesionZ);
+            cohesion /= count;
+            cohesion = (cohesion - _state.getPosition(_boidNumber));
+            cohesion.normalize();
+        }
+        if(Rules & SteerKernels::ALIGNMENT)
+        {
+            const float behaviourDistanceSq = m_BehaviourDistance * m_BehaviourDistance;
+            alignment.set(m_sums.m_alignmentX, m_sums.m_alignmentY, m_sums.m_alignmentZ);
+            if (alignment.lengthSquared() > behaviourDistanceSq)
+            {
+                alignment.normalize();
+            }
+            alignment /= count;
+            alignment = (alignment - _state.getVelocity(_boidNumber));
+        }
+        if(Rules & SteerKernels::SEPARATION)
+        {
+            separation.set(m_sums.m_separationX, m_sums.m_separationY, m_sums.m_separationZ);
+        }
+        return blend<Rules>(cohesion, alignment, separation);
+    }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the rules whose weight is not 0
+    int activeRules() const;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief picks the kernel Steer runs to the one that only adds up the sums of _rules, ALL_RULES by default
+    void setRules(int _rules);
+    int getRules() const {return m_rules;}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the neighbour sums the last Steer added up
+    const NeighbourSums &getSums() const {return m_sums;}
     //----------------------------------------------------------------------------------------------------------------------
-    ngl::Vector BehaviourSetup();
     /// @brief GUI related sets for the simulation
     //----------------------------------------------------------------------------------------------------------------------
     void setBehaviourDistance(double distance) {m_BehaviourDistance = distance;}
@@ -54,6 +143,11 @@ public:
     void setCohesionForce(double cohesion) {m_cohesionForce = cohesion;}
     void setSeparationForce(double separation) {m_seperationForce = separation;}
     void setAlignment(double alignment) {m_alignment = alignment;}
+    double getBehaviourDistance() const {return m_BehaviourDistance;}
+    double getFlockDistance() const {return m_flockDistance;}
+    double getCohesionForce() const {return m_cohesionForce;}
+    double getSeparationForce() const {return m_seperationForce;}
+    double getAlignment() const {return m_alignment;}
     //----------------------------------------------------------------------------------------------------------------------
     /// @brief our ctor
     ~Behaviours();
@@ -61,12 +155,6 @@ public:
 
 private:
 
-    //----------------------------------------------------------------------------------------------------------------------
-    /// @brief our boid pointer
-    Boid *m_boid;
-    //----------------------------------------------------------------------------------------------------------------------
-    /// @brief our boidlist pointer
-    std::vector <Boid*> *_boidList;
     //----------------------------------------------------------------------------------------------------------------------
     /// @brief variable to store the value of cohesion the check.
     ngl::Vector m_coherence;
@@ -95,17 +183,66 @@ private:
     /// @brief variable to store the positions between the current boid to the local boids.
     double m_flockDistance;
     //----------------------------------------------------------------------------------------------------------------------
-    /// @brief variable to store the behaviour movement.
-    ngl::Vector m_behaviourSetup;
-    /// @brief variable to store the final seperation velocity.
-    //----------------------------------------------------------------------------------------------------------------------
-    ngl::Vector m_seperationSet;
-    /// @brief variable to store the final cohesion velocity.
-    //----------------------------------------------------------------------------------------------------------------------
-    ngl::Vector m_cohesionSet;
-    //----------------------------------------------------------------------------------------------------------------------
-    /// @brief variable to store the final alignment velocity.
-    ngl::Vector m_alighmentSet;
+    /// @brief the rules Steer adds up the sums of and the kernel it runs for them
+    int m_rules;
+    AccumulateKernel m_kernel;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the neighbour sums of the boid of the last Steer
+    NeighbourSums m_sums;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the candidate boids returned by the grid, kept as a member so it is not reallocated for every boid.
+    std::vector <int> m_neighbours;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the squared distances of the nearest boids returned by the kd-tree.
+    std::vector <float> m_neighbourDistances;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the candidates of the current boid packed for the SteerKernels, padded to SteerKernels::s_padding.
+    FloatArray m_batchX, m_batchY, m_batchZ, m_batchVX, m_batchVY, m_batchVZ;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief grows the packed arrays to hold _count boids and the padding
+    void reserveBatch(int _count);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief copies boid _boid of _state into slot _slot of the packed arrays
+    inline void packNeighbour(int _slot, const FlockState &_state, int _boid)
+    {
+        m_batchX[_slot] = _state.m_posX[_boid];
+        m_batchY[_slot] = _state.m_posY[_boid];
+        m_batchZ[_slot] = _state.m_posZ[_boid];
+        m_batchVX[_slot] = _state.m_velX[_boid];
+        m_batchVY[_slot] = _state.m_velY[_boid];
+        m_batchVZ[_slot] = _state.m_velZ[_boid];
+    }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief pads the _packed neighbours and runs the kernel over them into m_sums. Only the neighbours within
+    /// _reachSq count for cohesion and alignment.
+    void accumulatePacked(int _boidNumber, const FlockState &_state, int _packed, float _reachSq);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief weighs the behaviours in Rules, adds them up and limits the length of the steering.
+    /// The seperation correction has always been ngl::Vector(-1), which is (-1, 0, 0), so only the x of the
+    /// seperation steers, kept as it is so the flock moves as it always did.
+    template <int Rules>
+    ngl::Vector blend(const ngl::Vector &_cohesion, const ngl::Vector &_alignment, const ngl::Vector &_separation) const
+    {
+        ngl::Vector steering(0.0f, 0.0f, 0.0f);
+        if(Rules & SteerKernels::SEPARATION)
+        {
+            steering.m_x = -((float)m_seperationForce * _separation.m_x);
+        }
+        if(Rules & SteerKernels::COHESION)
+        {
+            steering += _cohesion * (float)m_cohesionForce;
+        }
+        if(Rules & SteerKernels::ALIGNMENT)
+        {
+            steering += _alignment * (float)m_alignment;
+        }
+        if (steering.lengthSquared() > 0.25f)
+        {
+            steering.normalize();
+            steering *= 0.5f;
+        }
+        return steering;
+    }
     //----------------------------------------------------------------------------------------------------------------------
 };
 
@@ -0,0 +1,54 @@
+#ifndef BOUNDARY_H
+#define BOUNDARY_H
+#include "ngl/Vector.h"
+
+/*! \brief the boundary struct */
+/// @file Boundary.h
+/// @brief the box the flock is kept in and what happens to a boid that reaches it.
+/// @author Dionysios Toufexis
+/// @version 1.0
+/// @date 17/10/2026
+/// @class Boundary
+/// @brief a box centred on the origin held as six planes in the order of ngl::BBox::getNormalArray, top and
+/// bottom, right and left, front and back. FlockState::constrain applies it to the boids right after they
+/// are integrated.
+
+struct Boundary
+{
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief REFLECT bounces a boid off the plane it touches the way the bounding box collision always did,
+    /// CLAMP stops it on the inside of the box and WRAP takes it out of one side and into the opposite one.
+    enum Mode {REFLECT, CLAMP, WRAP};
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the default is a reflecting unit box
+    Boundary() : m_mode(REFLECT)
+    {
+        m_normals[0].set(0.0f, 1.0f, 0.0f);
+        m_normals[1].set(0.0f, -1.0f, 0.0f);
+        m_normals[2].set(1.0f, 0.0f, 0.0f);
+        m_normals[3].set(-1.0f, 0.0f, 0.0f);
+        m_normals[4].set(0.0f, 0.0f, 1.0f);
+        m_normals[5].set(0.0f, 0.0f, -1.0f);
+        setSize(1.0f, 1.0f, 1.0f);
+    }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief sets the size of the box, the planes sit half of it away from the centre
+    void setSize(float _width, float _height, float _depth)
+    {
+        m_extents[0] = m_extents[1] = _height / 2.0f;
+        m_extents[2] = m_extents[3] = _width / 2.0f;
+        m_extents[4] = m_extents[5] = _depth / 2.0f;
+    }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief what happens at the planes
+    Mode m_mode;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the outward normals of the planes
+    ngl::Vector m_normals[6];
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the distance of each plane from the centre
+    float m_extents[6];
+    //----------------------------------------------------------------------------------------------------------------------
+};
+
+#endif // BOUNDARY_H
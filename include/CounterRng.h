@@ -0,0 +1,56 @@
+#ifndef COUNTERRNG_H
+#define COUNTERRNG_H
+#include <stdint.h>
+
+/*! \brief the counter based random number generator */
+/// @file CounterRng.h
+/// @brief random numbers computed from a seed and a counter instead of drawn from a shared state.
+/// @author Dionysios Toufexis
+/// @version 1.0
+/// @date 17/10/2026
+/// @class CounterRng
+/// @brief every number is a hash of the seed and its index, so any thread can produce the numbers of any
+/// range of boids without locking and the flock comes out the same whatever the number of threads. The hash
+/// is the SplitMix64 finaliser which passes BigCrush on consecutive counters.
+
+class CounterRng
+{
+public:
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief our ctor
+    /// @param [in] _seed selects the sequence
+    explicit CounterRng(uint64_t _seed = 0x853c49e6748fea9bULL) : m_seed(_seed) {}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the 64 random bits at _counter
+    inline uint64_t bits(uint64_t _counter) const
+    {
+        uint64_t z = m_seed + _counter * 0x9e3779b97f4a7c15ULL;
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief a float in [0,1) from the top 24 bits at _counter
+    inline float uniform(uint64_t _counter) const
+    {
+        return (bits(_counter) >> 40) * (1.0f / 16777216.0f);
+    }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief a float in [-_extent,_extent) at _counter, the range of ngl::Random::randomNumber
+    inline float symmetric(uint64_t _counter, float _extent) const
+    {
+        return (uniform(_counter) * 2.0f - 1.0f) * _extent;
+    }
+    //----------------------------------------------------------------------------------------------------------------------
+    uint64_t getSeed() const {return m_seed;}
+    void setSeed(uint64_t _seed) {m_seed = _seed;}
+    //----------------------------------------------------------------------------------------------------------------------
+
+private:
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the seed of the sequence
+    uint64_t m_seed;
+    //----------------------------------------------------------------------------------------------------------------------
+};
+
+#endif // COUNTERRNG_H
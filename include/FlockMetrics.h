@@ -0,0 +1,58 @@
+#ifndef FLOCKMETRICS_H
+#define FLOCKMETRICS_H
+#include <vector>
+#include "FlockState.h"
+#include "KdTree.h"
+#include "SpatialGrid.h"
+#include "ThreadPool.h"
+
+/*! \brief the flock metrics class */
+/// @file FlockMetrics.h
+/// @brief measures how ordered a flock is, so runs with different behaviour parameters can be compared
+/// without watching them.
+/// @author Dionysios Toufexis
+/// @version 1.0
+/// @date 17/10/2026
+/// @class FlockMetrics
+/// @brief the polarization is the length of the mean heading of the boids, 1 when they all fly the same way
+/// and close to 0 when they fly every way. The nearest neighbour distance is the mean over the boids of the
+/// distance to the closest other boid, found through a kd-tree. The clusters are the groups of boids joined by
+/// chains of boids closer than a link distance, found with a union find over the pairs of the spatial grid.
+/// The scratch memory is kept between measures so measuring a run every step does not allocate.
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief what FlockMetrics measured on a flock
+struct OrderMetrics
+{
+    double m_polarization;
+    double m_nearestDistance;
+    int m_clusters;
+    OrderMetrics() : m_polarization(0.0), m_nearestDistance(0.0), m_clusters(0) {}
+};
+
+class FlockMetrics
+{
+public:
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief measures the current positions and velocities of a flock.
+    /// @param [in] _state the boids of the flock.
+    /// @param [in] _linkDistance two boids closer than it are in the same cluster.
+    /// @param [in] _pool the workers the kd-tree is built over.
+    OrderMetrics measure(const FlockState &_state, float _linkDistance, ThreadPool &_pool);
+    //----------------------------------------------------------------------------------------------------------------------
+
+private:
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the root of the cluster of a boid, halving the path on the way
+    int root(int _boid);
+    //----------------------------------------------------------------------------------------------------------------------
+    KdTree m_tree;
+    SpatialGrid m_grid;
+    /// @brief the union find forest of the clusters
+    std::vector <int> m_parent;
+    std::vector <int> m_neighbours;
+    std::vector <float> m_distancesSq;
+    //----------------------------------------------------------------------------------------------------------------------
+};
+
+#endif // FLOCKMETRICS_H
@@ -0,0 +1,102 @@
+#ifndef FLOCKRENDERER_H
+#define FLOCKRENDERER_H
+#include <vector>
+#include <string>
+#include <ngl/Types.h>
+#include <ngl/TransformStack.h>
+#include <ngl/Camera.h>
+#include "FlockState.h"
+#include "TrajectoryReader.h"
+
+/*! \brief the flock renderer class */
+/// @file FlockRenderer.h
+/// @brief draws every boid of a frame with one instanced draw call.
+/// @author Dionysios Toufexis
+/// @version 1.0
+/// @date 17/10/2026
+/// @class FlockRenderer
+/// @brief owns a sphere VAO and a per instance buffer holding the position, scale and colour of every boid.
+/// A draw packs the frame into the buffer, uploads it in one go and draws all the spheres with
+/// glDrawElementsInstanced, so the number of GL calls does not grow with the flock. It needs the
+/// PhongInstanced shader, the instance attributes are bound to the locations below. Only GL 3.3 features
+/// are used so it also runs on Mesa's llvmpipe software renderer.
+/// @brief it must be created and used on the thread that owns the GL context. It is the GUI side of the
+/// flock, the simulation in libflocksim never includes it.
+
+class FlockRenderer
+{
+public:
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the attribute locations of the instance data, the sphere uses 0 (inVert) and 2 (inNormal) like NGL
+    enum InstanceAttribute {POSITION = 3, SCALE = 4, COLOUR = 5};
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief our ctor, builds the sphere and the buffers so a GL context must be current.
+    /// @param [in] _radius the radius of the sphere, the same as the sphere the boids were drawn with before.
+    /// @param [in] _precision the number of stacks of the sphere, it gets twice as many slices.
+    FlockRenderer(float _radius = 0.8f, int _precision = 8);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief our dtor, deletes the VAO and the buffers
+    ~FlockRenderer();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief uploads the boids of the frame and draws them, the shader and its matrices have to be set already.
+    /// @param [in] _frame the boids to draw, only the position, scale, colour and wireframe arrays are read.
+    void draw(const FlockState &_frame);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief draws a recorded frame straight from its arrays, every boid gets the same scale and colour.
+    /// @param [in] _frame the frame of a TrajectoryReader, only the positions are read.
+    /// @param [in] _scale the scale of every boid.
+    /// @param [in] _colour the colour of every boid.
+    /// @param [in] _wireframe draws the spheres as lines.
+    void draw(const TrajectoryFrame &_frame, const ngl::Vector &_scale, const ngl::Colour &_colour, bool _wireframe);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief draws a frame published by the SimulationThread with the matrices of the whole flock loaded once,
+    /// it does not touch the flock so it is safe to call while the flock is being updated.
+    /// @param [in] _frame the boids to draw.
+    /// @param [in] _shaderName an instanced shader, PhongInstanced.
+    void drawFlock(const FlockState &_frame, const std::string &_shaderName, ngl::TransformStack &_transformStack, ngl::Camera *_cam);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief draws a recorded frame the same way, the positions are read straight from the mapped file.
+    /// @param [in] _frame the recorded boids to draw.
+    /// @param [in] _look a frame whose first boid gives the scale, colour and wireframe of every recorded boid,
+    /// the defaults of FlockState are used if it is empty.
+    void drawFlock(const TrajectoryFrame &_frame, const FlockState &_look, const std::string &_shaderName, ngl::TransformStack &_transformStack, ngl::Camera *_cam);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the number of floats per boid in the instance buffer, position, scale and colour
+    static const int s_instanceFloats = 10;
+    //----------------------------------------------------------------------------------------------------------------------
+
+private:
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief builds the sphere mesh into m_meshVBO and m_indexVBO
+    void buildSphere(float _radius, int _precision);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief loads the matrices of the transform stack and the camera to the current shader
+    static void loadMatricesToShader(ngl::TransformStack &_tx, ngl::Camera *_cam);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief uploads the first _count boids of m_instanceData and draws them
+    void upload(int _count, bool _wireframe);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the vertex array holding the sphere and the instance attributes
+    GLuint m_vao;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the interleaved positions and normals of the sphere
+    GLuint m_meshVBO;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the triangle indices of the sphere
+    GLuint m_indexVBO;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the per instance data, refilled every draw
+    GLuint m_instanceVBO;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the number of indices of the sphere
+    GLsizei m_indexCount;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the number of boids the instance buffer has room for
+    int m_instanceCapacity;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the packed instance data, kept so it is not reallocated every frame
+    std::vector <GLfloat> m_instanceData;
+    //----------------------------------------------------------------------------------------------------------------------
+};
+
+#endif // FLOCKRENDERER_H
@@ -0,0 +1,131 @@
+#ifndef FLOCKSIM_H
+#define FLOCKSIM_H
+#include <stdint.h>
+#include <string>
+
+class Flock;
+struct SpawnDistribution;
+
+/*! \brief the flock simulation class */
+/// @file FlockSim.h
+/// @brief the plain C++ face of libflocksim, create a flock, step it, read the boids and set the parameters
+/// without a Qt widget, a GL context, NGLInit or GLEW.
+/// @author Dionysios Toufexis
+/// @version 1.0
+/// @date 17/10/2026
+/// @class FlockSim
+/// @brief owns a Flock and its thread pool. The header only needs the standard library, so a render farm job
+/// or another tool links libflocksim and includes this file alone. The positions and velocities are handed
+/// out as the structure of arrays the flock steps on, nothing is copied. getFlock gives the whole Flock to
+/// the callers that include flock.h, the GUI and the benchmarks, for what is not wrapped here.
+/// @brief a FlockSim is used from one thread at a time, the flock spreads each step over its own workers.
+
+class FlockSim
+{
+public:
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief how the boids pick their neighbours, the same as Flock::NeighbourMode
+    enum NeighbourMode {METRIC, TOPOLOGICAL, APPROXIMATE};
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief what a boid does at the box, the same as Boundary::Mode
+    enum BoundaryMode {REFLECT, CLAMP, WRAP};
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the parameters of the simulation, the defaults are the ones the GUI starts with
+    struct Parameters
+    {
+        /// @brief the distance cohesion and alignment reach and the distance separation pushes away within
+        double m_behaviourDistance;
+        double m_flockDistance;
+        /// @brief the weights of the rules, a rule with a weight of 0 is not computed
+        double m_cohesion;
+        double m_separation;
+        double m_alignment;
+        NeighbourMode m_neighbourMode;
+        /// @brief the neighbours of TOPOLOGICAL
+        int m_topologicalCount;
+        /// @brief the opening angle of APPROXIMATE
+        float m_openingAngle;
+        /// @brief how far past the behaviour distance the neighbour lists reach so they are kept over steps
+        float m_neighbourSkin;
+        BoundaryMode m_boundary;
+        Parameters() :
+            m_behaviourDistance(20.0), m_flockDistance(4.0), m_cohesion(2.0), m_separation(9.0), m_alignment(10.0),
+            m_neighbourMode(METRIC), m_topologicalCount(7), m_openingAngle(0.5f), m_neighbourSkin(16.0f),
+            m_boundary(REFLECT) {}
+    };
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the boids as the flock holds them, the arrays are m_count long and stay valid until the next call
+    /// that steps or resizes the flock
+    struct State
+    {
+        int m_count;
+        const float *m_posX;
+        const float *m_posY;
+        const float *m_posZ;
+        const float *m_velX;
+        const float *m_velY;
+        const float *m_velZ;
+    };
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief our ctor, makes the flock in the spawn cube of the seed with the default parameters.
+    /// @param [in] _width,_height,_depth the size of the box centred on the origin the boids are kept in.
+    /// @param [in] _boids the number of boids.
+    /// @param [in] _seed the seed of the spawn positions, the flock of a seed is the same on every machine.
+    /// @param [in] _threads the workers of the flock, 0 for one per hardware thread.
+    /// @param [in] _spawnSpeed 0 starts every boid with the velocity of FlockState, above 0 the boids fly off at
+    /// this speed in directions drawn from the seed.
+    FlockSim(float _width, float _height, float _depth, int _boids, uint64_t _seed = 1, int _threads = 0, float _spawnSpeed = 0.0f);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief our dtor
+    ~FlockSim();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief runs _steps updates of the flock
+    void step(int _steps = 1);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the boids after the last step
+    State getState() const;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief places one boid, for a caller that brings its own start state
+    void setBoid(int _index, float _x, float _y, float _z, float _vx, float _vy, float _vz);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief adds boids in the spawn cube, at the spawn speed of the ctor, and removes the last ones
+    void spawn(int _count);
+    void despawn(int _count);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief creates the boids from scratch with a new seed, the number of boids stays
+    void reset(uint64_t _seed);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief sets every parameter, the neighbour lists are only thrown away if their mode or skin changed
+    void setParameters(const Parameters &_parameters);
+    /// @brief the parameters the flock runs with, a loaded snapshot brings its own
+    Parameters getParameters() const;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief adds a sphere the boids bounce off
+    /// @returns the index of the obstacle in the obstacle set of the flock
+    int addObstacle(float _x, float _y, float _z, float _radius);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief writes and reads the flock as a FlockSnapshot
+    /// @returns false if the file could not be written or read
+    bool saveSnapshot(const std::string &_file) const;
+    bool loadSnapshot(const std::string &_file);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the flock itself, for the callers that include flock.h
+    Flock &getFlock() {return *m_flock;}
+    const Flock &getFlock() const {return *m_flock;}
+    //----------------------------------------------------------------------------------------------------------------------
+
+private:
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief a FlockSim owns its flock and is not copied
+    FlockSim(const FlockSim &);
+    FlockSim &operator=(const FlockSim &);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the spawn cube with the spawn speed of the ctor
+    SpawnDistribution spawnDistribution() const;
+    //----------------------------------------------------------------------------------------------------------------------
+    Flock *m_flock;
+    float m_spawnSpeed;
+    //----------------------------------------------------------------------------------------------------------------------
+};
+
+#endif // FLOCKSIM_H
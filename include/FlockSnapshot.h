@@ -0,0 +1,84 @@
+#ifndef FLOCKSNAPSHOT_H
+#define FLOCKSNAPSHOT_H
+#include <stdint.h>
+
+/*! \brief the flock snapshot format */
+/// @file FlockSnapshot.h
+/// @brief the binary format Flock::saveSnapshot writes and Flock::loadSnapshot maps back in.
+/// @author Dionysios Toufexis
+/// @version 1.0
+/// @date 17/10/2026
+/// @brief a snapshot is a SnapshotHeader followed by sections of plain arrays, each starting on a 64 byte
+/// boundary so a mapped file can be copied into the aligned FlockState arrays a cache line at a time. The
+/// sections come in a fixed order and their sizes follow from the counts in the header, so no table of
+/// offsets is stored. All the numbers are little endian.
+///
+///     SnapshotHeader
+///     obstacle x, y, z, radius                                            (m_obstacles floats each)
+///     posX, posY, posZ, velX, velY, velZ, lastX, lastY, lastZ,
+///     newDirX, newDirY, newDirZ, size, scale x, y, z, colour r, g, b, a   (m_boids floats each)
+///     hit, wireframe                                                      (m_boids bytes each)
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief everything about a flock that is not one value per boid. It can be read on its own with
+/// Flock::readSnapshotHeader, so the GUI can show the settings of a snapshot before loading it.
+struct SnapshotSettings
+{
+    /// @brief the behaviour parameters
+    double m_behaviourDistance;
+    double m_flockDistance;
+    double m_cohesion;
+    double m_separation;
+    double m_alignment;
+    /// @brief the velocity constraints of the boids
+    float m_minVelocity;
+    float m_maxVelocity;
+    /// @brief the size of the box and what happens at its planes, a Boundary::Mode
+    float m_boxWidth;
+    float m_boxHeight;
+    float m_boxDepth;
+    int32_t m_boundaryMode;
+    /// @brief the obstacle given to the ctor of the flock, m_hasObstacle is 0 if there was none
+    float m_obstacleX;
+    float m_obstacleY;
+    float m_obstacleZ;
+    float m_obstacleRadius;
+    int32_t m_hasObstacle;
+    /// @brief a Flock::NeighbourMode and the settings of the neighbour modes
+    int32_t m_neighbourMode;
+    int32_t m_topologicalCount;
+    float m_openingAngle;
+    float m_neighbourSkin;
+    int32_t m_pad;
+    /// @brief the counter of the spawn generator, so boids spawned after a load are the same as before the save
+    uint64_t m_rngCounter;
+};
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the start of a snapshot file
+struct SnapshotHeader
+{
+    char m_magic[4];
+    uint32_t m_version;
+    /// @brief the number of boids and of obstacles next to the one given to the ctor
+    uint64_t m_boids;
+    uint64_t m_obstacles;
+    /// @brief the size of the whole file, a file cut short is not loaded
+    uint64_t m_bytes;
+    SnapshotSettings m_settings;
+};
+
+namespace FlockSnapshot
+{
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the version written into the snapshots, a snapshot of another version is not loaded
+    const uint32_t s_version = 1;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the number of float arrays per boid and per obstacle
+    const int s_boidFloatArrays = 20;
+    const int s_obstacleFloatArrays = 4;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief rounds a file offset up to the next section boundary
+    inline uint64_t align(uint64_t _offset) {return (_offset + 63u) & ~(uint64_t)63u;}
+}
+
+#endif // FLOCKSNAPSHOT_H
@@ -0,0 +1,137 @@
+#ifndef FLOCKSTATE_H
+#define FLOCKSTATE_H
+#include <vector>
+#include "AlignedAllocator.h"
+#include "Boundary.h"
+#include "ngl/Vector.h"
+#include "ngl/Colour.h"
+
+/*! \brief the flock state class */
+/// @file FlockState.h
+/// @brief stores every boid of the flock as a structure of arrays.
+/// @author Dionysios Toufexis
+/// @version 1.0
+/// @date 17/10/2026
+/// @class FlockState
+/// @brief the hot data read by the neighbour search, the behaviours, the collisions and the integration lives
+/// in separate contiguous float arrays aligned to a cache line, one array per component. A neighbour test
+/// only pulls in the position arrays instead of a whole boid. The data only the drawing and the GUI needs
+/// (scale, colour, wireframe) is kept in separate cold arrays. Boid is a thin view on one entry.
+
+/// @brief an array of floats starting on a 64 byte boundary
+typedef std::vector <float, AlignedAllocator<float, 64> > FloatArray;
+
+class FlockState
+{
+public:
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief our ctor
+    FlockState();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the number of boids in the flock
+    inline int size() const {return (int)m_posX.size();}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief reserves room for _count boids in every array
+    void reserve(int _count);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief adds a boid at the end of the flock with the default velocity and looks.
+    /// @param [in] _position the position of the new boid
+    void addBoid(const ngl::Vector &_position);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief adds _count boids at the end of the flock with the default velocity and looks at the origin.
+    /// Every array grows once so adding a large batch costs a fill per array and at most one allocation.
+    /// @param [in] _count the number of boids to add, cut down so the size of the flock still fits an int.
+    /// @returns the index of the first new boid, the caller places them.
+    /// @throws std::bad_alloc if the arrays could not grow, the flock is then left as it was.
+    int addBoids(int _count);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief removes the last _count boids of the flock, the memory is kept.
+    void removeLast(int _count = 1);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief removes any boid by moving the last boid into its place, so the order of the boids changes.
+    /// @param [in] _i the boid to remove.
+    void swapRemove(int _i);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief removes every boid, the memory is kept for the next fill so a reset does not go back to the
+    /// allocator unless the flock grows past its largest size so far.
+    void clear();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief gathers the position of a boid into a vector
+    inline ngl::Vector getPosition(int _i) const {return ngl::Vector(m_posX[_i], m_posY[_i], m_posZ[_i]);}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief scatters a vector into the position of a boid
+    inline void setPosition(int _i, const ngl::Vector &_p) {m_posX[_i] = _p.m_x; m_posY[_i] = _p.m_y; m_posZ[_i] = _p.m_z;}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief gathers the velocity of a boid into a vector
+    inline ngl::Vector getVelocity(int _i) const {return ngl::Vector(m_velX[_i], m_velY[_i], m_velZ[_i]);}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief scatters a vector into the velocity of a boid
+    inline void setVelocity(int _i, const ngl::Vector &_v) {m_velX[_i] = _v.m_x; m_velY[_i] = _v.m_y; m_velZ[_i] = _v.m_z;}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief adds the steering to the velocity of a boid, applies the velocity constraints and moves it.
+    /// The boid is read from this state and written to _next, so every boid of an update sees the same frame
+    /// whatever order the boids are moved in.
+    /// @param [in] _i the boid to move.
+    /// @param [in] _steering the steering returned by the behaviours.
+    /// @param [out] _next the state of the next frame, its motion arrays must have the size of this one.
+    void integrate(int _i, const ngl::Vector &_steering, FlockState &_next) const;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief applies the boundary to the boids [_begin, _end) of _next right after they were integrated, while
+    /// they are still in the cache. Four boids are done at a time with SSE and without branches, the boid sizes
+    /// are read from this state.
+    /// @param [in] _boundary the box and what happens at its planes.
+    /// @param [in,out] _next the integrated boids, their positions and velocities are changed in place.
+    void constrain(int _begin, int _end, const Boundary &_boundary, FlockState &_next) const;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief constrain for a boundary mode known when compiling, the mode of _boundary is not read. The three
+    /// modes are instantiated in FlockState.cpp, the runtime constrain picks one of them.
+    template <Boundary::Mode Mode>
+    void constrain(int _begin, int _end, const Boundary &_boundary, FlockState &_next) const;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief resizes the position, velocity, last position and direction arrays only. Used for the back
+    /// buffer of the update which never holds the cold data.
+    void resizeMotion(int _count);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief swaps the position, velocity, last position and direction arrays with the back buffer
+    void swapMotion(FlockState &_next);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief copies what the drawing needs (position, size, scale, colour and wireframe) from another state.
+    /// Used to fill the frames the simulation thread hands to the GUI, the other arrays are left empty.
+    void copyDrawData(const FlockState &_source);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the maximum allowed velocity of every boid (used as a velocity constraint)
+    float m_maxVelocity;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the minimum allowed velocity of every boid (used as a velocity constraint)
+    float m_minVelocity;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the current position of the boids
+    FloatArray m_posX, m_posY, m_posZ;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the velocity of the boids
+    FloatArray m_velX, m_velY, m_velZ;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the position of the boids at the end of the last integration
+    FloatArray m_lastX, m_lastY, m_lastZ;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the movement the boids picked up since the last integration, used when they bounce off the obstacle
+    FloatArray m_newDirX, m_newDirY, m_newDirZ;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the collision size of the boids. Used in BBox and Sphere Collision.
+    FloatArray m_size;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief flag set when a boid hits the obstacle
+    std::vector <char> m_hit;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief cold data only read by the drawing, the scale of the boids
+    std::vector <ngl::Vector> m_scale;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief cold data only read by the drawing, the colour of the boids
+    std::vector <ngl::Colour> m_colour;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief cold data only read by the drawing, the wireframe flag of the boids
+    std::vector <char> m_wireframe;
+    //----------------------------------------------------------------------------------------------------------------------
+};
+
+#endif // FLOCKSTATE_H
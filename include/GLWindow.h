@@ -14,6 +14,9 @@
 #include <QTime>
 #include "boid.h"
 #include "flock.h"
+#include "SimulationThread.h"
+#include "FlockRenderer.h"
+#include "TrajectoryReader.h"
 #include "ngl/BBox.h"
 #include "obstacle.h"
 
@@ -47,8 +50,8 @@ public :
     int  getCurrentBoidSize();
     void resetFlock();
     void applyFlock(int size);
-    void addBoidsToFlock();
-    void removeBoidsFromFlock();
+    void addBoidsToFlock(int count = 10);
+    void removeBoidsFromFlock(int count = 10);
     void setBoidSize(double size);
     void setBoidColor(QColor colour);
     void setFlockWireframe(bool value);
@@ -63,9 +66,24 @@ public :
     void setSimCohesion(double cohesion);
     void setSimSeparation(double separation);
     void setSimAlignment(double alignment);
+    void setSimTopological(bool value);
+    void setSimNeighbourCount(int count);
 
     void setBackgroundColour(ngl::Colour colour);
     void setBBoxSize(ngl::Vector size);
+
+    void saveSnapshot(const std::string &file);
+    void loadSnapshot(const std::string &file, int boids);
+
+    void startRecording(const std::string &file);
+    void stopRecording();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief maps a recorded trajectory and plays it back instead of the simulation, which is paused meanwhile.
+    /// @returns false if the file is not a trajectory.
+    bool openReplay(const std::string &file);
+    void closeReplay();
+    int  getReplayFrameCount() const;
+    void setReplayFrame(int frame);
     //-----------------------------------
     /// @brief
     //void update();
@@ -129,12 +147,34 @@ private :
     //----------------------------------------------------------------------------------------------------------------------
     Obstacle *obstacle;
     //----------------------------------------------------------------------------------------------------------------------
-    /// @brief a pointer to the flock class to have access to the methods
+    /// @brief the copy of the obstacle the flock collides with, only changed on the simulation thread
+    //----------------------------------------------------------------------------------------------------------------------
+    Obstacle *m_simObstacle;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief a pointer to the flock class, once the simulation runs it is only changed through m_simulation
     Flock *flock;
     //----------------------------------------------------------------------------------------------------------------------
+    /// @brief runs the flock away from the GUI thread and hands back the finished frames
+    SimulationThread *m_simulation;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the number of boids the GUI asked for, the flock itself lives on the simulation thread
+    int m_flockSize;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief draws the frames of the flock with one instanced draw call
+    FlockRenderer *m_flockRenderer;
+    //----------------------------------------------------------------------------------------------------------------------
     /// @brief variable to store the GL Depth Color
     ngl::Colour m_backgroundColour;
     //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the mapped trajectory being played back, not open outside of replay
+    TrajectoryReader m_replay;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the frame of m_replay drawn next
+    int m_replayFrame;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the text the profile overlay is drawn with, only made when the profiler is compiled in
+    ngl::Text *m_text;
+    //----------------------------------------------------------------------------------------------------------------------
 
 protected:
 
@@ -165,6 +205,10 @@ protected:
     /// be re-drawn
     //----------------------------------------------------------------------------------------------------------------------
     void paintGL();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief draws the timings of every phase over the scene, a line per phase with its histogram
+    //----------------------------------------------------------------------------------------------------------------------
+    void drawProfile();
 
 private :
 
@@ -194,6 +238,14 @@ private :
             );
 
     //----------------------------------------------------------------------------------------------------------------------
+    /// @brief this method is called everytime a key is pressed while the widget has the focus, F9 writes the
+    /// trace when tracing is compiled in
+    /// @param _event the Qt Event structure
+    //----------------------------------------------------------------------------------------------------------------------
+    void keyPressEvent(
+            QKeyEvent *_event
+            );
+    //----------------------------------------------------------------------------------------------------------------------
     /// @brief this method is called everytime the mouse wheel is moved
     /// inherited from QObject and overridden here.
     /// @param _event the Qt Event structure
@@ -201,7 +253,7 @@ private :
     void wheelEvent(
             QWheelEvent *_event
             );
-    /// @brief timer to change the sphere position by calling update()
+    /// @brief timer to redraw when the simulation thread published a new frame
     //----------------------------------------------------------------------------------------------------------------------
     void timerEvent(
             QTimerEvent *_event
@@ -219,6 +271,16 @@ private :
 
 public slots:
 
+signals:
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief sent when the replay moves on to another frame
+    void replayFrameChanged(int frame);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief sent when the flock could not grow as asked, boids is the size it kept
+    void flockOutOfMemory(int boids);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief sent when a recording was closed after a write to it failed
+    void recordingFailed();
 };
 
 #endif
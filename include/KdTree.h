@@ -0,0 +1,90 @@
+#ifndef KDTREE_H
+#define KDTREE_H
+#include <vector>
+#include "FlockState.h"
+#include "ThreadPool.h"
+#include "ngl/Vector.h"
+
+/*! \brief the kd-tree class */
+/// @file KdTree.h
+/// @brief a kd-tree over the boid positions used to find the k nearest boids of a boid.
+/// @author Dionysios Toufexis
+/// @version 1.0
+/// @date 17/10/2026
+/// @class KdTree
+/// @brief an implicit balanced tree, the boids are reordered so every range [lo, hi) is a node split at its
+/// middle entry on the axis it is widest along, only the axis of each split is stored. The top splits are
+/// made on the calling thread and the subtrees below them are finished over the thread pool. The positions
+/// are copied in tree order so a query walks memory that is close together.
+/// @brief the tree is only read by nearest, any number of threads can query it at once.
+
+class KdTree
+{
+public:
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief our ctor, the tree is empty
+    KdTree();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief builds the tree over the current positions of the flock.
+    /// @param [in] _state the boids of the flock.
+    /// @param [in] _pool the workers the subtrees are split over, the tree does not depend on their number.
+    void build(const FlockState &_state, ThreadPool &_pool);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief finds the _k boids closest to a position, nearest first. Boids at the same distance are ordered
+    /// the same way every time.
+    /// @param [in] _position where to search from.
+    /// @param [in] _k the number of boids wanted, fewer are returned if the flock is smaller.
+    /// @param [in] _exclude a boid left out of the result, the boid searching from its own position, -1 for none.
+    /// @param [out] _neighbours the indices of the boids found.
+    /// @param [out] _distancesSq their squared distances to _position.
+    void nearest(const ngl::Vector &_position, int _k, int _exclude, std::vector <int> &_neighbours,
+                 std::vector <float> &_distancesSq) const;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the number of boids in the tree
+    inline int size() const {return (int)m_index.size();}
+    //----------------------------------------------------------------------------------------------------------------------
+
+private:
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief splits [_lo, _hi) and every range below it down to the leaves
+    void split(int _lo, int _hi, const FlockState &_state);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief splits [_lo, _hi) once, returns the middle entry
+    int splitOnce(int _lo, int _hi, const FlockState &_state);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the state of one nearest search
+    struct Query
+    {
+        float m_position[3];
+        int m_k;
+        int m_exclude;
+        /// @brief the boids kept so far, nearest first, and the squared distance of the furthest once there are k
+        int m_found;
+        float m_worstSq;
+        int *m_neighbours;
+        float *m_distancesSq;
+    };
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief offers entry _entry to the query, it is kept if it is closer than the k found so far
+    inline void consider(int _entry, Query &_query) const;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief searches [_lo, _hi), the near side of every split first.
+    /// @param [in] _boxDistanceSq the squared distance from the query to the box of the range.
+    /// @param [in] _offsets the distance to that box along each axis, restored before returning.
+    void search(int _lo, int _hi, float _boxDistanceSq, float *_offsets, Query &_query) const;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the boid at every entry of the tree
+    std::vector <int> m_index;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the axis the range with its middle at this entry is split on
+    std::vector <unsigned char> m_axis;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the positions of the entries in tree order, one array per axis
+    FloatArray m_coords[3];
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the ranges left by the splits made on the calling thread
+    std::vector <int> m_subtrees;
+    //----------------------------------------------------------------------------------------------------------------------
+};
+
+#endif // KDTREE_H
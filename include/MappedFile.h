@@ -0,0 +1,61 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+/*! \brief the mapped file class */
+/// @file MappedFile.h
+/// @brief a whole file mapped read only into memory.
+/// @author Dionysios Toufexis
+/// @version 1.0
+/// @date 17/10/2026
+/// @class MappedFile
+/// @brief the file is memory mapped where there is mmap and read into memory elsewhere, either way data()
+/// starts on an 8 byte boundary and stays valid until close.
+
+class MappedFile
+{
+public:
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief our ctor, no file is open
+    MappedFile();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief our dtor, unmaps the file
+    ~MappedFile();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief maps a file, a file already open is closed first.
+    /// @param [in] _populate faults every page in up front, for a caller that reads the whole file straight away.
+    /// @returns false if the file is missing, empty or could not be mapped.
+    bool open(const std::string &_file, bool _populate = false);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief unmaps the file
+    void close();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief trades files with _other, so a new file can be opened before the old one is let go
+    void swap(MappedFile &_other);
+    //----------------------------------------------------------------------------------------------------------------------
+    inline bool isOpen() const {return m_data != 0;}
+    inline const char *data() const {return m_data;}
+    inline uint64_t size() const {return m_bytes;}
+    //----------------------------------------------------------------------------------------------------------------------
+
+private:
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief no copies, the mapping is released once
+    MappedFile(const MappedFile &);
+    MappedFile &operator=(const MappedFile &);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the mapped file and its size
+    const char *m_data;
+    uint64_t m_bytes;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the mapping to unmap, 0 when the file was read into m_copy instead
+    void *m_mapping;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the file read into memory where there is no mmap, in 8 byte words to keep it aligned
+    std::vector <uint64_t> m_copy;
+    //----------------------------------------------------------------------------------------------------------------------
+};
+
+#endif // MAPPEDFILE_H
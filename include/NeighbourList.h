@@ -0,0 +1,114 @@
+#ifndef NEIGHBOURLIST_H
+#define NEIGHBOURLIST_H
+#include <vector>
+#include "FlockState.h"
+#include "SpatialGrid.h"
+#include "ThreadPool.h"
+
+/*! \brief the neighbour list class */
+/// @file NeighbourList.h
+/// @brief Verlet neighbour lists, the local boids of every boid cached between updates.
+/// @author Dionysios Toufexis
+/// @version 1.0
+/// @date 17/10/2026
+/// @class NeighbourList
+/// @brief every boid keeps the boids that were within the behaviour radius plus a skin when the lists were
+/// built. The lists stay valid while no boid has moved more than half the skin since, two boids can then
+/// only have closed in by the whole skin and every boid inside the radius is still on the list. update
+/// checks the displacements every step and only rebuilds when a boid went past that.
+/// @brief the lists are stored as compressed sparse rows, the neighbours of boid i are
+/// getIndices()[getOffsets()[i], getOffsets()[i + 1]), so the steering streams through one flat array.
+/// @brief a flock packed tighter than the skin puts every boid on every list, so a build that goes over a
+/// fixed number of pairs stops, the lists stay invalid and the flock steers through its grid instead. The
+/// lists try again after a number of updates.
+
+/// @brief how often the lists were reused
+struct NeighbourListStats
+{
+    NeighbourListStats() : m_updates(0), m_builds(0), m_overflows(0), m_pairs(0) {}
+    /// @brief the number of update calls
+    unsigned long m_updates;
+    /// @brief the number of those that had to rebuild the lists
+    unsigned long m_builds;
+    /// @brief the number of those builds that went over the pair budget and were thrown away
+    unsigned long m_overflows;
+    /// @brief the number of neighbours stored by the last build, over all boids
+    unsigned long m_pairs;
+    /// @brief the share of updates that reused the lists
+    double hitRate() const {return m_updates == 0 ? 0.0 : 1.0 - (double)m_builds / m_updates;}
+};
+
+class NeighbourList
+{
+public:
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief our ctor, the first update builds the lists
+    NeighbourList();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief brings the lists up to date for the current positions, rebuilding them if the number of boids or
+    /// the radius changed or a boid moved more than half the skin since the last build.
+    /// @param [in] _state the boids of the flock.
+    /// @param [in] _radius the largest behaviour radius.
+    /// @param [in] _skin the margin added to the radius, a wider skin rebuilds less often but lists more boids.
+    /// @param [in] _pool the workers the checks and the build are split over.
+    /// @returns true if the lists were rebuilt, isValid says whether they can be used
+    bool update(const FlockState &_state, float _radius, float _skin, ThreadPool &_pool);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief throws the lists away, the next update rebuilds them
+    void invalidate() {m_valid = false;}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief false before the first update and while the flock is too dense for the lists
+    inline bool isValid() const {return m_valid;}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief where the neighbours of every boid start in getIndices, with one more entry for the end
+    inline const std::vector <int> &getOffsets() const {return m_offsets;}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the neighbours of all the boids one after the other, a boid is never on its own list
+    inline const std::vector <int> &getIndices() const {return m_indices;}
+    //----------------------------------------------------------------------------------------------------------------------
+    inline const NeighbourListStats &getStats() const {return m_stats;}
+    void resetStats() {m_stats = NeighbourListStats();}
+    //----------------------------------------------------------------------------------------------------------------------
+
+private:
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief true if any boid moved more than _limit since the last build
+    bool movedTooFar(const FlockState &_state, float _limit, ThreadPool &_pool);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief builds the lists within _reach of every boid and keeps the positions they were built from
+    /// @returns false if the lists went over the pair budget, they are then incomplete
+    bool build(const FlockState &_state, float _reach, ThreadPool &_pool);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the CSR rows and their neighbours
+    std::vector <int> m_offsets;
+    std::vector <int> m_indices;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the positions the lists were built from
+    FloatArray m_refX, m_refY, m_refZ;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the radius and the skin of the last build
+    float m_radius;
+    float m_skin;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief false until the first build and after invalidate
+    bool m_valid;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the updates left before a build is tried again after one went over the budget
+    int m_backoff;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief bins the boids for the build
+    SpatialGrid m_grid;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the neighbours found by each chunk of the build before they are joined, and the grid candidates of
+    /// each worker
+    std::vector <std::vector <int> > m_chunkIndices;
+    std::vector <std::vector <int> > m_candidates;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the largest squared displacement each worker found
+    std::vector <float> m_workerMax;
+    //----------------------------------------------------------------------------------------------------------------------
+    NeighbourListStats m_stats;
+    //----------------------------------------------------------------------------------------------------------------------
+};
+
+#endif // NEIGHBOURLIST_H
@@ -0,0 +1,44 @@
+#ifndef OBSTACLERENDERER_H
+#define OBSTACLERENDERER_H
+#include <string>
+#include <ngl/Camera.h>
+#include <ngl/TransformStack.h>
+#include "obstacle.h"
+
+/*! \brief the obstacle renderer class */
+/// @file ObstacleRenderer.h
+/// @brief draws the sphere obstacle, kept out of Obstacle so the simulation does not need a GL context.
+/// @author Dionysios Toufexis
+/// @version 1.0
+/// @date 17/10/2026
+/// @class ObstacleRenderer
+/// @brief draws an obstacle as an NGL sphere with the Phong shader, on the thread that owns the GL context.
+
+class ObstacleRenderer
+{
+public:
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief drawing the VBO obstacle
+    /// @param [in] _obstacle the obstacle to draw, its position, radius, colour and wireframe are read
+    /// @param [in] _shaderName value
+    /// @param [in] _transformStack  values
+    /// @param [in] _cam camera values
+    static void draw(const Obstacle &_obstacle,
+                     const std::string &_shaderName,
+                     ngl::TransformStack &_transformStack,
+                     ngl::Camera *_cam
+                     );
+    //----------------------------------------------------------------------------------------------------------------------
+
+private:
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief load our matrices to shader
+    /// @param [in] transformationStack valus
+    /// @param [in] camera value
+    static void loadMatricesToShader(ngl::TransformStack &_tx,
+                                     ngl::Camera *_cam
+                                     );
+    //----------------------------------------------------------------------------------------------------------------------
+};
+
+#endif // OBSTACLERENDERER_H
@@ -0,0 +1,156 @@
+#ifndef OBSTACLESET_H
+#define OBSTACLESET_H
+#include <vector>
+#include "ngl/Vector.h"
+
+/*! \brief the obstacle set class */
+/// @file ObstacleSet.h
+/// @brief the sphere obstacles of a scene held in a bounding volume hierarchy.
+/// @author Dionysios Toufexis
+/// @version 1.0
+/// @date 17/10/2026
+/// @class ObstacleSet
+/// @brief the obstacles are stored as arrays and bound by a binary tree of boxes, so a boid only tests the
+/// obstacles whose boxes it overlaps and the cost of a collision check grows with the log of the number of
+/// obstacles. Adding or removing obstacles rebuilds the tree on the next update, moving or resizing them only
+/// refits the boxes above the obstacles that changed. A tree refitted after large movements still gives the
+/// right answers but gets slower, rebuild puts it back in shape.
+
+class ObstacleSet
+{
+public:
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief our ctor
+    /// @param [in] _reach how many radii away from its centre an obstacle is felt, the boxes are made this large.
+    explicit ObstacleSet(float _reach = 1.0f);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief adds a sphere obstacle
+    /// @returns the index of the new obstacle
+    int add(const ngl::Vector &_centre, float _radius);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief removes an obstacle, the last obstacle takes its index.
+    void remove(int _i);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief removes every obstacle
+    void clear();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief moves an obstacle, its boxes are refitted on the next update.
+    void move(int _i, const ngl::Vector &_centre);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief changes the radius of an obstacle, its boxes are refitted on the next update.
+    void setRadius(int _i, float _radius);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief brings the tree up to date, it is rebuilt if obstacles were added or removed and refitted if they
+    /// only moved. It must be called before querying and not while other threads query.
+    void update();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief rebuilds the tree from scratch
+    void rebuild();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief calls _visit(index) for every obstacle whose box overlaps the sphere, the caller does the exact test.
+    /// Queries only read the tree so any number of threads can run them at once.
+    template <typename Visit>
+    void query(const ngl::Vector &_centre, float _radius, Visit _visit) const;
+    //----------------------------------------------------------------------------------------------------------------------
+    inline int size() const {return (int)m_radius.size();}
+    inline ngl::Vector getCentre(int _i) const {return ngl::Vector(m_x[_i], m_y[_i], m_z[_i]);}
+    inline float getRadius(int _i) const {return m_radius[_i];}
+    inline float getReach() const {return m_reach;}
+    //----------------------------------------------------------------------------------------------------------------------
+
+private:
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief a box of the tree. Inner nodes have two children at m_first and m_first + 1, leaves hold m_count
+    /// obstacles starting at m_first in m_order.
+    struct Node
+    {
+        float m_min[3];
+        float m_max[3];
+        int m_first;
+        int m_count;
+        int m_parent;
+    };
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the largest number of obstacles in a leaf
+    static const int s_leafSize = 4;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the deepest tree a query can walk, the median split keeps the depth near log2 of the leaves.
+    static const int s_maxDepth = 64;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief splits the obstacles m_order[_first, _first + _count) into the node _node
+    void build(int _node, int _first, int _count);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief sets the box of a leaf from its obstacles, returns true if it changed
+    bool fitLeaf(Node &_node) const;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief sets the box of an inner node from its children, returns true if it changed
+    bool fitInner(Node &_node) const;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief marks the leaf of an obstacle for the next refit
+    void touch(int _i);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the obstacles
+    std::vector <float> m_x;
+    std::vector <float> m_y;
+    std::vector <float> m_z;
+    std::vector <float> m_radius;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the nodes of the tree, the root is the first node
+    std::vector <Node> m_nodes;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the obstacle indices in leaf order
+    std::vector <int> m_order;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the leaf holding each obstacle
+    std::vector <int> m_leafOf;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the leaves changed since the last update, m_dirty flags them so each is listed once
+    std::vector <int> m_dirtyLeaves;
+    std::vector <char> m_dirty;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief set when obstacles were added or removed
+    bool m_needsBuild;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief how many radii away from its centre an obstacle is felt
+    float m_reach;
+    //----------------------------------------------------------------------------------------------------------------------
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+template <typename Visit>
+void ObstacleSet::query(const ngl::Vector &_centre, float _radius, Visit _visit) const
+{
+    if(m_nodes.empty())
+    {
+        return;
+    }
+    const float lo[3] = {_centre.m_x - _radius, _centre.m_y - _radius, _centre.m_z - _radius};
+    const float hi[3] = {_centre.m_x + _radius, _centre.m_y + _radius, _centre.m_z + _radius};
+    int stack[s_maxDepth];
+    int top = 0;
+    stack[top++] = 0;
+    while(top > 0)
+    {
+        const Node &node = m_nodes[stack[--top]];
+        if(node.m_max[0] < lo[0] || node.m_min[0] > hi[0] ||
+           node.m_max[1] < lo[1] || node.m_min[1] > hi[1] ||
+           node.m_max[2] < lo[2] || node.m_min[2] > hi[2])
+        {
+            continue;
+        }
+        if(node.m_count > 0)
+        {
+            for(int i=node.m_first; i<node.m_first + node.m_count; ++i)
+            {
+                _visit(m_order[i]);
+            }
+        }
+        else
+        {
+            stack[top++] = node.m_first + 1;
+            stack[top++] = node.m_first;
+        }
+    }
+}
+
+#endif // OBSTACLESET_H
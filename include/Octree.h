@@ -0,0 +1,206 @@
+#ifndef OCTREE_H
+#define OCTREE_H
+#include <stdint.h>
+#include <vector>
+#include "FlockState.h"
+#include "ThreadPool.h"
+#include "ngl/Vector.h"
+
+/*! \brief the octree class */
+/// @file Octree.h
+/// @brief an octree over the boids whose nodes carry the summed positions and velocities of the boids below
+/// them, so cohesion and alignment over a large radius can take whole groups of boids at once.
+/// @author Dionysios Toufexis
+/// @version 1.0
+/// @date 17/10/2026
+/// @class Octree
+/// @brief the boids are sorted along a Morton curve and every node is a run of that order, split on the next
+/// three bits of the code. A query walks the tree from a boid in the manner of Barnes and Hut: a node
+/// entirely inside the radius adds its sums as they are, a node that is far enough away for the opening
+/// angle adds its sums if its centre of mass is inside the radius, and every other node is opened. Nodes that
+/// may hold a boid within the separation distance are always opened, so separation stays exact.
+/// @brief the tree is only read by query, any number of threads can walk it at once.
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the boids a query took from the nodes without opening them
+struct OctreeSums
+{
+    float m_positionX, m_positionY, m_positionZ;
+    float m_velocityX, m_velocityY, m_velocityZ;
+    int m_count;
+};
+
+class Octree
+{
+public:
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief our ctor, the tree is empty
+    Octree();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief builds the tree over the current positions and velocities of the flock.
+    /// @param [in] _state the boids of the flock.
+    /// @param [in] _pool the workers the bounds, the codes and the copies are split over.
+    void build(const FlockState &_state, ThreadPool &_pool);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief walks the tree from a position, the nodes taken as a whole are added to _sums and _visit(begin, end)
+    /// is called for the leaves that had to be opened, the caller tests their boids getBoid(begin) to
+    /// getBoid(end - 1) exactly.
+    /// @param [in] _position where the boid is, a boid exactly there is never taken into _sums.
+    /// @param [in] _reach the behaviour distance.
+    /// @param [in] _near the separation distance, nodes closer than this are opened.
+    /// @param [in] _theta the opening angle, a node is taken as a whole if its size over its distance is below
+    /// it. 0 only takes the nodes that lie entirely inside the reach, which is exact up to float rounding.
+    /// @param [out] _sums the sums of the nodes taken as a whole.
+    template <typename Visit>
+    void query(const ngl::Vector &_position, float _reach, float _near, float _theta, OctreeSums &_sums, Visit _visit) const;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the number of nodes of the tree
+    inline int getNodeCount() const {return (int)m_nodes.size();}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the boid at an entry of the Morton order, and its position and velocity copied in that order so
+    /// the boids of a leaf can be read one after the other
+    inline int getBoid(int _entry) const {return m_order[_entry];}
+    inline const FloatArray &getPosX() const {return m_posX;}
+    inline const FloatArray &getPosY() const {return m_posY;}
+    inline const FloatArray &getPosZ() const {return m_posZ;}
+    inline const FloatArray &getVelX() const {return m_velX;}
+    inline const FloatArray &getVelY() const {return m_velY;}
+    inline const FloatArray &getVelZ() const {return m_velZ;}
+    //----------------------------------------------------------------------------------------------------------------------
+
+private:
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief a node of the tree. Inner nodes have m_children children starting at m_first, leaves hold the
+    /// boids m_order[m_begin, m_end).
+    struct Node
+    {
+        float m_min[3];
+        float m_max[3];
+        /// @brief the summed positions and velocities of the boids below the node
+        float m_position[3];
+        float m_velocity[3];
+        int m_begin;
+        int m_end;
+        int m_first;
+        int m_children;
+    };
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the largest number of boids a node holds before it is split
+    static const int s_leafSize = 16;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the bits of the Morton code per axis, the tree is never deeper than this
+    static const int s_levels = 10;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the most nodes a query can have waiting, seven siblings per level and the root
+    static const int s_maxStack = 8 * s_levels + 8;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief fills the node _node from the boids [_begin, _end) of the sorted order, whose codes agree above _level
+    void buildNode(int _node, int _begin, int _end, int _level);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the nodes of the tree, the root is the first node
+    std::vector <Node> m_nodes;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the Morton code of every boid above its index, sorted
+    std::vector <uint64_t> m_keys;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the boids in Morton order
+    std::vector <int> m_order;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the positions and velocities in Morton order
+    FloatArray m_posX, m_posY, m_posZ;
+    FloatArray m_velX, m_velY, m_velZ;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the bounds each worker found
+    std::vector <float> m_workerBounds;
+    //----------------------------------------------------------------------------------------------------------------------
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+template <typename Visit>
+void Octree::query(const ngl::Vector &_position, float _reach, float _near, float _theta, OctreeSums &_sums, Visit _visit) const
+{
+    _sums.m_positionX = _sums.m_positionY = _sums.m_positionZ = 0.0f;
+    _sums.m_velocityX = _sums.m_velocityY = _sums.m_velocityZ = 0.0f;
+    _sums.m_count = 0;
+    if(m_nodes.empty())
+    {
+        return;
+    }
+    const float p[3] = {_position.m_x, _position.m_y, _position.m_z};
+    const float reachSq = _reach * _reach;
+    const float nearSq = _near * _near;
+    const float thetaSq = _theta * _theta;
+    int stack[s_maxStack];
+    int top = 0;
+    stack[top++] = 0;
+    while(top > 0)
+    {
+        const Node &node = m_nodes[stack[--top]];
+        float nearestSq = 0.0f;
+        float furthestSq = 0.0f;
+        float size = 0.0f;
+        for(int a=0; a<3; ++a)
+        {
+            float below = node.m_min[a] - p[a];
+            float above = p[a] - node.m_max[a];
+            float outside = below > 0.0f ? below : (above > 0.0f ? above : 0.0f);
+            float far = -below > -above ? -below : -above;
+            nearestSq += outside * outside;
+            furthestSq += far * far;
+            size = node.m_max[a] - node.m_min[a] > size ? node.m_max[a] - node.m_min[a] : size;
+        }
+        // no boid of the node is within the reach
+        if(nearestSq >= reachSq)
+        {
+            continue;
+        }
+        int count = node.m_end - node.m_begin;
+        bool whole = false;
+        if(nearestSq >= nearSq && nearestSq > 0.0f)
+        {
+            if(furthestSq < reachSq)
+            {
+                // every boid of the node is within the reach and none is within the separation distance
+                whole = true;
+            }
+            else
+            {
+                float cx = node.m_position[0] / count - p[0];
+                float cy = node.m_position[1] / count - p[1];
+                float cz = node.m_position[2] / count - p[2];
+                float centreSq = cx * cx + cy * cy + cz * cz;
+                if(size * size < thetaSq * centreSq)
+                {
+                    if(centreSq >= reachSq)
+                    {
+                        continue;
+                    }
+                    whole = true;
+                }
+            }
+        }
+        if(whole)
+        {
+            _sums.m_positionX += node.m_position[0];
+            _sums.m_positionY += node.m_position[1];
+            _sums.m_positionZ += node.m_position[2];
+            _sums.m_velocityX += node.m_velocity[0];
+            _sums.m_velocityY += node.m_velocity[1];
+            _sums.m_velocityZ += node.m_velocity[2];
+            _sums.m_count += count;
+        }
+        else if(node.m_children == 0)
+        {
+            _visit(node.m_begin, node.m_end);
+        }
+        else
+        {
+            for(int c=node.m_children - 1; c>=0; --c)
+            {
+                stack[top++] = node.m_first + c;
+            }
+        }
+    }
+}
+
+#endif // OCTREE_H
@@ -0,0 +1,156 @@
+#ifndef PERFCOUNTERS_H
+#define PERFCOUNTERS_H
+#include <stdint.h>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/*! \brief the hardware counter class */
+/// @file PerfCounters.h
+/// @brief counts the cycles, instructions, last level cache misses and branch misses of the phases of
+/// Flock::update through the Linux perf_event_open interface, so a change in the step time can be traced back to
+/// the cache, the branches or the instructions per cycle.
+/// @author Dionysios Toufexis
+/// @version 1.0
+/// @date 17/10/2026
+/// @class PerfCounters
+/// @brief the call sites open a FLOCK_PERF_SCOPE, which is compiled out unless FLOCK_PERF is defined (qmake
+/// CONFIG+=perf). Every thread that runs a part of the update opens its own group of counters, the thread of a
+/// scope on its first scope and the pool workers through FLOCK_PERF_THREAD when they start. A scope reads the
+/// groups of every thread when it opens and closes and adds the difference to its phase, so the work the
+/// workers did for the phase is counted with it. Reading a group is a system call per thread, the phases are
+/// whole passes over the flock and never single boids.
+/// @brief the counters only count user space so they open with the default perf_event_paranoid of 2. Where
+/// they can not be opened, in a container without the permission, a VM without a PMU or on another OS, the
+/// phases stay empty and getError says why. A counter the CPU does not have is left out on its own, and the
+/// counts are scaled up when the kernel had to share the hardware between groups.
+
+class PerfCounters
+{
+public:
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the phases counted. UPDATE is the whole Flock::update and holds COLLISIONS, NEIGHBOURS and STEER,
+    /// STEER runs the behaviour rules and the integration in one pass so the two are counted together.
+    enum Phase {UPDATE, COLLISIONS, NEIGHBOURS, STEER, PHASES};
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the hardware events of a group, CYCLES leads it
+    enum Counter {CYCLES, INSTRUCTIONS, LLC_MISSES, BRANCH_MISSES, COUNTERS};
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief what a phase counted since the last reset, m_valid is false for a counter some thread could not open
+    struct Stats
+    {
+        uint64_t m_samples;
+        double m_totals[COUNTERS];
+        bool m_valid[COUNTERS];
+        /// @brief the mean of a counter per sample, 0 without samples
+        inline double mean(Counter _counter) const { return m_samples > 0 ? m_totals[_counter] / m_samples : 0.0; }
+        /// @brief instructions per cycle, 0 if either was not counted
+        inline double ipc() const
+        {
+            return m_valid[CYCLES] && m_valid[INSTRUCTIONS] && m_totals[CYCLES] > 0.0 ? m_totals[INSTRUCTIONS] / m_totals[CYCLES] : 0.0;
+        }
+    };
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the counters every scope reads
+    static PerfCounters &instance();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief true if the scopes were compiled in
+    static bool isEnabled();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the names of a phase and a counter as written to the JSON
+    static const char *name(Phase _phase);
+    static const char *name(Counter _counter);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief opens the group of the calling thread if it has none yet, it is closed when the thread ends.
+    /// @returns false if the counters could not be opened, getError says why.
+    bool addThread();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief true if the calling thread counts, opening its group if needed
+    inline bool isAvailable() { return addThread(); }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief why the counters could not be opened, empty if they were
+    std::string getError() const;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the counts of every thread added up since their groups were opened
+    void read(double _values[COUNTERS]);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief adds the difference of two reads to a phase
+    void add(Phase _phase, const double _start[COUNTERS], const double _end[COUNTERS]);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief what a phase counted since the last reset
+    Stats getStats(Phase _phase) const;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief empties every phase
+    void reset();
+    //----------------------------------------------------------------------------------------------------------------------
+
+private:
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief our ctor, only instance makes one
+    PerfCounters();
+    PerfCounters(const PerfCounters &);
+    PerfCounters &operator=(const PerfCounters &);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the counters of one thread, m_counter holds the counter of each value in the order the group reads
+    /// them, m_open the counters it has
+    struct Group
+    {
+        int m_leader;
+        std::vector <int> m_fds;
+        std::vector <int> m_counter;
+        bool m_open[COUNTERS];
+    };
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief opens the counters of the calling thread, 0 if cycles could not be opened
+    Group *openGroup();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief closes a group and takes it off the list, called when its thread ends
+    void removeGroup(Group *_group);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief adds the scaled counts of a group to _values
+    static void readGroup(const Group &_group, double _values[COUNTERS]);
+    //----------------------------------------------------------------------------------------------------------------------
+    friend class PerfThread;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief guards the groups, the error and the phases
+    mutable std::mutex m_mutex;
+    std::vector <Group *> m_groups;
+    std::string m_error;
+    uint64_t m_samples[PHASES];
+    double m_totals[PHASES][COUNTERS];
+    //----------------------------------------------------------------------------------------------------------------------
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief counts the rest of the block it is declared in as a phase
+class PerfScope
+{
+public:
+    inline explicit PerfScope(PerfCounters::Phase _phase) : m_phase(_phase)
+    {
+        PerfCounters::instance().read(m_start);
+    }
+    inline ~PerfScope()
+    {
+        double end[PerfCounters::COUNTERS];
+        PerfCounters &counters = PerfCounters::instance();
+        counters.read(end);
+        counters.add(m_phase, m_start, end);
+    }
+
+private:
+    PerfCounters::Phase m_phase;
+    double m_start[PerfCounters::COUNTERS];
+};
+
+#define FLOCK_PERF_CONCAT2(_a, _b) _a##_b
+#define FLOCK_PERF_CONCAT(_a, _b) FLOCK_PERF_CONCAT2(_a, _b)
+#ifdef FLOCK_PERF
+    #define FLOCK_PERF_SCOPE(_phase) PerfScope FLOCK_PERF_CONCAT(perfScope, __LINE__)(PerfCounters::_phase)
+    #define FLOCK_PERF_THREAD() PerfCounters::instance().addThread()
+#else
+    #define FLOCK_PERF_SCOPE(_phase)
+    #define FLOCK_PERF_THREAD()
+#endif
+
+#endif // PERFCOUNTERS_H
@@ -0,0 +1,128 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+#include <stdint.h>
+#include <chrono>
+#include <mutex>
+#include <string>
+
+/*! \brief the profiler class */
+/// @file Profiler.h
+/// @brief keeps rolling timings of the phases of a frame, from the steps of the simulation thread to the draw
+/// calls of the GUI thread.
+/// @author Dionysios Toufexis
+/// @version 1.0
+/// @date 17/10/2026
+/// @class Profiler
+/// @brief the call sites of the phases open a FLOCK_PROFILE_SCOPE, which is compiled out unless FLOCK_PROFILE
+/// is defined (qmake CONFIG+=profile), so a normal build does not even read the clock. A scope reads the
+/// steady clock on entry and exit and hands the time to the profiler, which takes a lock, so only whole
+/// phases are timed, never single boids. Each phase keeps its last s_window times and a histogram of them in
+/// power of two buckets of microseconds, old times leave the histogram as they leave the window.
+/// @brief the draw phases time the CPU side of the draw, the GPU finishes the work on its own.
+
+class Profiler
+{
+public:
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the phases timed. UPDATE is the whole Flock::update and holds COLLISIONS, NEIGHBOURS and STEER,
+    /// STEER runs the behaviour rules and moves the boids in one pass so the two are timed together. PUBLISH
+    /// is the copy of a step for the GUI.
+    enum Phase {UPDATE, COLLISIONS, NEIGHBOURS, STEER, PUBLISH, FLOCK_DRAW, OBSTACLE_DRAW, PHASES};
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the times kept per phase
+    static const int s_window = 240;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the buckets of the histograms, bucket b holds the times from 2^b to 2^(b+1) microseconds, the
+    /// first everything below 2 microseconds and the last everything above 2^23
+    static const int s_buckets = 24;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief what the window of a phase holds, all the times in ms
+    struct Stats
+    {
+        int m_samples;
+        /// @brief the times added since the last reset, not only those in the window
+        uint64_t m_total;
+        double m_lastMs;
+        double m_meanMs;
+        double m_minMs;
+        double m_maxMs;
+        double m_p50Ms;
+        double m_p99Ms;
+        int m_histogram[s_buckets];
+    };
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the profiler every scope reports to
+    static Profiler &instance();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief true if the scopes were compiled in
+    static bool isEnabled();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the name of a phase as written to the JSON and the overlay
+    static const char *name(Phase _phase);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief adds a time to a phase, from any thread
+    void add(Phase _phase, double _ms);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the statistics of the window of a phase
+    Stats getStats(Phase _phase) const;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief empties every window
+    void reset();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief writes the statistics and histograms of every phase as JSON, _file - for stdout.
+    /// @returns false if the file could not be written.
+    bool writeJson(const std::string &_file) const;
+    //----------------------------------------------------------------------------------------------------------------------
+
+private:
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief our ctor, only instance makes one
+    Profiler();
+    Profiler(const Profiler &);
+    Profiler &operator=(const Profiler &);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the bucket a time goes into
+    static int bucket(double _ms);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the last times of a phase as a ring, m_next is the slot the next time goes into
+    struct Window
+    {
+        double m_times[s_window];
+        int m_next;
+        int m_count;
+        uint64_t m_total;
+        int m_histogram[s_buckets];
+    };
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief guards the windows, the phases are added from the simulation and the GUI thread
+    mutable std::mutex m_mutex;
+    Window m_windows[PHASES];
+    //----------------------------------------------------------------------------------------------------------------------
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief times the rest of the block it is declared in as a phase
+class ProfileScope
+{
+public:
+    inline explicit ProfileScope(Profiler::Phase _phase) : m_phase(_phase), m_start(std::chrono::steady_clock::now()) {}
+    inline ~ProfileScope()
+    {
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - m_start;
+        Profiler::instance().add(m_phase, elapsed.count());
+    }
+
+private:
+    Profiler::Phase m_phase;
+    std::chrono::steady_clock::time_point m_start;
+};
+
+#define FLOCK_PROFILE_CONCAT2(_a, _b) _a##_b
+#define FLOCK_PROFILE_CONCAT(_a, _b) FLOCK_PROFILE_CONCAT2(_a, _b)
+#ifdef FLOCK_PROFILE
+    #define FLOCK_PROFILE_SCOPE(_phase) ProfileScope FLOCK_PROFILE_CONCAT(profileScope, __LINE__)(Profiler::_phase)
+#else
+    #define FLOCK_PROFILE_SCOPE(_phase)
+#endif
+
+#endif // PROFILER_H
@@ -0,0 +1,41 @@
+#ifndef RANSCODER_H
+#define RANSCODER_H
+#include <stdint.h>
+#include <vector>
+
+/*! \brief the rANS block coder */
+/// @file RansCoder.h
+/// @brief entropy codes blocks of 16 bit values that are mostly small, the residuals of TrajectoryEncoder.
+/// @author Dionysios Toufexis
+/// @version 1.0
+/// @date 17/10/2026
+/// @class RansCoder
+/// @brief every value is split into its bit length, 0 to 16, and the bits below its leading one. The lengths
+/// go through a range asymmetric numeral system coder with a table of their frequencies stored at the start
+/// of the block, the low bits are stored as they are. Small values therefore cost a few bits and a rare large
+/// one never costs more than about 21. Every block is coded on its own, so blocks can be coded and decoded on
+/// any number of threads at once and the result is the same byte for byte.
+///
+///     uint16 frequency of each length (s_symbols of them, summing to 1 << s_scaleBits)
+///     uint32 bytes of the rANS stream, the rANS stream, the low bits
+
+namespace RansCoder
+{
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the number of bit lengths a 16 bit value can have
+    const int s_symbols = 17;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the frequencies of a block add up to 1 << s_scaleBits
+    const int s_scaleBits = 12;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief codes _count values and appends them to _out.
+    void encode(const uint16_t *_values, int _count, std::vector <uint8_t> &_out);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief decodes a block written by encode.
+    /// @param [in] _data,_bytes the block.
+    /// @param [out] _values the _count values of the block.
+    /// @returns false if the block is damaged, _values is then undefined.
+    bool decode(const uint8_t *_data, uint64_t _bytes, uint16_t *_values, int _count);
+}
+
+#endif // RANSCODER_H
@@ -0,0 +1,134 @@
+#ifndef SIMULATIONTHREAD_H
+#define SIMULATIONTHREAD_H
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "flock.h"
+#include "FlockState.h"
+#include "TrajectoryRecorder.h"
+#include "TripleBuffer.h"
+
+/*! \brief the simulation thread class */
+/// @file SimulationThread.h
+/// @brief runs the flock on its own thread at a fixed time step, away from the GUI thread.
+/// @author Dionysios Toufexis
+/// @version 1.0
+/// @date 17/10/2026
+/// @class SimulationThread
+/// @brief the thread owns the flock while it runs. Every finished step is copied into a frame and published
+/// through a TripleBuffer, so the drawing picks up the newest frame without waiting and a slow step never
+/// holds up the GUI. The GUI changes the flock by posting commands which the thread runs between two steps.
+/// When a step takes longer than the time step the thread runs the steps back to back, it does not try to
+/// catch up on the missed ones. While a recording runs every step is also handed to a TrajectoryRecorder,
+/// whose own thread writes it out.
+
+class SimulationThread
+{
+public:
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief a change to the flock, run on the simulation thread between two steps
+    typedef std::function<void (Flock &_flock)> Command;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief our ctor
+    /// @param [in] _flock the flock to run, it must only be changed through post while the thread runs.
+    /// @param [in] _stepSeconds the time step of the simulation.
+    SimulationThread(Flock *_flock, double _stepSeconds = 1.0 / 60.0);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief our dtor, stops the thread
+    ~SimulationThread();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief starts the thread, the first frame is published before the first step.
+    void start();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief stops the thread once the current step is done
+    void stop();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief queues a command for the simulation thread, commands run in the order they were posted.
+    void post(const Command &_command);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief stops or restarts the stepping, commands still run and publish a new frame while paused.
+    void setPaused(bool _paused) {m_paused = _paused;}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief starts recording every step into a trajectory file, a recording already running is closed first.
+    /// @param [in] _file the file to write, opened on the simulation thread before the next step.
+    void startRecording(const std::string &_file);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief closes the recording once the frames already recorded are written
+    void stopRecording();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief true from startRecording until stopRecording or a file that could not be created
+    bool isRecording() const {return m_recording;}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief whether a recording closed since the last call could not be written in full
+    bool takeRecordingFailed() {return m_recordingFailed.exchange(false);}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief whether a command ran out of memory since the last call, the command is dropped and the flock
+    /// keeps running with the boids it has.
+    /// @param [out] _boids the size of the flock after the failed commands.
+    bool takeOutOfMemory(int &_boids);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief picks up the newest finished frame, only the GUI thread may call it.
+    /// @returns true when a new frame arrived since the last call.
+    bool newFrame() {return m_frames.update();}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the frame picked up by the last newFrame, only the position, size, scale, colour and wireframe
+    /// arrays are filled.
+    const FlockState &frame() const {return m_frames.front();}
+    //----------------------------------------------------------------------------------------------------------------------
+
+private:
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the loop of the simulation thread
+    void run();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief runs the queued commands, returns true if there were any
+    bool runCommands();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief copies the flock into the back frame and publishes it
+    void publishFrame();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief closes the recorder and flags a recording that could not be written in full
+    void closeRecording();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the flock being simulated
+    Flock *m_flock;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the time step in seconds
+    double m_stepSeconds;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the simulation thread
+    std::thread m_thread;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief set to end the loop
+    std::atomic <bool> m_quit;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief set to stop stepping
+    std::atomic <bool> m_paused;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief guards m_commands, it is only held to add or take the commands and never during a step.
+    std::mutex m_commandMutex;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the commands posted since the last step
+    std::vector <Command> m_commands;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the frames handed to the GUI
+    TripleBuffer <FlockState> m_frames;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief writes the steps to disk while recording, only used on the simulation thread
+    TrajectoryRecorder m_recorder;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief whether a recording is open, read by the GUI
+    std::atomic <bool> m_recording;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief set when a recording closes after a failed write, read by the GUI
+    std::atomic <bool> m_recordingFailed;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the size of the flock after a command ran out of memory, -1 once the GUI took it
+    std::atomic <int> m_outOfMemory;
+    //----------------------------------------------------------------------------------------------------------------------
+};
+
+#endif // SIMULATIONTHREAD_H
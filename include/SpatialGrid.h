@@ -0,0 +1,74 @@
+#ifndef SPATIALGRID_H
+#define SPATIALGRID_H
+#include <vector>
+#include "FlockState.h"
+#include "ngl/Vector.h"
+
+/*! \brief the spatial grid class */
+/// @file SpatialGrid.h
+/// @brief a uniform grid of hashed cells used to find the local boids without scanning the whole flock.
+/// @brief cells are hashed into a fixed size table so space outside of the bounding box is covered too.
+/// @author Dionysios Toufexis
+/// @version 1.0
+/// @date 17/10/2026
+/// @class SpatialGrid
+/// @brief bins the boids into cells sized from the behaviour distance. It is rebuilt once per Flock::update
+/// and the behaviours only visit the 27 cells around the current boid.
+
+
+class SpatialGrid
+{
+public:
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief our ctor
+    SpatialGrid();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief bins all the boids into the grid using a counting sort.
+    /// @param [in] _state the boids of the flock.
+    /// @param [in] _cellSize the edge length of a cell, it must be at least the largest behaviour radius.
+    void rebuild(const FlockState &_state, float _cellSize);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief bins a set of points given as separate coordinate arrays.
+    /// @param [in] _x,_y,_z the coordinates of the points.
+    /// @param [in] _count the number of points.
+    /// @param [in] _cellSize the edge length of a cell, it must be at least the largest behaviour radius.
+    void rebuild(const float *_x, const float *_y, const float *_z, int _count, float _cellSize);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief collects the index of every boid in the 27 cells around a position.
+    /// @param [in] _position the position to search around.
+    /// @param [out] _neighbours the candidate boids, it is cleared first. The caller still has to do the distance test.
+    void gatherNeighbours(const ngl::Vector &_position, std::vector <int> &_neighbours) const;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief returns the cell size used by the last rebuild.
+    inline float getCellSize() const {return m_cellSize;}
+    //----------------------------------------------------------------------------------------------------------------------
+
+private:
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief converts a world coordinate to a cell coordinate.
+    inline int cellCoord(float _value) const;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief hashes a cell coordinate into the table.
+    inline unsigned int hashCell(int _x, int _y, int _z) const;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the edge length of a cell.
+    float m_cellSize;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief one over the cell size, to avoid a divide per boid.
+    float m_invCellSize;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the hash table size minus one, the table size is always a power of two.
+    unsigned int m_tableMask;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the first sorted boid of every hash bucket, with one extra entry for the end of the last bucket.
+    std::vector <int> m_cellStart;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the boid indices sorted by hash bucket.
+    std::vector <int> m_sortedBoids;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the hash bucket of every boid, kept between rebuilds to avoid reallocating.
+    std::vector <unsigned int> m_boidBucket;
+    //----------------------------------------------------------------------------------------------------------------------
+};
+
+#endif // SPATIALGRID_H
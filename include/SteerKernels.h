@@ -0,0 +1,97 @@
+#ifndef STEERKERNELS_H
+#define STEERKERNELS_H
+
+/*! \brief the steering kernels */
+/// @file SteerKernels.h
+/// @brief hand vectorized kernels for the neighbour accumulation of the behaviours.
+/// @author Dionysios Toufexis
+/// @version 1.0
+/// @date 17/10/2026
+/// @class SteerKernels
+/// @brief the kernels take the candidate neighbours of one boid packed into contiguous arrays, do the radius
+/// tests on the squared distances and add up the cohesion, alignment and seperation sums 4 (SSE), 8 (AVX2) or
+/// 16 (AVX-512) candidates at a time. The widest kernel the CPU and OS support is picked once at startup from
+/// CPUID, so the same binary runs on every machine. Setting the FLOCK_SIMD environment variable to scalar,
+/// sse, avx2 or avx512 forces a narrower path.
+/// @brief every kernel is instantiated once for each set of rules. A rule that is switched off has its sums
+/// taken out of the loop at compile time, so a flock without alignment never loads a neighbour velocity and
+/// one with only separation does not count its neighbours. The sums of the rules left out are 0.
+/// @brief the SIMD kernels add the candidates in a different order to the scalar one, the sums agree with the
+/// scalar kernel to within float rounding (about 1e-6 relative for the flock sizes we run).
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the sums one boid collects from its neighbours
+struct NeighbourSums
+{
+    float m_cohesionX, m_cohesionY, m_cohesionZ;
+    float m_alignmentX, m_alignmentY, m_alignmentZ;
+    float m_separationX, m_separationY, m_separationZ;
+    /// @brief the number of neighbours within the behaviour distance
+    int m_count;
+};
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the candidates of one boid, packed so the kernels can stream through them. The arrays are padded
+/// with far away candidates up to a multiple of SteerKernels::s_padding so the kernels need no tail loop.
+struct NeighbourBatch
+{
+    const float *m_x, *m_y, *m_z;
+    const float *m_vx, *m_vy, *m_vz;
+    /// @brief the number of candidates including the padding
+    int m_count;
+};
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the signature shared by all the kernels
+/// @param [in] _batch the packed candidates, the current boid must not be in it.
+/// @param [in] _px,_py,_pz the position of the current boid.
+/// @param [in] _behaviourDistanceSq the squared radius of the cohesion and alignment.
+/// @param [in] _flockDistanceSq the squared radius of the seperation.
+/// @param [out] _sums the neighbour sums.
+typedef void (*AccumulateKernel)(const NeighbourBatch &_batch,
+                                 float _px, float _py, float _pz,
+                                 float _behaviourDistanceSq, float _flockDistanceSq,
+                                 NeighbourSums &_sums);
+
+class SteerKernels
+{
+public:
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the instruction sets we have kernels for
+    enum ISA {SCALAR = 0, SSE = 1, AVX2 = 2, AVX512 = 3};
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the rules a kernel adds up the sums of, combined as flags
+    enum Rule {COHESION = 1, ALIGNMENT = 2, SEPARATION = 4, ALL_RULES = 7};
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the number of sets of rules, every kernel has one instantiation for each
+    static const int s_ruleSets = ALL_RULES + 1;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the batches are padded to a multiple of the widest kernel
+    static const int s_padding = 16;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the coordinate used for the padding, its squared distance to any boid fails every radius test
+    static const float s_farAway;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the widest instruction set the CPU and the OS support
+    static ISA detect();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the instruction set picked at startup, FLOCK_SIMD can lower it.
+    static ISA active();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the kernel picked at startup, with every rule
+    static AccumulateKernel accumulate();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the kernel picked at startup that only adds up the sums of _rules
+    static AccumulateKernel accumulate(int _rules);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the kernel for an instruction set, or 0 when it is not supported by this machine.
+    static AccumulateKernel kernel(ISA _isa);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the kernel for an instruction set that only adds up the sums of _rules, or 0 when the instruction
+    /// set is not supported by this machine.
+    static AccumulateKernel kernel(ISA _isa, int _rules);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief a printable name for an instruction set
+    static const char *name(ISA _isa);
+    //----------------------------------------------------------------------------------------------------------------------
+};
+
+#endif // STEERKERNELS_H
@@ -0,0 +1,91 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*! \brief the thread pool class */
+/// @file ThreadPool.h
+/// @brief a fixed set of worker threads that split a range of boids between them.
+/// @author Dionysios Toufexis
+/// @version 1.0
+/// @date 17/10/2026
+/// @class ThreadPool
+/// @brief the workers are created once and sleep on a condition variable between updates, so a parallel pass
+/// costs a wake up and not a thread creation. The calling thread works as worker 0, a pool of one worker
+/// runs everything on the caller. The range is handed out in chunks of _grain from an atomic counter so a
+/// worker that is slowed down by the OS does not hold the others back. Which worker gets which chunk changes
+/// from run to run, the tasks must only write to the entries of their own chunk.
+
+class ThreadPool
+{
+public:
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the task run on every chunk, it gets the chunk [_begin, _end) and the worker running it.
+    typedef std::function<void (int _begin, int _end, int _worker)> Task;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief our ctor
+    /// @param [in] _workers the number of workers including the calling thread, 0 uses one per hardware thread.
+    explicit ThreadPool(int _workers = 0);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief our dtor, joins the workers
+    ~ThreadPool();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the number of workers including the calling thread
+    inline int size() const {return (int)m_threads.size() + 1;}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief runs _task over [0, _count) on all the workers and returns once every chunk is done.
+    /// @param [in] _count the size of the range.
+    /// @param [in] _grain the number of entries handed to a worker at a time.
+    /// @param [in] _task the task to run on every chunk.
+    void parallelFor(int _count, int _grain, const Task &_task);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the number of hardware threads, at least 1
+    static int hardwareThreads();
+    //----------------------------------------------------------------------------------------------------------------------
+
+private:
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the loop of every worker thread
+    void workerLoop(int _worker);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief takes chunks off the counter until the range is used up
+    void runChunks(int _worker);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the worker threads, the calling thread is not in here
+    std::vector <std::thread> m_threads;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief guards the job description and the counters below
+    std::mutex m_mutex;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief wakes the workers when a new job is posted
+    std::condition_variable m_wake;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief wakes the caller when the last worker is done
+    std::condition_variable m_finished;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the task of the current job
+    const Task *m_task;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the size and the chunk size of the current job
+    int m_count;
+    int m_grain;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the start of the next chunk to hand out
+    std::atomic <int> m_next;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the number of worker threads still running the current job
+    int m_busy;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief bumped for every job so a worker never runs the same job twice
+    unsigned int m_job;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief set by the dtor to stop the workers
+    bool m_quit;
+    //----------------------------------------------------------------------------------------------------------------------
+};
+
+#endif // THREADPOOL_H
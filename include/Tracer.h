@@ -0,0 +1,131 @@
+#ifndef TRACER_H
+#define TRACER_H
+#include <stdint.h>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/*! \brief the tracer class */
+/// @file Tracer.h
+/// @brief records when every traced scope of every thread ran and writes it out as a Chrome trace, which
+/// chrome://tracing and the Perfetto UI open as a timeline per thread.
+/// @author Dionysios Toufexis
+/// @version 1.0
+/// @date 17/10/2026
+/// @class Tracer
+/// @brief the call sites open a FLOCK_TRACE_SCOPE, which is compiled out unless FLOCK_TRACE is defined (qmake
+/// CONFIG+=trace). A scope reads the steady clock when it opens and closes and writes one complete event,
+/// its begin and its duration, into a ring buffer owned by its thread. The thread is the only writer of its
+/// ring and publishes an event by bumping an atomic counter, so recording never takes a lock and never waits
+/// on another thread. A ring keeps the last s_capacity events of its thread, older events are overwritten.
+/// @brief writeJson can run at any time from any thread, it copies what every ring holds and leaves out the
+/// events the owners overwrote while it was copying. The rings of threads that ended are kept so their events
+/// are still written.
+
+class Tracer
+{
+public:
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the events kept per thread, a power of two
+    static const int s_capacity = 1 << 16;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the tracer every scope records to
+    static Tracer &instance();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief true if the scopes were compiled in
+    static bool isEnabled();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the ns since the tracer was made
+    inline uint64_t now() const
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_epoch).count();
+    }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief adds an event to the ring of the calling thread.
+    /// @param [in] _name the name of the event, it has to outlive the tracer, a string literal.
+    /// @param [in] _start,_end when the event began and ended, from now.
+    /// @param [in] _first,_last the range of a chunk, -1 for events that are not chunks.
+    void record(const char *_name, uint64_t _start, uint64_t _end, int _first = -1, int _last = -1);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief names the calling thread in the trace
+    void setThreadName(const std::string &_name);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief writes the events every ring holds as Chrome trace event JSON, _file - for stdout.
+    /// @returns false if the file could not be written.
+    bool writeJson(const std::string &_file);
+    //----------------------------------------------------------------------------------------------------------------------
+
+private:
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief our ctor, only instance makes one
+    Tracer();
+    ~Tracer();
+    Tracer(const Tracer &);
+    Tracer &operator=(const Tracer &);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief an event as it sits in a ring
+    struct Event
+    {
+        const char *m_name;
+        uint64_t m_start;
+        uint64_t m_duration;
+        int m_first;
+        int m_last;
+    };
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the ring of one thread, m_written counts every event the thread ever recorded
+    struct Ring
+    {
+        Event m_events[s_capacity];
+        std::atomic <uint64_t> m_written;
+        int m_thread;
+        std::string m_name;
+    };
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the ring of the calling thread, made and registered on its first event
+    Ring &ring();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief when the tracer was made, the times of the trace start from it
+    std::chrono::steady_clock::time_point m_epoch;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief guards the list of rings, only taken when a thread records its first event and when writing
+    std::mutex m_mutex;
+    std::vector <Ring *> m_rings;
+    //----------------------------------------------------------------------------------------------------------------------
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief traces the rest of the block it is declared in as one event
+class TraceScope
+{
+public:
+    inline explicit TraceScope(const char *_name, int _first = -1, int _last = -1) :
+        m_name(_name), m_first(_first), m_last(_last), m_start(Tracer::instance().now()) {}
+    inline ~TraceScope()
+    {
+        Tracer &tracer = Tracer::instance();
+        tracer.record(m_name, m_start, tracer.now(), m_first, m_last);
+    }
+
+private:
+    const char *m_name;
+    int m_first;
+    int m_last;
+    uint64_t m_start;
+};
+
+#define FLOCK_TRACE_CONCAT2(_a, _b) _a##_b
+#define FLOCK_TRACE_CONCAT(_a, _b) FLOCK_TRACE_CONCAT2(_a, _b)
+#ifdef FLOCK_TRACE
+    #define FLOCK_TRACE_SCOPE(_name) TraceScope FLOCK_TRACE_CONCAT(traceScope, __LINE__)(_name)
+    #define FLOCK_TRACE_CHUNK(_name, _first, _last) TraceScope FLOCK_TRACE_CONCAT(traceScope, __LINE__)(_name, _first, _last)
+    #define FLOCK_TRACE_THREAD(_name) Tracer::instance().setThreadName(_name)
+#else
+    #define FLOCK_TRACE_SCOPE(_name)
+    #define FLOCK_TRACE_CHUNK(_name, _first, _last)
+    #define FLOCK_TRACE_THREAD(_name)
+#endif
+
+#endif // TRACER_H
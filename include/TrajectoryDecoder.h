@@ -0,0 +1,82 @@
+#ifndef TRAJECTORYDECODER_H
+#define TRAJECTORYDECODER_H
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "MappedFile.h"
+#include "ThreadPool.h"
+#include "TrajectoryEncoder.h"
+
+/*! \brief the trajectory decoder class */
+/// @file TrajectoryDecoder.h
+/// @brief reads back the positions of a stream written by TrajectoryEncoder.
+/// @author Dionysios Toufexis
+/// @version 1.0
+/// @date 17/10/2026
+/// @class TrajectoryDecoder
+/// @brief the stream is memory mapped and its frame index read on open. Going to the frame after the last one
+/// decoded costs one frame, any other frame is decoded from the keyframe at or before it, so a seek never costs
+/// more than a keyframe interval of frames. The blocks of a frame are decoded over the thread pool. Every
+/// position of a frame comes back within getMaxError of that frame of the position encoded.
+
+class TrajectoryDecoder
+{
+public:
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief our ctor, no stream is open
+    TrajectoryDecoder();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief our dtor
+    ~TrajectoryDecoder();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief maps a stream, a stream already open is closed first.
+    /// @param [in] _threads the threads the blocks are decoded on, 0 for one per hardware thread.
+    /// @returns false if the file is missing, is not a stream or its index is damaged.
+    bool open(const std::string &_file, int _threads = 0);
+    //----------------------------------------------------------------------------------------------------------------------
+    void close();
+    inline bool isOpen() const {return m_file.isOpen();}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the number of frames and the boids of a frame
+    inline int getFrameCount() const {return (int)m_offsets.size();}
+    int getCount(int _frame) const;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the largest error along any axis of a decoded position of a frame, half a quantisation step of
+    /// the box of the frame
+    float getMaxError(int _frame) const;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief decodes the positions of a frame.
+    /// @param [in] _frame the frame, from 0 to getFrameCount() - 1.
+    /// @param [out] _x,_y,_z room for getCount(_frame) positions.
+    /// @returns false if the frame is damaged.
+    bool decode(int _frame, float *_x, float *_y, float *_z);
+    //----------------------------------------------------------------------------------------------------------------------
+
+private:
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief decodes the quantised positions of _frame into m_current from the frames before it in m_previous
+    /// and m_beforePrevious, then makes it the previous frame
+    bool step(int _frame);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the header of a frame
+    QuantizedFrameHeader frameHeader(int _frame) const;
+    //----------------------------------------------------------------------------------------------------------------------
+    MappedFile m_file;
+    QuantizedFileHeader m_header;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the workers the blocks are decoded on
+    ThreadPool *m_pool;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the offset of every frame and the keyframe each frame is decoded from
+    std::vector <uint64_t> m_offsets;
+    std::vector <int> m_keyframes;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the last frame decoded, -1 for none, and the quantised positions of it and the frame before
+    int m_decoded;
+    std::vector <uint16_t> m_current[3];
+    std::vector <uint16_t> m_previous[3];
+    std::vector <uint16_t> m_beforePrevious[3];
+    //----------------------------------------------------------------------------------------------------------------------
+};
+
+#endif // TRAJECTORYDECODER_H
@@ -0,0 +1,154 @@
+#ifndef TRAJECTORYENCODER_H
+#define TRAJECTORYENCODER_H
+#include <stdint.h>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "FlockState.h"
+#include "ThreadPool.h"
+#include "ngl/Vector.h"
+
+/*! \brief the trajectory encoder class */
+/// @file TrajectoryEncoder.h
+/// @brief writes the boid positions of every frame as a compressed stream, 16 bits per axis before the
+/// entropy coding.
+/// @author Dionysios Toufexis
+/// @version 1.0
+/// @date 17/10/2026
+/// @class TrajectoryEncoder
+/// @brief every keyframe fits a box around the flock, grown by s_margin of its size on every side, and every
+/// coordinate is quantised to 16 bits across it, so a boid comes back within half a step, (max - min) / 65535 / 2,
+/// of where it was on every axis. getMaxError gives the bound for a box. The frames after a keyframe use its
+/// box, a boid that leaves it forces a new keyframe so nothing is ever clamped. The quantised values are not
+/// stored as they are: every keyframe is coded on its own, the frame after it as the difference to it and
+/// every later frame as the difference to the motion of the two frames before, which for a flock is a few
+/// steps at most. The differences go through RansCoder in blocks of s_blockSize boids per axis, the blocks are
+/// coded over the thread pool. A keyframe is also put in every keyframe interval and whenever the number of
+/// boids changes, the decoder starts from the keyframe before a frame to seek to it. The quantised values are
+/// coded without loss, so the error does not grow along the frames.
+///
+///     QuantizedFileHeader
+///     QuantizedFrameHeader, uint32 bytes of every block (x blocks, y blocks, z blocks), the blocks  (one per frame)
+///     TrajectoryIndexHeader, uint64 offset of every frame
+///     TrajectoryFooter
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the start of a quantised trajectory
+struct QuantizedFileHeader
+{
+    char m_magic[4];
+    uint32_t m_version;
+    uint32_t m_keyframeInterval;
+    uint32_t m_blockSize;
+};
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the start of a frame, the block sizes and the blocks follow it
+struct QuantizedFrameHeader
+{
+    /// @brief how a frame is predicted from the ones before it
+    enum Predictor {KEY, PREVIOUS, MOTION};
+    char m_magic[4];
+    uint32_t m_count;
+    /// @brief the number of the frame since the stream was opened
+    uint64_t m_number;
+    uint32_t m_predictor;
+    /// @brief the number of blocks per axis
+    uint32_t m_blocks;
+    /// @brief the bytes of the block sizes and the blocks
+    uint64_t m_payloadBytes;
+    /// @brief the box the positions are quantised across, the box of the keyframe the frame is predicted from
+    float m_min[3];
+    float m_max[3];
+};
+
+class TrajectoryEncoder
+{
+public:
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the version written into the streams
+    static const uint32_t s_version = 1;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the boids per axis coded as one block
+    static const int s_blockSize = 65536;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the share of the size of the flock the box of a keyframe is grown by on every side, the room the
+    /// flock has to move before a new keyframe is needed
+    static const float s_margin;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the largest distance along any axis between a boid quantised across the box and where the decoder
+    /// puts it
+    static float getMaxError(const ngl::Vector &_min, const ngl::Vector &_max);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief our ctor, nothing is written until open
+    TrajectoryEncoder();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief our dtor, closes the stream
+    ~TrajectoryEncoder();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief starts a stream, a stream already open is closed first.
+    /// @param [in] _file the file to write, it is replaced.
+    /// @param [in] _keyframeInterval a keyframe is put in every this many frames.
+    /// @param [in] _threads the threads the blocks are coded on, 0 for one per hardware thread.
+    /// @returns false if the file could not be created.
+    bool open(const std::string &_file, int _keyframeInterval = 30, int _threads = 0);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief codes and writes the positions of the next frame.
+    void encode(const float *_x, const float *_y, const float *_z, int _count);
+    void encode(const FlockState &_state);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief writes the frame index and closes the file
+    /// @returns false if a write failed, the file is then left without its index and footer.
+    bool close();
+    //----------------------------------------------------------------------------------------------------------------------
+    inline bool isOpen() const {return m_file != 0;}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the frames and the bytes written so far
+    inline uint64_t getFramesWritten() const {return m_index.size();}
+    inline uint64_t getBytesWritten() const {return m_offset;}
+    //----------------------------------------------------------------------------------------------------------------------
+
+private:
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief writes _bytes to the file and moves the offset on
+    void write(const void *_data, size_t _bytes);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief finds the box around the positions over the workers
+    void bounds(const float *const *_positions, int _count, float *_min, float *_max);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief sets the box of a keyframe from the box of its positions
+    void fitBox(const float *_min, const float *_max);
+    //----------------------------------------------------------------------------------------------------------------------
+    FILE *m_file;
+    uint64_t m_offset;
+    bool m_good;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the workers the blocks are coded on
+    ThreadPool *m_pool;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the box of the last keyframe and the steps per unit along each axis
+    float m_min[3];
+    float m_max[3];
+    float m_scale[3];
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the box each worker found
+    std::vector <float> m_workerBounds;
+    int m_keyframeInterval;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the quantised positions of this frame and the two before it, per axis
+    std::vector <uint16_t> m_current[3];
+    std::vector <uint16_t> m_previous[3];
+    std::vector <uint16_t> m_beforePrevious[3];
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the frames coded since the last keyframe, 0 forces a keyframe
+    int m_history;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the coded blocks of the frame, x blocks then y blocks then z blocks, and their residuals
+    std::vector <std::vector <uint8_t> > m_blocks;
+    std::vector <std::vector <uint16_t> > m_residuals;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the offset of every frame written
+    std::vector <uint64_t> m_index;
+    //----------------------------------------------------------------------------------------------------------------------
+};
+
+#endif // TRAJECTORYENCODER_H
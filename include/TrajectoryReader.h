@@ -0,0 +1,82 @@
+#ifndef TRAJECTORYREADER_H
+#define TRAJECTORYREADER_H
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "MappedFile.h"
+#include "TrajectoryRecorder.h"
+
+/*! \brief the trajectory reader class */
+/// @file TrajectoryReader.h
+/// @brief maps a file written by TrajectoryRecorder and hands out any of its frames in place.
+/// @author Dionysios Toufexis
+/// @version 1.0
+/// @date 17/10/2026
+/// @class TrajectoryReader
+/// @brief the file is memory mapped and the frame index at its end gives the offset of every frame, so going
+/// to a frame is a lookup and the arrays returned point straight into the mapping. A file whose recording
+/// never closed has no index, its frame chunks are walked once on open instead.
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief one frame of a trajectory, the arrays point into the mapped file and live as long as it stays open
+struct TrajectoryFrame
+{
+    /// @brief the number of boids and the number of the frame since the recording started
+    int m_count;
+    uint64_t m_number;
+    const float *m_posX, *m_posY, *m_posZ;
+    const float *m_velX, *m_velY, *m_velZ;
+};
+
+class TrajectoryReader
+{
+public:
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief our ctor, no file is open
+    TrajectoryReader();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief our dtor, unmaps the file
+    ~TrajectoryReader();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief maps a trajectory file, a file already open is closed first.
+    /// @param [in] _file the file written by TrajectoryRecorder.
+    /// @returns false if the file is missing or is not a trajectory.
+    bool open(const std::string &_file);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief unmaps the file, the frames handed out are no longer valid
+    void close();
+    //----------------------------------------------------------------------------------------------------------------------
+    inline bool isOpen() const {return m_file.isOpen();}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief false if the recording was not closed and the frames were found by walking the file
+    inline bool isIndexed() const {return m_indexed;}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the number of frames in the file
+    inline int getFrameCount() const {return (int)m_offsets.size();}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief a frame of the file
+    /// @param [in] _frame the frame, from 0 to getFrameCount() - 1.
+    TrajectoryFrame getFrame(int _frame) const;
+    //----------------------------------------------------------------------------------------------------------------------
+
+private:
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief reads the index the footer points at, false if there is no footer or it does not add up
+    bool readIndex();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief finds the frames by walking the chunks from the start, stopping at the first one cut short
+    void scanFrames();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the mapped file, and its data and size
+    MappedFile m_file;
+    const char *m_data;
+    uint64_t m_bytes;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the offset of the chunk of every frame
+    std::vector <uint64_t> m_offsets;
+    //----------------------------------------------------------------------------------------------------------------------
+    bool m_indexed;
+    //----------------------------------------------------------------------------------------------------------------------
+};
+
+#endif // TRAJECTORYREADER_H
@@ -0,0 +1,159 @@
+#ifndef TRAJECTORYRECORDER_H
+#define TRAJECTORYRECORDER_H
+#include <stdint.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "FlockState.h"
+
+/*! \brief the trajectory recorder class */
+/// @file TrajectoryRecorder.h
+/// @brief writes the positions and velocities of every recorded frame to a binary file on a thread of its own.
+/// @author Dionysios Toufexis
+/// @version 1.0
+/// @date 17/10/2026
+/// @class TrajectoryRecorder
+/// @brief record copies the motion of the flock into a buffer and hands it to the writer thread, so the
+/// simulation only pays for the copy and never waits on the disk. The buffers are pooled, when the writer
+/// falls so far behind that every buffer is queued the frame is dropped and counted instead of blocking.
+/// @brief the file is a header followed by one chunk per frame and, once closed, a frame index and a footer
+/// pointing at it, so TrajectoryReader finds any frame without reading the ones before it. All the numbers
+/// are little endian and every array starts on a 16 byte boundary so a mapped file can be read in place.
+///
+///     TrajectoryFileHeader
+///     TrajectoryFrameHeader, posX, posY, posZ, velX, velY, velZ   (one per frame, each array padded to 4 floats)
+///     TrajectoryIndexHeader, uint64 offset of every frame chunk
+///     TrajectoryFooter
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the start of a trajectory file
+struct TrajectoryFileHeader
+{
+    char m_magic[4];
+    uint32_t m_version;
+    uint32_t m_arrays;
+    uint32_t m_pad[5];
+};
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the start of a frame chunk, the arrays follow it
+struct TrajectoryFrameHeader
+{
+    char m_magic[4];
+    /// @brief the number of boids of the frame
+    uint32_t m_count;
+    /// @brief the number of the frame since the recording started, frames that were dropped leave a gap
+    uint64_t m_number;
+    /// @brief the bytes of the arrays after this header
+    uint64_t m_payloadBytes;
+    uint64_t m_pad;
+};
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the start of the frame index, the offsets of the frame chunks follow it
+struct TrajectoryIndexHeader
+{
+    char m_magic[4];
+    uint32_t m_pad;
+    uint64_t m_frames;
+};
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the last bytes of a closed file
+struct TrajectoryFooter
+{
+    uint64_t m_indexOffset;
+    char m_magic[4];
+    uint32_t m_version;
+};
+
+class TrajectoryRecorder
+{
+public:
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the version written into the files
+    static const uint32_t s_version = 1;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the number of floats each array of a frame of _count boids takes in the file
+    static inline uint32_t arrayStride(uint32_t _count) {return (_count + 3u) & ~3u;}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief our ctor, nothing is recorded until open
+    TrajectoryRecorder();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief our dtor, closes the file
+    ~TrajectoryRecorder();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief starts a recording, a recording already running is closed first.
+    /// @param [in] _file the file to write, it is replaced.
+    /// @param [in] _buffers the most frames waiting for the writer before frames are dropped.
+    /// @returns false if the file could not be created.
+    bool open(const std::string &_file, int _buffers = 8);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief queues the positions and velocities of the flock as the next frame.
+    /// @returns false if the frame was dropped because every buffer was waiting for the writer.
+    bool record(const FlockState &_state);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief writes the frames still queued, the index and the footer and closes the file.
+    /// @returns false if a write failed, the file is then left without its index and footer.
+    bool close();
+    //----------------------------------------------------------------------------------------------------------------------
+    inline bool isOpen() const {return m_file != 0;}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the frames written and dropped since open
+    inline uint64_t getFramesWritten() const {return m_written;}
+    inline uint64_t getFramesDropped() const {return m_dropped;}
+    //----------------------------------------------------------------------------------------------------------------------
+
+private:
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief a frame waiting for the writer, the six arrays one after the other with the file padding
+    struct Frame
+    {
+        uint64_t m_number;
+        uint32_t m_count;
+        std::vector <float> m_data;
+    };
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the loop of the writer thread
+    void run();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief writes _bytes to the file and moves the offset on, a failed write stops the writing
+    void write(const void *_data, size_t _bytes);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the file being written, 0 when closed
+    FILE *m_file;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the bytes written so far and false once a write failed
+    uint64_t m_offset;
+    bool m_good;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the offset of every frame chunk written
+    std::vector <uint64_t> m_index;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the writer thread
+    std::thread m_thread;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief guards the queue, the free buffers and m_quit, never held while copying or writing
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the frames waiting for the writer, oldest first, and the buffers free for record
+    std::deque <Frame *> m_queue;
+    std::vector <Frame *> m_free;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief every buffer of the pool, owned here
+    std::vector <Frame *> m_buffers;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief set by close once the last frame is queued
+    bool m_quit;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the number the next frame gets
+    uint64_t m_nextNumber;
+    //----------------------------------------------------------------------------------------------------------------------
+    std::atomic <uint64_t> m_written;
+    std::atomic <uint64_t> m_dropped;
+    //----------------------------------------------------------------------------------------------------------------------
+};
+
+#endif // TRAJECTORYRECORDER_H
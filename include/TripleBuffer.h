@@ -0,0 +1,72 @@
+#ifndef TRIPLEBUFFER_H
+#define TRIPLEBUFFER_H
+#include <atomic>
+
+/*! \brief the triple buffer class */
+/// @file TripleBuffer.h
+/// @brief hands whole frames from one writer thread to one reader thread without a lock.
+/// @author Dionysios Toufexis
+/// @version 1.0
+/// @date 17/10/2026
+/// @class TripleBuffer
+/// @brief the writer fills the back buffer and publishes it, which swaps it with the middle buffer. The reader
+/// swaps the middle buffer with its front buffer when a newer one was published. Both swaps are a single
+/// atomic exchange so neither side ever waits for the other. The writer can publish faster than the reader
+/// picks frames up, the frames in between are dropped and the reader always gets the newest one.
+
+template <typename T>
+class TripleBuffer
+{
+public:
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief our ctor
+    TripleBuffer() : m_back(0), m_middle(1), m_front(2) {}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the buffer the writer fills, only the writer thread may use it
+    inline T &back() {return m_buffers[m_back];}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief makes the back buffer the newest frame, the writer gets the old middle buffer to fill next.
+    inline void publish()
+    {
+        m_back = m_middle.exchange(m_back | s_fresh, std::memory_order_acq_rel) & s_index;
+    }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief moves the newest published frame to the front, only the reader thread may call it.
+    /// @returns true when the front buffer changed.
+    inline bool update()
+    {
+        if((m_middle.load(std::memory_order_acquire) & s_fresh) == 0)
+        {
+            return false;
+        }
+        m_front = m_middle.exchange(m_front, std::memory_order_acq_rel) & s_index;
+        return true;
+    }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the frame the reader works on, it stays valid until the next update
+    inline const T &front() const {return m_buffers[m_front];}
+    //----------------------------------------------------------------------------------------------------------------------
+
+private:
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the bits of m_middle holding the buffer index
+    static const int s_index = 3;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief set in m_middle when it holds a frame the reader has not taken yet
+    static const int s_fresh = 4;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the three frames
+    T m_buffers[3];
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the buffer owned by the writer
+    int m_back;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the buffer in between and the fresh flag, the only value both threads touch
+    std::atomic <int> m_middle;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the buffer owned by the reader
+    int m_front;
+    //----------------------------------------------------------------------------------------------------------------------
+};
+
+#endif // TRIPLEBUFFER_H
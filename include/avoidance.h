@@ -0,0 +1,168 @@
+#ifndef AVOIDANCE_H
+#define AVOIDANCE_H
+#include <stdint.h>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <xmmintrin.h>
+#include "ngl/Vector.h"
+#include "MappedFile.h"
+
+/*! \brief the avoidance class */
+/// @file avoidance.h
+/// @brief obstacles of any shape, a triangle mesh baked into a grid of signed distances and gradients.
+/// @author Dionysios Toufexis
+/// @version 1.0
+/// @date 17/10/2026
+/// @class Avoidance
+/// @brief load bakes a closed OBJ mesh once into a regular grid holding the signed distance to the surface,
+/// negative inside, and its normalised gradient at every grid point. The grid is written next to the mesh
+/// as a .sdf cache and memory mapped, later runs with the same mesh and settings map the cache without
+/// baking. A boid then finds how far it is from the mesh and which way is out with one trilinear lookup,
+/// so the cost per boid does not depend on the number of triangles.
+/// @brief the grid is only read once loaded, any number of threads can sample it.
+
+class Avoidance
+{
+public:
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief our ctor, nothing is loaded
+    Avoidance();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief our dtor, unmaps the grid
+    ~Avoidance();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief loads the distance field of a mesh, from its cache when the cache matches the mesh and settings.
+    /// @param [in] _objFile the OBJ file, only the v and f lines are read and polygons are split into fans.
+    /// @param [in] _resolution the number of cells along the longest side of the mesh.
+    /// @param [in] _padding the space around the mesh covered by the grid, as a fraction of the longest side.
+    /// @returns false if the mesh could not be read, the previous field is kept then.
+    bool load(const std::string &_objFile, int _resolution = 64, float _padding = 0.1f);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief true once a field is loaded
+    inline bool isLoaded() const {return m_grid != 0;}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief true if the last load mapped an existing cache instead of baking
+    inline bool fromCache() const {return m_fromCache;}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the cache file of the last load
+    inline const std::string &getCachePath() const {return m_cachePath;}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the number of grid points along each axis
+    inline int getSize(int _axis) const {return m_size[_axis];}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the signed distance from the mesh at a position and the direction away from it.
+    /// Outside of the grid the distance to the grid is added to the value at its border.
+    /// @param [in] _position where to sample, a field must be loaded.
+    /// @param [out] _gradient the direction of increasing distance, not normalised after blending.
+    inline float sample(const ngl::Vector &_position, ngl::Vector &_gradient) const;
+    //----------------------------------------------------------------------------------------------------------------------
+
+private:
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the start of the cache file, padded so the grid after it is 16 byte aligned
+    struct CacheHeader
+    {
+        char m_magic[4];
+        uint32_t m_version;
+        int32_t m_size[3];
+        int32_t m_resolution;
+        float m_origin[3];
+        float m_cellSize;
+        float m_padding;
+        uint32_t m_pad;
+        uint64_t m_sourceBytes;
+        int64_t m_sourceTime;
+    };
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief reads the vertices and triangles of an OBJ file
+    static bool readObj(const std::string &_file, std::vector <float> &_vertices, std::vector <int> &_triangles);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief fills _grid with four floats per grid point, the distance and the gradient
+    static void bake(const std::vector <float> &_vertices, const std::vector <int> &_triangles, const CacheHeader &_header,
+                     std::vector <float> &_grid);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief maps a cache file, returns false if it does not exist or does not match _expected
+    bool mapCache(const std::string &_file, const CacheHeader &_expected);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief writes a cache file, through a temporary file so a crash never leaves half a cache behind
+    static bool writeCache(const std::string &_file, const CacheHeader &_header, const std::vector <float> &_grid);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief drops the current field
+    void release();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the distance and gradient of every grid point, x fastest. Points into the mapping or m_baked.
+    const float *m_grid;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the mapped cache file
+    MappedFile m_file;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the baked grid, only used when the cache could not be written or mapped
+    std::vector <float> m_baked;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the grid points along each axis
+    int m_size[3];
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the position of the first grid point
+    float m_origin[3];
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the edge length of a cell and its inverse
+    float m_cellSize;
+    float m_invCellSize;
+    //----------------------------------------------------------------------------------------------------------------------
+    bool m_fromCache;
+    std::string m_cachePath;
+    //----------------------------------------------------------------------------------------------------------------------
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+inline float Avoidance::sample(const ngl::Vector &_position, ngl::Vector &_gradient) const
+{
+    const float p[3] = {_position.m_x, _position.m_y, _position.m_z};
+    int cell[3];
+    float t[3];
+    float outside = 0.0f;
+    for(int a=0; a<3; ++a)
+    {
+        float f = (p[a] - m_origin[a]) * m_invCellSize;
+        // outside of the grid sample its border and add the distance to it
+        float limit = (float)(m_size[a] - 1);
+        float clamped = f < 0.0f ? 0.0f : (f > limit ? limit : f);
+        float d = (f - clamped) * m_cellSize;
+        outside += d * d;
+        int c = (int)clamped;
+        c = c > m_size[a] - 2 ? m_size[a] - 2 : c;
+        cell[a] = c;
+        t[a] = clamped - c;
+    }
+    // every grid point is four floats so each corner is one load and the eight corners blend as vectors
+    const int sx = 4;
+    const int sy = 4 * m_size[0];
+    const int sz = 4 * m_size[0] * m_size[1];
+    const float *c = m_grid + cell[0] * sx + cell[1] * sy + cell[2] * sz;
+    const __m128 tx = _mm_set1_ps(t[0]);
+    const __m128 ty = _mm_set1_ps(t[1]);
+    const __m128 tz = _mm_set1_ps(t[2]);
+    __m128 c000 = _mm_loadu_ps(c);
+    __m128 c100 = _mm_loadu_ps(c + sx);
+    __m128 c010 = _mm_loadu_ps(c + sy);
+    __m128 c110 = _mm_loadu_ps(c + sy + sx);
+    __m128 c001 = _mm_loadu_ps(c + sz);
+    __m128 c101 = _mm_loadu_ps(c + sz + sx);
+    __m128 c011 = _mm_loadu_ps(c + sz + sy);
+    __m128 c111 = _mm_loadu_ps(c + sz + sy + sx);
+    __m128 c00 = _mm_add_ps(c000, _mm_mul_ps(tx, _mm_sub_ps(c100, c000)));
+    __m128 c10 = _mm_add_ps(c010, _mm_mul_ps(tx, _mm_sub_ps(c110, c010)));
+    __m128 c01 = _mm_add_ps(c001, _mm_mul_ps(tx, _mm_sub_ps(c101, c001)));
+    __m128 c11 = _mm_add_ps(c011, _mm_mul_ps(tx, _mm_sub_ps(c111, c011)));
+    __m128 c0 = _mm_add_ps(c00, _mm_mul_ps(ty, _mm_sub_ps(c10, c00)));
+    __m128 c1 = _mm_add_ps(c01, _mm_mul_ps(ty, _mm_sub_ps(c11, c01)));
+    float result[4];
+    _mm_storeu_ps(result, _mm_add_ps(c0, _mm_mul_ps(tz, _mm_sub_ps(c1, c0))));
+    _gradient.m_x = result[1];
+    _gradient.m_y = result[2];
+    _gradient.m_z = result[3];
+    return outside > 0.0f ? result[0] + std::sqrt(outside) : result[0];
+}
+
+#endif // AVOIDANCE_H
@@ -1,17 +1,25 @@
 #ifndef FLOCK_H
 #define FLOCK_H
+#include <algorithm>
 #include "boid.h"
+#include "FlockState.h"
 #include "ngl/Vector.h"
-#include "ngl/TransformStack.h"
-#include "ngl/ShaderLib.h"
-#include "ngl/BBox.h"
 #include "avoidance.h"
 #include "obstacle.h"
+#include "ObstacleSet.h"
 #include "Behaviours.h"
+#include "SpatialGrid.h"
+#include "NeighbourList.h"
+#include "KdTree.h"
+#include "Octree.h"
+#include "ThreadPool.h"
+#include "CounterRng.h"
+#include "FlockSnapshot.h"
 
 /*! \brief The Flock class */
 /// @file Flock.h
-/// @brief handles the drawing of the the flock, the update movement and the collision.
+/// @brief handles the update movement and the collision of the flock. It has no GL in it, FlockRenderer
+/// draws the frames it publishes, so it links into the headless libflocksim.
 /// @brief creation of boid method modified from Jon Macey's example. Collision Demo.
 /// @brief BBox and spheretoSphere collision methods taken form Jon Macey's NGL Demos, Collision
 /// @author Dionysios Toufexis
@@ -19,45 +27,157 @@
 /// @date 20/6/2012
 /// @class Flock
 
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief where Flock::spawn places the new boids
+struct SpawnDistribution
+{
+    /// @brief BOX fills a cube of half side m_extent, BALL fills a sphere of radius m_extent.
+    enum Shape {BOX, BALL};
+    Shape m_shape;
+    ngl::Vector m_centre;
+    float m_extent;
+    /// @brief 0 keeps the start velocity of FlockState, above 0 every boid flies off at this speed in a
+    /// direction drawn from the seed
+    float m_speed;
+    /// @brief the default is the cube the flock was always created in
+    SpawnDistribution(Shape _shape = BOX, const ngl::Vector &_centre = ngl::Vector(0.0f, 0.0f, 0.0f), float _extent = 5.0f,
+                      float _speed = 0.0f) :
+        m_shape(_shape), m_centre(_centre), m_extent(_extent), m_speed(_speed) {}
+};
 
 class Flock
 {
 public:
     //----------------------------------------------------------------------------------------------------------------------
-    /// @brief ctor
-    Flock(ngl::BBox *bbox, Obstacle *obstacle);
+    /// @brief how the boids pick the neighbours they react to. METRIC takes every boid within the behaviour
+    /// distance, TOPOLOGICAL takes a fixed number of the nearest boids found through a kd-tree. APPROXIMATE
+    /// is METRIC with cohesion and alignment taken from the nodes of an octree wherever the opening angle
+    /// allows, for behaviour distances that cover a large part of the flock.
+    enum NeighbourMode {METRIC, TOPOLOGICAL, APPROXIMATE};
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief ctor, the GUI passes the size of its ngl::BBox.
+    /// @param [in] _width,_height,_depth the size of the box centred on the origin the boids are kept in.
+    /// @param [in] _obstacle the obstacle the boids avoid, 0 for none.
+    /// @param [in] _threads the workers of the flock, 0 for one per hardware thread.
+    Flock(float _width, float _height, float _depth, Obstacle *_obstacle, int _threads = 0);
     //----------------------------------------------------------------------------------------------------------------------
     /// @brief dtor
     ~Flock();
     //----------------------------------------------------------------------------------------------------------------------
-    /// @brief add new boids
-    void addBoids();
+    /// @brief adds boids to the end of the flock, there is no limit other than memory and the int the size is
+    /// kept in. The positions come from a counter based generator and are filled in over the thread pool, so
+    /// large batches stay fast and the result does not depend on the number of threads.
+    /// @param [in] _count the number of boids to add
+    /// @throws std::bad_alloc if the boids do not fit in memory, the flock is then left as it was
+    /// @param [in] _distribution where the new boids are placed
+    void spawn(int _count, const SpawnDistribution &_distribution = SpawnDistribution());
     //----------------------------------------------------------------------------------------------------------------------
-    /// @brief removes the last 10 boids
-    void removeBoids();
+    /// @brief picks the sequence the spawn positions are drawn from and starts it over, the flock of a seed is
+    /// the same on every machine. It takes effect on the next spawn or resetBoids.
+    void setSeed(uint64_t _seed) {m_rng.setSeed(_seed); m_rngCounter = 0;}
+    uint64_t getSeed() const {return m_rng.getSeed();}
     //----------------------------------------------------------------------------------------------------------------------
-    /// @brief creates the boids.
-    void resetBoids();
+    /// @brief removes the last _count boids, or all of them if there are fewer.
+    void despawn(int _count);
     //----------------------------------------------------------------------------------------------------------------------
-    /// @brief our flock draw function
-    void draw(const std::string &_shaderName, ngl::TransformStack &_transformStack, ngl::Camera *_cam) const;
+    /// @brief removes any boid, the last boid takes its index.
+    /// @param [in] _index the boid to remove
+    void removeBoid(int _index);
     //----------------------------------------------------------------------------------------------------------------------
-    /// @brief our function to do the bounding box collision between the boids and the box.
-    void validateBoundingBoxCollision();
+    /// @brief creates getFlockSize() boids from scratch, the memory of the old ones is reused.
+    /// @param [in] _distribution where the boids are placed and how fast they start
+    void resetBoids(const SpawnDistribution &_distribution = SpawnDistribution());
     //----------------------------------------------------------------------------------------------------------------------
-    /// @brief a function to caclulate if the collision is true.
+    /// @brief a function to caclulate if the collision is true. Applies the obstacles to the boids as they are,
+    /// update does the same to every range of boids in its steering pass instead.
     void checkCollisions();
     //----------------------------------------------------------------------------------------------------------------------
     /// @brief a function to calculate the final velocity for the flock.
     ngl::Vector finalFlockVelocity();
     //----------------------------------------------------------------------------------------------------------------------
     /// @brief the update method to do all the updates. Then the update is called in the GLWindow in the time event.
+    /// @brief the update is double buffered, every boid is steered from the positions and velocities of the
+    /// current frame and written to the next one which is swapped in at the end. The boids are split over
+    /// the thread pool, the result does not depend on the number of threads. The bounding box is applied to
+    /// each range of boids as soon as it is integrated instead of in a pass of its own.
+    /// @brief the steering pass is a template on the rules whose weight is not 0, the boundary mode and whether
+    /// there are obstacles, every combination is compiled and the update picks the one for the current
+    /// settings. A rule with a weight of 0 is not worked out at all and a flock without any rule only moves its
+    /// boids on. The obstacles are applied to each range of boids right after the boundary, so the flock is
+    /// swapped in with the collisions of the frame already resolved and the steering reads them on the next
+    /// update, against where the obstacles were at the end of the previous one.
     void update();
     //----------------------------------------------------------------------------------------------------------------------
+    /// @brief false steers with every rule whatever its weight, the way the update always did, so the benchmark
+    /// can measure what leaving out the unused rules saves. The boundary and obstacle variants are still picked.
+    void setPipelineSpecialised(bool _specialised) {m_specialised = _specialised;}
+    bool isPipelineSpecialised() const {return m_specialised;}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief sets the number of threads the update runs on, 0 uses one per hardware thread.
+    void setThreadCount(int _threads);
+    int getThreadCount() const {return m_pool->size();}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief direct access to the boids, used by the benchmark to lay out a flock of its own.
+    FlockState &getState() {return m_state;}
+    const FlockState &getState() const {return m_state;}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the obstacles the boids collide with, the obstacle given to the ctor is the first one and follows
+    /// the position and radius of that Obstacle. Obstacles are felt from three times their radius.
+    ObstacleSet &getObstacles() {return m_obstacles;}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief sets a mesh obstacle the boids avoid, 0 for none. The flock does not own it and it must stay
+    /// loaded while the flock uses it.
+    void setAvoidance(const Avoidance *_avoidance) {m_avoidance = _avoidance;}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief sets the margin the neighbour lists reach past the behaviour radius. The lists are kept between
+    /// updates until a boid has moved half of it, a wider skin rebuilds less often but hands every boid more
+    /// neighbours to test. 0 turns the lists off and every update bins the boids into the grid again.
+    void setNeighbourSkin(float _skin) {m_neighbourSkin = std::max(0.0f, _skin); m_neighbourList.invalidate();}
+    float getNeighbourSkin() const {return m_neighbourSkin;}
+    /// @brief true if the metric neighbours come from the lists, false if the skin is 0 or the flock is too
+    /// dense for them and the grid is used
+    bool useNeighbourList() const {return m_neighbourSkin > 0.0f && m_neighbourList.isValid();}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief how often the neighbour lists were rebuilt and how long they are
+    const NeighbourListStats &getNeighbourStats() const {return m_neighbourList.getStats();}
+    void resetNeighbourStats() {m_neighbourList.resetStats();}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief switches between the metric and the topological neighbours, it can be changed between any two
+    /// updates. The topological mode rebuilds a kd-tree every update and does not use the neighbour lists.
+    void setNeighbourMode(NeighbourMode _mode) {m_neighbourMode = _mode; m_neighbourList.invalidate();}
+    NeighbourMode getNeighbourMode() const {return m_neighbourMode;}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the number of nearest boids every boid reacts to in the topological mode, at least 1
+    void setTopologicalCount(int _k) {m_topologicalCount = std::max(1, _k);}
+    int getTopologicalCount() const {return m_topologicalCount;}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the opening angle of the approximate mode, the size of an octree node over its distance below
+    /// which it is taken as a whole. 0 only groups the nodes entirely inside the behaviour distance, which
+    /// gives the metric result, larger values are faster and less accurate.
+    void setOpeningAngle(float _theta) {m_openingAngle = std::max(0.0f, _theta);}
+    float getOpeningAngle() const {return m_openingAngle;}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief writes the boids, the behaviour parameters, the box and the obstacles to a snapshot file, see
+    /// FlockSnapshot.h. The file is written next to _file first and renamed, so a failed save leaves the old one.
+    /// @returns false if the file could not be written.
+    bool saveSnapshot(const std::string &_file) const;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief replaces the flock with a snapshot. The file is memory mapped and every array is copied from the
+    /// mapping in one pass, the obstacle given to the ctor is moved to where it was saved.
+    /// @returns false if the file is missing, cut short or of another version, the flock is left as it was.
+    bool loadSnapshot(const std::string &_file);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief reads only the header of a snapshot, the boid count and the settings.
+    /// @returns false if the file is not a snapshot.
+    static bool readSnapshotHeader(const std::string &_file, SnapshotHeader &_header);
+    //----------------------------------------------------------------------------------------------------------------------
     /// @brief GUI related functions.
     int getFlockSize() {return m_numberOfBoids;}
     void setFlockSize(int size) {m_numberOfBoids = size;}
     void setBoidSize(double size);
+    void setBoxSize(float _width, float _height, float _depth);
+    void setBoundaryMode(Boundary::Mode _mode) {m_boundary.m_mode = _mode;}
+    Boundary::Mode getBoundaryMode() const {return m_boundary.m_mode;}
     void setColour(ngl::Colour colour);
     void setWireframe(bool value);
     void setSimDistance(double distance);
@@ -65,11 +185,23 @@ public:
     void setSimCohesion(double cohesion);
     void setSimSeparation(double separation);
     void setSimAlignment(double alignment);
+    /// @brief the behaviour settings every worker shares, for reading them back
+    const Behaviours &getBehaviours() const {return m_behaviours[0];}
     //----------------------------------------------------------------------------------------------------------------------
 private:
     //----------------------------------------------------------------------------------------------------------------------
-    /// @brief a dynamic array to contain the boids.
-    std::vector <Boid*> m_boidList;
+    /// @brief a Flock owns its thread pool and is not copied
+    Flock(const Flock &);
+    Flock &operator=(const Flock &);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the boids of the flock stored as arrays.
+    FlockState m_state;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the back buffer of the update, only the motion arrays are used. Swapped with m_state every update.
+    FlockState m_next;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the workers the update is split over
+    ThreadPool *m_pool;
     //----------------------------------------------------------------------------------------------------------------------
     /*! flag to indicate if the sphere has been hit by ray */
     bool m_hit;
@@ -77,6 +209,12 @@ private:
     /// @brief the number of boids  are created
     int m_numberOfBoids;
     //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the generator of the spawn positions
+    CounterRng m_rng;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the counter of the next number m_rng hands out, every spawn moves it on.
+    uint64_t m_rngCounter;
+    //----------------------------------------------------------------------------------------------------------------------
     /// @brief pointer to object of Behaviour class
     Flock *m_react;
     //----------------------------------------------------------------------------------------------------------------------
@@ -86,23 +224,72 @@ private:
     /// @brief variable to store the boid count
     int _boidId;
     //----------------------------------------------------------------------------------------------------------------------
-    /// @brief pointer to boid class.
-    Boid *_boid;
+    /// @brief the bounding box of the flock, applied to every boid as part of its integration
+    Boundary m_boundary;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief moves the obstacle of the GUI into the obstacle set and refits it.
+    /// @returns true if there is an obstacle the boids have to be tested against.
+    bool refitObstacles();
     //----------------------------------------------------------------------------------------------------------------------
-    /// @brief a pointer to the bbox.
-    ngl::BBox *m_bbox;
+    /// @brief our sphere collision method, for the boids [_begin, _end) of _target. The sizes are read from and
+    /// the hit flags written to m_state.
+    void  checkSphereCollisions(int _begin, int _end, FlockState &_target);
     //----------------------------------------------------------------------------------------------------------------------
-    /// @brief shader method
-    void loadMatricesToShader(ngl::TransformStack &_tx, ngl::Camera *_cam) const;
+    /// @brief our mesh collision method, one distance field lookup per boid of [_begin, _end) of _target.
+    void  checkMeshCollisions(int _begin, int _end, FlockState &_target);
     //----------------------------------------------------------------------------------------------------------------------
-    /// @brief our sphere collision method.
-    void  checkSphereCollisions();
+    /// @brief applies every obstacle to the boids [_begin, _end) of _target
+    void collideBoids(int _begin, int _end, FlockState &_target);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief steers and moves the boids [_begin, _end) from m_state into m_next.
+    /// @param [in] _worker the worker of the pool running the range, picks the behaviour to use.
+    /// @brief Rules holds the SteerKernels rules that are worked out, Mode is the mode of m_boundary and
+    /// Obstacles is true if the range is tested against the obstacles.
+    template <int Rules, Boundary::Mode Mode, bool Obstacles>
+    void steerBoids(int _begin, int _end, int _worker);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief one instantiation of steerBoids
+    typedef void (Flock::*SteerPass)(int _begin, int _end, int _worker);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the instantiation of steerBoids for a set of rules, a boundary mode and the obstacles
+    static SteerPass steerPass(int _rules, Boundary::Mode _mode, bool _obstacles);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief false steers with every rule, see setPipelineSpecialised
+    bool m_specialised;
+
     //----------------------------------------------------------------------------------------------------------------------
     /// @brief a pointer for the obstacle class
     Obstacle *m_obstacle;
     //----------------------------------------------------------------------------------------------------------------------
-    /// @brief a pointer for the behaviour class
-    Behaviours *m_behaviours;
+    /// @brief every obstacle of the scene, m_obstacle is copied into it before each collision check.
+    ObstacleSet m_obstacles;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the index of m_obstacle in m_obstacles, -1 without one
+    int m_obstacleId;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the distance field of the mesh obstacle, 0 without one
+    const Avoidance *m_avoidance;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief one behaviour per worker of the pool, they hold the scratch data of the boid being steered.
+    /// The GUI setters are applied to all of them.
+    std::vector <Behaviours> m_behaviours;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the spatial grid used by the behaviours to find the local boids when the neighbour lists are off,
+    /// rebuilt every update.
+    SpatialGrid m_grid;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the cached neighbours of every boid and the margin they are built with, 0 when they are off
+    NeighbourList m_neighbourList;
+    float m_neighbourSkin;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the neighbour mode, and the tree and neighbour count of the topological one
+    NeighbourMode m_neighbourMode;
+    KdTree m_kdTree;
+    int m_topologicalCount;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the octree and the opening angle of the approximate mode
+    Octree m_octree;
+    float m_openingAngle;
     //----------------------------------------------------------------------------------------------------------------------
     double m_boidScale;
     //----------------------------------------------------------------------------------------------------------------------
@@ -116,9 +303,9 @@ private:
     ///	@param[in] _radius2 the radius of the second sphere
     bool sphereSphereCollision(
                                      ngl::Vector _pos1,
-                                     GLfloat _radius1,
+                                     float _radius1,
                                      ngl::Vector _pos2,
-                                     GLfloat _radius2
+                                     float _radius2
                                  );
 
 
@@ -56,10 +56,30 @@ private slots:
 
     void on_m_simAlignment_valueChanged(double arg1);
 
+    void on_m_simTopological_toggled(bool checked);
+
+    void on_m_simNeighbourCount_valueChanged(int arg1);
+
     void on_m_backColour_clicked();
 
     void on_m_bboxSize_valueChanged(double arg1);
 
+    void on_m_record_toggled(bool checked);
+
+    void on_m_replay_toggled(bool checked);
+
+    void on_m_replayFrame_sliderMoved(int position);
+
+    void on_m_saveSnapshot_clicked();
+
+    void on_m_loadSnapshot_clicked();
+
+    void on_m_dumpProfile_clicked();
+
+    void flockOutOfMemory(int boids);
+
+    void recordingFailed();
+
 private:
     Ui::MainWindow *m_ui;
 
@@ -1,10 +1,8 @@
 #ifndef OBSTACLE_H
 #define OBSTACLE_H
 
-#include <ngl/Camera.h>
-#include <ngl/ShaderLib.h>
-#include <ngl/TransformStack.h>
 #include <ngl/Vector.h>
+#include <ngl/Colour.h>
 
 /*! \brief The obstacle class */
 /// @file obstacle.h
@@ -13,7 +11,7 @@
 /// @version 1.0
 /// @date 01/7/2012
 /// @class Obstacle
-/// @brief create the obstacle and its properties to be used by the flock collision.
+/// @brief create the obstacle and its properties to be used by the flock collision. ObstacleRenderer draws it.
 
 
 class Obstacle
@@ -24,25 +22,9 @@ public:
     /// @param [in] spherePosition the initilized value of the obstacle position
     /// @param [in] sphereRadius the initilized value of the obstacle radius
     Obstacle(ngl::Vector spherePosition,
-             GLfloat sphereRadius
+             float sphereRadius
              );
     //----------------------------------------------------------------------------------------------------------------------
-    /// @brief drawing the VBO obstacle
-    /// @param [in] _shaderName value
-    /// @param [in] _transformStack  values
-    /// @param [in] _cam camera values
-    void ObsDraw(const std::string &_shaderName,
-                 ngl::TransformStack &_transformStack,
-                 ngl::Camera *_cam
-                 )const ;
-    //----------------------------------------------------------------------------------------------------------------------
-    /// @brief load our matrices to shader
-    /// @param [in] transformationStack valus
-    /// @param [in] camera value
-    void loadMatricesToShader(ngl::TransformStack &_tx,
-                              ngl::Camera *_cam
-                              )const;
-    //----------------------------------------------------------------------------------------------------------------------
     /// @brief variable to store the obstacle position
     /// @param [in] _spherePosition the obstacle Position within the space.
     inline ngl::Vector getSpherePosition()const{return _spherePosition;}
@@ -53,19 +35,21 @@ public:
     //----------------------------------------------------------------------------------------------------------------------
     /// @brief gets the obstacle size
     /// @param [in] _spherePosition returns the obstacle size.
-    inline GLfloat getSphereRadius()const{return _sphereRadius;}
+    inline float getSphereRadius()const{return _sphereRadius;}
     //----------------------------------------------------------------------------------------------------------------------   
     /// @brief sets the obstacle radius
     /// @param [in] _spherePosition sets the obstacle size value.
-    void setSphereRadius(GLfloat radius) {_sphereRadius = radius;}
+    void setSphereRadius(float radius) {_sphereRadius = radius;}
     //----------------------------------------------------------------------------------------------------------------------
     /// @brief sets the color of the obstacle
     /// @param [in] m_color sets color value for the obstacle
     void setColour(ngl::Colour colour) {m_colour = colour;}
+    inline const ngl::Colour &getColour()const{return m_colour;}
     //----------------------------------------------------------------------------------------------------------------------
     /// @brief sets the wireframe for the obstacle
     /// @param [in] m_wireframe sets the wireframe value on/off.
     void setWireframe(bool value) {m_wireframe = value;}
+    inline bool isWireframe()const{return m_wireframe;}
     //----------------------------------------------------------------------------------------------------------------------
 
 private:
@@ -73,7 +57,7 @@ private:
     ngl::Vector _spherePosition;
     //----------------------------------------------------------------------------------------------------------------------
     /// @brief a variable to store the obstacle radius
-    GLfloat _sphereRadius;
+    float _sphereRadius;
     //----------------------------------------------------------------------------------------------------------------------
     bool _hit;
     //----------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,82 @@
+#version 150
+/// @brief the Phong vertex shader for the flock, every boid is one instance of the same sphere
+/// @brief flag to indicate if model has unit normals if not normalize
+uniform bool Normalize;
+// the eye position of the camera
+uniform vec3 viewerPos;
+/// @brief the current fragment normal for the vert being processed
+out vec3 fragmentNormal;
+/// @brief the vertex passed in
+in vec3 inVert;
+/// @brief the normal passed in
+in vec3 inNormal;
+/// @brief the in uv
+in vec2 inUV;
+/// @brief the position of the boid, one per instance
+in vec3 inInstancePosition;
+/// @brief the scale of the boid, one per instance
+in vec3 inInstanceScale;
+/// @brief the colour of the boid, one per instance
+in vec4 inInstanceColour;
+/// @brief the colour of the boid handed to the fragment shader as the diffuse colour
+out vec4 instanceColour;
+
+struct Lights
+{
+  vec4 position;
+  vec4 ambient;
+  vec4 diffuse;
+  vec4 specular;
+  float constantAttenuation;
+  float linearAttenuation;
+  float quadraticAttenuation;
+  float spotCosCutoff;
+};
+// array of lights
+uniform Lights light;
+// direction of the lights used for shading
+out vec3 lightDir;
+// out the blinn half vector
+out vec3 halfVector;
+out vec3 eyeDirection;
+out vec3 vPosition;
+
+// the matrices of the whole flock, the boid is placed by its instance position and scale
+uniform mat4 MV;
+uniform mat4 MVP;
+uniform mat3 normalMatrix;
+uniform mat4 M;
+
+
+void main()
+{
+// the sphere is scaled and moved to the boid, the normal gets the inverse scale
+vec3 boidVert = inVert * inInstanceScale + inInstancePosition;
+fragmentNormal = (normalMatrix*(inNormal / inInstanceScale));
+
+
+if (Normalize == true)
+{
+ fragmentNormal = normalize(fragmentNormal);
+}
+instanceColour = inInstanceColour;
+// calculate the vertex position
+gl_Position = MVP*vec4(boidVert,1.0);
+
+vec4 worldPosition = M * vec4(boidVert, 1.0);
+eyeDirection = normalize(viewerPos - worldPosition.xyz);
+// Get vertex position in eye coordinates
+// Transform the vertex to eye co-ordinates for frag shader
+/// @brief the vertex in eye co-ordinates  homogeneous
+vec4 eyeCord=MV*vec4(boidVert,1);
+
+vPosition = eyeCord.xyz / eyeCord.w;;
+
+float dist;
+
+lightDir=vec3(light.position.xyz-eyeCord.xyz);
+dist = length(lightDir);
+lightDir/= dist;
+halfVector = normalize(eyeDirection + lightDir);
+
+}
@@ -1,5 +1,6 @@
 #include "Behaviours.h"
 #include "boost/foreach.hpp"
+#include <algorithm>
 
 Behaviours::Behaviours()
 {
@@ -8,48 +9,80 @@ Behaviours::Behaviours()
     m_seperationForce = 9;
     m_alignment = 10;
     m_cohesionForce = 2;
+    setRules(SteerKernels::ALL_RULES);
 }
 //----------------------------------------------------------------------------------------------------------------------
-void Behaviours::Cohesion(int &_boidNumber, std::vector <Boid*> & _boidList)
+int Behaviours::activeRules() const
+{
+    int rules = 0;
+    if(m_cohesionForce != 0.0)
+    {
+        rules |= SteerKernels::COHESION;
+    }
+    if(m_alignment != 0.0)
+    {
+        rules |= SteerKernels::ALIGNMENT;
+    }
+    if(m_seperationForce != 0.0)
+    {
+        rules |= SteerKernels::SEPARATION;
+    }
+    return rules;
+}
+//----------------------------------------------------------------------------------------------------------------------
+void Behaviours::setRules(int _rules)
+{
+    m_rules = _rules & SteerKernels::ALL_RULES;
+    m_kernel = SteerKernels::accumulate(m_rules);
+}
+//----------------------------------------------------------------------------------------------------------------------
+void Behaviours::Cohesion(int &_boidNumber, const FlockState &_state, const SpatialGrid &_grid)
 {
     m_coherence = 0;
     m_boidDistance = 0;
     int count = 1;
 
-    for(int i=0;i<_boidList.size();i++)
+    _grid.gatherNeighbours(_state.getPosition(_boidNumber), m_neighbours);
+    for(unsigned int n=0;n<m_neighbours.size();n++)
     {
+        int i = m_neighbours[n];
         if(i!=_boidNumber)
         {
-            m_boidDistance = _boidList.at(_boidNumber)->getPosition() - _boidList.at(i)->getPosition();
+            m_boidDistance = _state.getPosition(_boidNumber) - _state.getPosition(i);
 
             if(m_boidDistance.length() < m_BehaviourDistance)
             {
-                m_coherence += _boidList.at(i)->getPosition();
+                m_coherence += _state.getPosition(i);
                 count++;
             }
         }
     }
     m_coherence /= count;
-    m_coherence = (m_coherence - _boidList.at(_boidNumber)->getPosition());
+    m_coherence = (m_coherence - _state.getPosition(_boidNumber));
     m_coherence.normalize();
 }
 
 
 //----------------------------------------------------------------------------------------------------------------------
-void Behaviours::Alignment(int &_boidNumber, std::vector<Boid*> &_boidList)
+void Behaviours::Alignment(int &_boidNumber, const FlockState &_state, const SpatialGrid &_grid)
 {
     int count = 1;
     m_boidDistance = 0;
+    // every boid starts from no alignment, carrying it on from the previous boid made the result
+    // depend on the order the boids are visited in
+    m_alignmentForce = 0;
 
-    for(int i=0;i<_boidList.size();i++)
+    _grid.gatherNeighbours(_state.getPosition(_boidNumber), m_neighbours);
+    for(unsigned int n=0;n<m_neighbours.size();n++)
     {
+        int i = m_neighbours[n];
         if(i!=_boidNumber)
         {
-            m_boidDistance = _boidList.at(_boidNumber)->getPosition() - _boidList.at(i)->getPosition();
+            m_boidDistance = _state.getPosition(_boidNumber) - _state.getPosition(i);
 
             if(m_boidDistance.length() < m_BehaviourDistance)
             {
-                m_alignmentForce += _boidList.at(i)->getVelocity();
+                m_alignmentForce += _state.getVelocity(i);
                 count++;
             }
         }
@@ -61,25 +94,27 @@ void Behaviours::Alignment(int &_boidNumber, std::vector<Boid*> &_boidList)
     }
 
     m_alignmentForce /= count;
-    m_alignmentForce = (m_alignmentForce - _boidList.at(_boidNumber)->getVelocity());
+    m_alignmentForce = (m_alignmentForce - _state.getVelocity(_boidNumber));
 
 
 }
 //----------------------------------------------------------------------------------------------------------------------
-void Behaviours::Seperation(int &_boidNumber, std::vector<Boid*> &_boidList)
+void Behaviours::Seperation(int &_boidNumber, const FlockState &_state, const SpatialGrid &_grid)
 {
     m_separation = 0;
     m_boidDistance = 0;
 
-    for(int i=0;i<_boidList.size();i++)
+    _grid.gatherNeighbours(_state.getPosition(_boidNumber), m_neighbours);
+    for(unsigned int n=0;n<m_neighbours.size();n++)
     {
+        int i = m_neighbours[n];
         if(i!=_boidNumber)
         {
-            m_boidDistance = _boidList.at(_boidNumber)->getPosition() - _boidList.at(i)->getPosition();
+            m_boidDistance = _state.getPosition(_boidNumber) - _state.getPosition(i);
 
             if(m_boidDistance.length() < m_flockDistance)
             {
-                m_separation -= (_boidList.at(_boidNumber)->getPosition() - _boidList.at(i)->getPosition());
+                m_separation -= (_state.getPosition(_boidNumber) - _state.getPosition(i));
             }
         }
     }
@@ -89,38 +124,121 @@ void Behaviours::Seperation(int &_boidNumber, std::vector<Boid*> &_boidList)
     }
 }
 //----------------------------------------------------------------------------------------------------------------------
-void Behaviours::Destination(int & _boidNumber, std::vector <Boid*> & _boidList)
+void Behaviours::Steer(int &_boidNumber, const FlockState &_state, const SpatialGrid &_grid)
 {
-    ngl::Vector targeting(1,0,1);
-
-    targeting = ((targeting   - _boidList.at(_boidNumber)->getNextPosition()) * - 100);
+    // pack the candidates into contiguous arrays so the kernel can stream through them
+    _grid.gatherNeighbours(_state.getPosition(_boidNumber), m_neighbours);
+    reserveBatch((int)m_neighbours.size());
+    int packed = 0;
+    for(unsigned int n=0;n<m_neighbours.size();n++)
+    {
+        int i = m_neighbours[n];
+        if(i!=_boidNumber)
+        {
+            packNeighbour(packed++, _state, i);
+        }
+    }
+    accumulatePacked(_boidNumber, _state, packed, m_BehaviourDistance * m_BehaviourDistance);
 }
 //----------------------------------------------------------------------------------------------------------------------
-
-ngl::Vector Behaviours::BehaviourSetup()
+void Behaviours::Steer(int &_boidNumber, const FlockState &_state, const NeighbourList &_list)
 {
-
-    ngl::Vector m_seperationCorrection = -1;
-    m_behaviourSetup = 0.9;
-
-
-    m_seperationSet = (((m_seperationForce) * m_separation)* m_seperationCorrection);
-    m_cohesionSet = m_cohesionForce * m_coherence;
-    m_alighmentSet = m_alignmentForce * m_alignment;
-    m_behaviourSetup = m_seperationSet + m_cohesionSet + m_alighmentSet;
-
-    if (m_behaviourSetup.length() > 0.5)
+    // the list never holds the boid itself so its row is packed as it is
+    const int *row = _list.getIndices().data() + _list.getOffsets()[_boidNumber];
+    const int length = _list.getOffsets()[_boidNumber + 1] - _list.getOffsets()[_boidNumber];
+    reserveBatch(length);
+    for(int n=0;n<length;n++)
     {
-        m_behaviourSetup.normalize();
-        m_behaviourSetup *=0.5;
+        packNeighbour(n, _state, row[n]);
     }
-
-
-    return m_behaviourSetup;
-
-
-
-
-
+    accumulatePacked(_boidNumber, _state, length, m_BehaviourDistance * m_BehaviourDistance);
 }
+//----------------------------------------------------------------------------------------------------------------------
+void Behaviours::Steer(int &_boidNumber, const FlockState &_state, const KdTree &_tree, int _k)
+{
+    _tree.nearest(_state.getPosition(_boidNumber), _k, _boidNumber, m_neighbours, m_neighbourDistances);
+    reserveBatch((int)m_neighbours.size());
+    for(unsigned int n=0;n<m_neighbours.size();n++)
+    {
+        packNeighbour(n, _state, m_neighbours[n]);
+    }
+    // every one of the k boids counts for cohesion and alignment however far it is. The reach has to stay
+    // finite, the padding is only far away and would pass a test against FLT_MAX. Twice the farthest of the k
+    // takes them all whatever the rounding of the kernel and stays far below the padding.
+    float reach = 0.0f;
+    for(unsigned int n=0;n<m_neighbourDistances.size();n++)
+    {
+        reach = std::max(reach, m_neighbourDistances[n]);
+    }
+    accumulatePacked(_boidNumber, _state, (int)m_neighbours.size(), reach * 2.0f + 1.0f);
+}
+//----------------------------------------------------------------------------------------------------------------------
+void Behaviours::Steer(int &_boidNumber, const FlockState &_state, const Octree &_tree, float _theta)
+{
+    // the boids of the opened leaves are tested exactly by the kernel, the nodes taken as a whole are added after
+    int packed = 0;
+    reserveBatch(0);
+    OctreeSums whole;
+    _tree.query(_state.getPosition(_boidNumber), m_BehaviourDistance, m_flockDistance, _theta, whole, [&](int _begin, int _end)
+    {
+        reserveBatch(packed + _end - _begin);
+        for(int i=_begin; i<_end; ++i)
+        {
+            if(_tree.getBoid(i) != _boidNumber)
+            {
+                m_batchX[packed] = _tree.getPosX()[i];
+                m_batchY[packed] = _tree.getPosY()[i];
+                m_batchZ[packed] = _tree.getPosZ()[i];
+                m_batchVX[packed] = _tree.getVelX()[i];
+                m_batchVY[packed] = _tree.getVelY()[i];
+                m_batchVZ[packed] = _tree.getVelZ()[i];
+                packed++;
+            }
+        }
+    });
+    accumulatePacked(_boidNumber, _state, packed, m_BehaviourDistance * m_BehaviourDistance);
+    m_sums.m_cohesionX += whole.m_positionX;
+    m_sums.m_cohesionY += whole.m_positionY;
+    m_sums.m_cohesionZ += whole.m_positionZ;
+    m_sums.m_alignmentX += whole.m_velocityX;
+    m_sums.m_alignmentY += whole.m_velocityY;
+    m_sums.m_alignmentZ += whole.m_velocityZ;
+    m_sums.m_count += whole.m_count;
+}
+//----------------------------------------------------------------------------------------------------------------------
+void Behaviours::reserveBatch(int _count)
+{
+    int padded = _count + SteerKernels::s_padding;
+    if((int)m_batchX.size() < padded)
+    {
+        m_batchX.resize(padded); m_batchY.resize(padded); m_batchZ.resize(padded);
+        m_batchVX.resize(padded); m_batchVY.resize(padded); m_batchVZ.resize(padded);
+    }
+}
+//----------------------------------------------------------------------------------------------------------------------
+void Behaviours::accumulatePacked(int _boidNumber, const FlockState &_state, int _packed, float _reachSq)
+{
+    // the padding sits far away so it fails both radius tests
+    int packed = _packed;
+    while(packed % SteerKernels::s_padding != 0)
+    {
+        m_batchX[packed] = m_batchY[packed] = m_batchZ[packed] = SteerKernels::s_farAway;
+        m_batchVX[packed] = m_batchVY[packed] = m_batchVZ[packed] = 0.0f;
+        packed++;
+    }
 
+    NeighbourBatch batch;
+    batch.m_x = &m_batchX[0]; batch.m_y = &m_batchY[0]; batch.m_z = &m_batchZ[0];
+    batch.m_vx = &m_batchVX[0]; batch.m_vy = &m_batchVY[0]; batch.m_vz = &m_batchVZ[0];
+    batch.m_count = packed;
+    const float flockDistanceSq = m_flockDistance * m_flockDistance;
+    m_kernel(batch, _state.m_posX[_boidNumber], _state.m_posY[_boidNumber], _state.m_posZ[_boidNumber],
+             _reachSq, flockDistanceSq, m_sums);
+}
+//----------------------------------------------------------------------------------------------------------------------
+ngl::Vector Behaviours::BehaviourSetup() const
+{
+    return blend<SteerKernels::ALL_RULES>(m_coherence, m_alignmentForce, m_separation);
+}
+//----------------------------------------------------------------------------------------------------------------------
+Behaviours::~Behaviours(){}
@@ -0,0 +1,93 @@
+#include "FlockMetrics.h"
+#include <algorithm>
+#include <cmath>
+
+//----------------------------------------------------------------------------------------------------------------------
+int FlockMetrics::root(int _boid)
+{
+    while(m_parent[_boid] != _boid)
+    {
+        m_parent[_boid] = m_parent[m_parent[_boid]];
+        _boid = m_parent[_boid];
+    }
+    return _boid;
+}
+//----------------------------------------------------------------------------------------------------------------------
+OrderMetrics FlockMetrics::measure(const FlockState &_state, float _linkDistance, ThreadPool &_pool)
+{
+    OrderMetrics metrics;
+    const int count = _state.size();
+    if(count == 0)
+    {
+        return metrics;
+    }
+
+    // boids that are not moving have no heading and are left out
+    double sumX = 0.0, sumY = 0.0, sumZ = 0.0;
+    int moving = 0;
+    for(int i=0; i<count; ++i)
+    {
+        double x = _state.m_velX[i], y = _state.m_velY[i], z = _state.m_velZ[i];
+        double length = std::sqrt(x * x + y * y + z * z);
+        if(length > 0.0)
+        {
+            sumX += x / length;
+            sumY += y / length;
+            sumZ += z / length;
+            ++moving;
+        }
+    }
+    if(moving > 0)
+    {
+        metrics.m_polarization = std::sqrt(sumX * sumX + sumY * sumY + sumZ * sumZ) / moving;
+    }
+
+    if(count > 1)
+    {
+        m_tree.build(_state, _pool);
+        double sum = 0.0;
+        for(int i=0; i<count; ++i)
+        {
+            m_tree.nearest(_state.getPosition(i), 1, i, m_neighbours, m_distancesSq);
+            sum += std::sqrt(m_distancesSq[0]);
+        }
+        metrics.m_nearestDistance = sum / count;
+    }
+
+    m_parent.resize(count);
+    for(int i=0; i<count; ++i)
+    {
+        m_parent[i] = i;
+    }
+    const float linkSq = _linkDistance * _linkDistance;
+    m_grid.rebuild(_state, std::max(_linkDistance, 1.0e-3f));
+    metrics.m_clusters = count;
+    for(int i=0; i<count; ++i)
+    {
+        m_grid.gatherNeighbours(_state.getPosition(i), m_neighbours);
+        for(unsigned int n=0; n<m_neighbours.size(); ++n)
+        {
+            // every pair is seen from both ends, the higher index joins it
+            int j = m_neighbours[n];
+            if(j >= i)
+            {
+                continue;
+            }
+            float dx = _state.m_posX[i] - _state.m_posX[j];
+            float dy = _state.m_posY[i] - _state.m_posY[j];
+            float dz = _state.m_posZ[i] - _state.m_posZ[j];
+            if(dx * dx + dy * dy + dz * dz < linkSq)
+            {
+                int a = root(i);
+                int b = root(j);
+                if(a != b)
+                {
+                    m_parent[a] = b;
+                    --metrics.m_clusters;
+                }
+            }
+        }
+    }
+    return metrics;
+}
+//----------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,234 @@
+#include "FlockRenderer.h"
+#include "Profiler.h"
+#include <ngl/ShaderLib.h>
+#include <ngl/Material.h>
+#include <cmath>
+
+FlockRenderer::FlockRenderer(float _radius, int _precision)
+{
+    m_indexCount = 0;
+    m_instanceCapacity = 0;
+
+    glGenVertexArrays(1, &m_vao);
+    glBindVertexArray(m_vao);
+    glGenBuffers(1, &m_meshVBO);
+    glGenBuffers(1, &m_indexVBO);
+    glGenBuffers(1, &m_instanceVBO);
+
+    buildSphere(_radius, _precision);
+
+    // the instance attributes step once per sphere instead of once per vertex
+    glBindBuffer(GL_ARRAY_BUFFER, m_instanceVBO);
+    const GLsizei stride = s_instanceFloats * sizeof(GLfloat);
+    glEnableVertexAttribArray(POSITION);
+    glVertexAttribPointer(POSITION, 3, GL_FLOAT, GL_FALSE, stride, (const GLvoid *)0);
+    glVertexAttribDivisor(POSITION, 1);
+    glEnableVertexAttribArray(SCALE);
+    glVertexAttribPointer(SCALE, 3, GL_FLOAT, GL_FALSE, stride, (const GLvoid *)(3 * sizeof(GLfloat)));
+    glVertexAttribDivisor(SCALE, 1);
+    glEnableVertexAttribArray(COLOUR);
+    glVertexAttribPointer(COLOUR, 4, GL_FLOAT, GL_FALSE, stride, (const GLvoid *)(6 * sizeof(GLfloat)));
+    glVertexAttribDivisor(COLOUR, 1);
+
+    glBindVertexArray(0);
+}
+//----------------------------------------------------------------------------------------------------------------------
+FlockRenderer::~FlockRenderer()
+{
+    glDeleteBuffers(1, &m_instanceVBO);
+    glDeleteBuffers(1, &m_indexVBO);
+    glDeleteBuffers(1, &m_meshVBO);
+    glDeleteVertexArrays(1, &m_vao);
+}
+//----------------------------------------------------------------------------------------------------------------------
+void FlockRenderer::buildSphere(float _radius, int _precision)
+{
+    const int stacks = _precision < 2 ? 2 : _precision;
+    const int slices = stacks * 2;
+    std::vector <GLfloat> vertices;
+    std::vector <GLuint> indices;
+
+    // a uv sphere, the poles get a full ring of vertices so every ring can be indexed the same way
+    for(int stack=0; stack<=stacks; ++stack)
+    {
+        float theta = stack * (float)M_PI / stacks;
+        for(int slice=0; slice<=slices; ++slice)
+        {
+            float phi = slice * 2.0f * (float)M_PI / slices;
+            float nx = std::sin(theta) * std::cos(phi);
+            float ny = std::cos(theta);
+            float nz = std::sin(theta) * std::sin(phi);
+            vertices.push_back(nx * _radius);
+            vertices.push_back(ny * _radius);
+            vertices.push_back(nz * _radius);
+            vertices.push_back(nx);
+            vertices.push_back(ny);
+            vertices.push_back(nz);
+        }
+    }
+    for(int stack=0; stack<stacks; ++stack)
+    {
+        for(int slice=0; slice<slices; ++slice)
+        {
+            GLuint a = stack * (slices + 1) + slice;
+            GLuint b = a + slices + 1;
+            indices.push_back(a); indices.push_back(b); indices.push_back(a + 1);
+            indices.push_back(a + 1); indices.push_back(b); indices.push_back(b + 1);
+        }
+    }
+    m_indexCount = (GLsizei)indices.size();
+
+    glBindBuffer(GL_ARRAY_BUFFER, m_meshVBO);
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(GLfloat), &vertices[0], GL_STATIC_DRAW);
+    const GLsizei stride = 6 * sizeof(GLfloat);
+    // the same locations the NGL primitives use, 0 is inVert and 2 is inNormal
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (const GLvoid *)0);
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, stride, (const GLvoid *)(3 * sizeof(GLfloat)));
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_indexVBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLuint), &indices[0], GL_STATIC_DRAW);
+}
+//----------------------------------------------------------------------------------------------------------------------
+void FlockRenderer::draw(const FlockState &_frame)
+{
+    const int count = _frame.size();
+    if(count == 0)
+    {
+        return;
+    }
+
+    m_instanceData.resize(count * s_instanceFloats);
+    GLfloat *instance = &m_instanceData[0];
+    for(int i=0; i<count; ++i)
+    {
+        instance[0] = _frame.m_posX[i];
+        instance[1] = _frame.m_posY[i];
+        instance[2] = _frame.m_posZ[i];
+        // the scale replaces the collision size, the same as the second setScale of the Boid::draw this replaced
+        instance[3] = _frame.m_scale[i].m_x;
+        instance[4] = _frame.m_scale[i].m_y;
+        instance[5] = _frame.m_scale[i].m_z;
+        instance[6] = _frame.m_colour[i].m_r;
+        instance[7] = _frame.m_colour[i].m_g;
+        instance[8] = _frame.m_colour[i].m_b;
+        instance[9] = _frame.m_colour[i].m_a;
+        instance += s_instanceFloats;
+    }
+    // the GUI sets the wireframe of the whole flock at once
+    upload(count, _frame.m_wireframe[0]);
+}
+//----------------------------------------------------------------------------------------------------------------------
+void FlockRenderer::draw(const TrajectoryFrame &_frame, const ngl::Vector &_scale, const ngl::Colour &_colour, bool _wireframe)
+{
+    const int count = _frame.m_count;
+    if(count == 0)
+    {
+        return;
+    }
+
+    m_instanceData.resize(count * s_instanceFloats);
+    GLfloat *instance = &m_instanceData[0];
+    for(int i=0; i<count; ++i)
+    {
+        instance[0] = _frame.m_posX[i];
+        instance[1] = _frame.m_posY[i];
+        instance[2] = _frame.m_posZ[i];
+        instance[3] = _scale.m_x;
+        instance[4] = _scale.m_y;
+        instance[5] = _scale.m_z;
+        instance[6] = _colour.m_r;
+        instance[7] = _colour.m_g;
+        instance[8] = _colour.m_b;
+        instance[9] = _colour.m_a;
+        instance += s_instanceFloats;
+    }
+    upload(count, _wireframe);
+}
+//----------------------------------------------------------------------------------------------------------------------
+void FlockRenderer::upload(int _count, bool _wireframe)
+{
+    glBindBuffer(GL_ARRAY_BUFFER, m_instanceVBO);
+    const GLsizeiptr bytes = _count * s_instanceFloats * sizeof(GLfloat);
+    if(_count > m_instanceCapacity)
+    {
+        // grow with some room so a few added boids do not change the size of the buffer every frame
+        m_instanceCapacity = _count + _count / 2;
+    }
+    // orphan the old storage so we never wait on the frame the GPU is still drawing
+    glBufferData(GL_ARRAY_BUFFER, m_instanceCapacity * s_instanceFloats * sizeof(GLfloat), 0, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, &m_instanceData[0]);
+
+    glPolygonMode(GL_FRONT_AND_BACK, _wireframe ? GL_LINE : GL_FILL);
+    glBindVertexArray(m_vao);
+    glDrawElementsInstanced(GL_TRIANGLES, m_indexCount, GL_UNSIGNED_INT, 0, _count);
+    glBindVertexArray(0);
+}
+//----------------------------------------------------------------------------------------------------------------------
+void FlockRenderer::drawFlock(const FlockState &_frame, const std::string &_shaderName, ngl::TransformStack &_transformStack, ngl::Camera *_cam)
+{
+    FLOCK_PROFILE_SCOPE(FLOCK_DRAW);
+    ngl::ShaderLib *shader=ngl::ShaderLib::instance();
+    shader->use(_shaderName);
+    // the diffuse colour comes from every boid, the rest of the material is shared
+    ngl::Material m;
+    m.set(ngl::BLACKPLASTIC);
+    m.loadToShader("material");
+    _transformStack.pushTransform();
+
+    loadMatricesToShader(_transformStack, _cam);
+    draw(_frame);
+
+    _transformStack.popTransform();
+    glPolygonMode(GL_FRONT_AND_BACK,GL_FILL);
+
+}
+//----------------------------------------------------------------------------------------------------------------------
+void FlockRenderer::drawFlock(const TrajectoryFrame &_frame, const FlockState &_look, const std::string &_shaderName, ngl::TransformStack &_transformStack, ngl::Camera *_cam)
+{
+    FLOCK_PROFILE_SCOPE(FLOCK_DRAW);
+    ngl::Vector scale(1.0f, 1.0f, 1.0f);
+    ngl::Colour colour(1.0f, 0.0f, 0.5f, 1.0f);
+    bool wireframe = false;
+    if(_look.size() > 0)
+    {
+        scale = _look.m_scale[0];
+        colour = _look.m_colour[0];
+        wireframe = _look.m_wireframe[0];
+    }
+    ngl::ShaderLib *shader=ngl::ShaderLib::instance();
+    shader->use(_shaderName);
+    ngl::Material m;
+    m.set(ngl::BLACKPLASTIC);
+    m.loadToShader("material");
+    _transformStack.pushTransform();
+
+    loadMatricesToShader(_transformStack, _cam);
+    draw(_frame, scale, colour, wireframe);
+
+    _transformStack.popTransform();
+    glPolygonMode(GL_FRONT_AND_BACK,GL_FILL);
+}
+//----------------------------------------------------------------------------------------------------------------------
+void FlockRenderer::loadMatricesToShader(ngl::TransformStack &_tx, ngl::Camera *_cam)
+
+{
+    ngl::ShaderLib *shader = ngl::ShaderLib::instance();
+    ngl::Matrix MV;
+    ngl::Matrix MVP;
+    ngl::Mat3x3 normalMatrix;
+    ngl::Matrix M;
+
+    M = _tx.getCurrentTransform().getMatrix();
+    MV = _tx.getCurrAndGlobal().getMatrix() *_cam->getViewMatrix();
+    MVP = MV * _cam->getProjectionMatrix();
+    normalMatrix = MV;
+    normalMatrix.inverse();
+    shader->setShaderParamFromMatrix("MV", MV);
+    shader->setShaderParamFromMatrix("MVP", MVP);
+    shader->setShaderParamFromMat3x3("normalMatrix", normalMatrix);
+    shader->setShaderParamFromMatrix("M", M);
+
+}
+//----------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,133 @@
+#include "FlockSim.h"
+#include "flock.h"
+#include <algorithm>
+
+// the enums of the header mirror the ones of the flock so they are passed on as they are
+static_assert((int)FlockSim::METRIC == (int)Flock::METRIC && (int)FlockSim::TOPOLOGICAL == (int)Flock::TOPOLOGICAL &&
+              (int)FlockSim::APPROXIMATE == (int)Flock::APPROXIMATE, "FlockSim::NeighbourMode is out of step with Flock");
+static_assert((int)FlockSim::REFLECT == (int)Boundary::REFLECT && (int)FlockSim::CLAMP == (int)Boundary::CLAMP &&
+              (int)FlockSim::WRAP == (int)Boundary::WRAP, "FlockSim::BoundaryMode is out of step with Boundary");
+
+//----------------------------------------------------------------------------------------------------------------------
+FlockSim::FlockSim(float _width, float _height, float _depth, int _boids, uint64_t _seed, int _threads, float _spawnSpeed)
+{
+    // the pool is made with its final size, a sweep running a flock per worker never starts a full pool
+    m_flock = new Flock(_width, _height, _depth, 0, _threads);
+    m_spawnSpeed = _spawnSpeed;
+    m_flock->setSeed(_seed);
+    m_flock->setFlockSize(std::max(0, _boids));
+    m_flock->resetBoids(spawnDistribution());
+}
+//----------------------------------------------------------------------------------------------------------------------
+FlockSim::~FlockSim()
+{
+    delete m_flock;
+}
+//----------------------------------------------------------------------------------------------------------------------
+void FlockSim::step(int _steps)
+{
+    for(int i=0; i<_steps; ++i)
+    {
+        m_flock->update();
+    }
+}
+//----------------------------------------------------------------------------------------------------------------------
+FlockSim::State FlockSim::getState() const
+{
+    const FlockState &state = m_flock->getState();
+    State view;
+    view.m_count = state.size();
+    view.m_posX = state.m_posX.data();
+    view.m_posY = state.m_posY.data();
+    view.m_posZ = state.m_posZ.data();
+    view.m_velX = state.m_velX.data();
+    view.m_velY = state.m_velY.data();
+    view.m_velZ = state.m_velZ.data();
+    return view;
+}
+//----------------------------------------------------------------------------------------------------------------------
+void FlockSim::setBoid(int _index, float _x, float _y, float _z, float _vx, float _vy, float _vz)
+{
+    FlockState &state = m_flock->getState();
+    state.setPosition(_index, ngl::Vector(_x, _y, _z));
+    state.setVelocity(_index, ngl::Vector(_vx, _vy, _vz));
+}
+//----------------------------------------------------------------------------------------------------------------------
+SpawnDistribution FlockSim::spawnDistribution() const
+{
+    SpawnDistribution distribution;
+    distribution.m_speed = m_spawnSpeed;
+    return distribution;
+}
+//----------------------------------------------------------------------------------------------------------------------
+void FlockSim::spawn(int _count)
+{
+    m_flock->spawn(_count, spawnDistribution());
+}
+//----------------------------------------------------------------------------------------------------------------------
+void FlockSim::despawn(int _count)
+{
+    m_flock->despawn(_count);
+}
+//----------------------------------------------------------------------------------------------------------------------
+void FlockSim::reset(uint64_t _seed)
+{
+    m_flock->setSeed(_seed);
+    m_flock->setFlockSize(m_flock->getState().size());
+    m_flock->resetBoids(spawnDistribution());
+}
+//----------------------------------------------------------------------------------------------------------------------
+void FlockSim::setParameters(const Parameters &_parameters)
+{
+    const Parameters current = getParameters();
+    m_flock->setSimDistance(_parameters.m_behaviourDistance);
+    m_flock->setSimFlockDistance(_parameters.m_flockDistance);
+    m_flock->setSimCohesion(_parameters.m_cohesion);
+    m_flock->setSimSeparation(_parameters.m_separation);
+    m_flock->setSimAlignment(_parameters.m_alignment);
+    // both throw the neighbour lists away, so a caller setting the same parameters every step keeps them
+    if(_parameters.m_neighbourMode != current.m_neighbourMode)
+    {
+        m_flock->setNeighbourMode((Flock::NeighbourMode)_parameters.m_neighbourMode);
+    }
+    if(_parameters.m_neighbourSkin != current.m_neighbourSkin)
+    {
+        m_flock->setNeighbourSkin(_parameters.m_neighbourSkin);
+    }
+    m_flock->setTopologicalCount(_parameters.m_topologicalCount);
+    m_flock->setOpeningAngle(_parameters.m_openingAngle);
+    m_flock->setBoundaryMode((Boundary::Mode)_parameters.m_boundary);
+}
+//----------------------------------------------------------------------------------------------------------------------
+FlockSim::Parameters FlockSim::getParameters() const
+{
+    const Behaviours &behaviours = m_flock->getBehaviours();
+    Parameters parameters;
+    parameters.m_behaviourDistance = behaviours.getBehaviourDistance();
+    parameters.m_flockDistance = behaviours.getFlockDistance();
+    parameters.m_cohesion = behaviours.getCohesionForce();
+    parameters.m_separation = behaviours.getSeparationForce();
+    parameters.m_alignment = behaviours.getAlignment();
+    parameters.m_neighbourMode = (NeighbourMode)m_flock->getNeighbourMode();
+    parameters.m_topologicalCount = m_flock->getTopologicalCount();
+    parameters.m_openingAngle = m_flock->getOpeningAngle();
+    parameters.m_neighbourSkin = m_flock->getNeighbourSkin();
+    parameters.m_boundary = (BoundaryMode)m_flock->getBoundaryMode();
+    return parameters;
+}
+//----------------------------------------------------------------------------------------------------------------------
+int FlockSim::addObstacle(float _x, float _y, float _z, float _radius)
+{
+    return m_flock->getObstacles().add(ngl::Vector(_x, _y, _z), _radius);
+}
+//----------------------------------------------------------------------------------------------------------------------
+bool FlockSim::saveSnapshot(const std::string &_file) const
+{
+    return m_flock->saveSnapshot(_file);
+}
+//----------------------------------------------------------------------------------------------------------------------
+bool FlockSim::loadSnapshot(const std::string &_file)
+{
+    return m_flock->loadSnapshot(_file);
+}
+//----------------------------------------------------------------------------------------------------------------------
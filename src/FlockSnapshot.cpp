@@ -0,0 +1,278 @@
+#include "flock.h"
+#include "MappedFile.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <cstring>
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the boids converted at a time when the scale and colour are written
+const static int s_saveBatch = 65536;
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief writes the zeros up to the next section, clears _good on a failed write
+static void writePadding(FILE *_file, uint64_t &_offset, bool &_good)
+{
+    static const char zeros[64] = {0};
+    uint64_t padding = FlockSnapshot::align(_offset) - _offset;
+    if(padding > 0 && std::fwrite(zeros, 1, padding, _file) != padding)
+    {
+        _good = false;
+    }
+    _offset += padding;
+}
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief writes _bytes and the padding after them
+static void writeSection(FILE *_file, const void *_data, uint64_t _bytes, uint64_t &_offset, bool &_good)
+{
+    if(_bytes > 0 && std::fwrite(_data, 1, _bytes, _file) != _bytes)
+    {
+        _good = false;
+    }
+    _offset += _bytes;
+    writePadding(_file, _offset, _good);
+}
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the size of a file with _boids boids and _obstacles obstacles
+static uint64_t snapshotBytes(uint64_t _boids, uint64_t _obstacles)
+{
+    uint64_t bytes = FlockSnapshot::align(sizeof(SnapshotHeader));
+    bytes += FlockSnapshot::s_obstacleFloatArrays * FlockSnapshot::align(_obstacles * sizeof(float));
+    bytes += FlockSnapshot::s_boidFloatArrays * FlockSnapshot::align(_boids * sizeof(float));
+    bytes += 2 * FlockSnapshot::align(_boids);
+    return bytes;
+}
+//----------------------------------------------------------------------------------------------------------------------
+bool Flock::saveSnapshot(const std::string &_file) const
+{
+    const uint64_t count = m_state.size();
+    // the obstacle of the ctor is saved in the settings, the set only holds a copy of it
+    std::vector <int> extra;
+    for(int i=0; i<m_obstacles.size(); ++i)
+    {
+        if(i != m_obstacleId)
+        {
+            extra.push_back(i);
+        }
+    }
+
+    SnapshotHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.m_magic, "FSNP", 4);
+    header.m_version = FlockSnapshot::s_version;
+    header.m_boids = count;
+    header.m_obstacles = extra.size();
+    header.m_bytes = snapshotBytes(count, extra.size());
+    SnapshotSettings &settings = header.m_settings;
+    settings.m_behaviourDistance = m_behaviours[0].getBehaviourDistance();
+    settings.m_flockDistance = m_behaviours[0].getFlockDistance();
+    settings.m_cohesion = m_behaviours[0].getCohesionForce();
+    settings.m_separation = m_behaviours[0].getSeparationForce();
+    settings.m_alignment = m_behaviours[0].getAlignment();
+    settings.m_minVelocity = m_state.m_minVelocity;
+    settings.m_maxVelocity = m_state.m_maxVelocity;
+    settings.m_boxWidth = 2.0f * m_boundary.m_extents[2];
+    settings.m_boxHeight = 2.0f * m_boundary.m_extents[0];
+    settings.m_boxDepth = 2.0f * m_boundary.m_extents[4];
+    settings.m_boundaryMode = m_boundary.m_mode;
+    if(m_obstacle != 0)
+    {
+        settings.m_obstacleX = m_obstacle->getSpherePosition().m_x;
+        settings.m_obstacleY = m_obstacle->getSpherePosition().m_y;
+        settings.m_obstacleZ = m_obstacle->getSpherePosition().m_z;
+        settings.m_obstacleRadius = m_obstacle->getSphereRadius();
+        settings.m_hasObstacle = 1;
+    }
+    settings.m_neighbourMode = m_neighbourMode;
+    settings.m_topologicalCount = m_topologicalCount;
+    settings.m_openingAngle = m_openingAngle;
+    settings.m_neighbourSkin = m_neighbourSkin;
+    settings.m_rngCounter = m_rngCounter;
+
+    std::string temporary = _file + ".tmp";
+    FILE *file = std::fopen(temporary.c_str(), "wb");
+    if(file == 0)
+    {
+        return false;
+    }
+    bool good = true;
+    uint64_t offset = 0;
+    writeSection(file, &header, sizeof(header), offset, good);
+
+    std::vector <float> values(extra.size());
+    for(int a=0; a<FlockSnapshot::s_obstacleFloatArrays; ++a)
+    {
+        for(unsigned int i=0; i<extra.size(); ++i)
+        {
+            ngl::Vector centre = m_obstacles.getCentre(extra[i]);
+            values[i] = a == 0 ? centre.m_x : (a == 1 ? centre.m_y : (a == 2 ? centre.m_z : m_obstacles.getRadius(extra[i])));
+        }
+        writeSection(file, values.empty() ? 0 : &values[0], values.size() * sizeof(float), offset, good);
+    }
+
+    const FloatArray *arrays[13] = {&m_state.m_posX, &m_state.m_posY, &m_state.m_posZ, &m_state.m_velX, &m_state.m_velY,
+                                    &m_state.m_velZ, &m_state.m_lastX, &m_state.m_lastY, &m_state.m_lastZ,
+                                    &m_state.m_newDirX, &m_state.m_newDirY, &m_state.m_newDirZ, &m_state.m_size};
+    for(int a=0; a<13; ++a)
+    {
+        writeSection(file, count > 0 ? &(*arrays[a])[0] : 0, count * sizeof(float), offset, good);
+    }
+    // the scale and colour are ngl types, they are written one component at a time through a small buffer
+    values.resize(s_saveBatch);
+    for(int a=0; a<7; ++a)
+    {
+        for(uint64_t begin=0; begin<count; begin+=s_saveBatch)
+        {
+            uint64_t end = std::min(count, begin + s_saveBatch);
+            for(uint64_t i=begin; i<end; ++i)
+            {
+                const ngl::Vector &scale = m_state.m_scale[i];
+                const ngl::Colour &colour = m_state.m_colour[i];
+                const float components[7] = {scale.m_x, scale.m_y, scale.m_z, colour.m_r, colour.m_g, colour.m_b, colour.m_a};
+                values[i - begin] = components[a];
+            }
+            if(std::fwrite(&values[0], sizeof(float), end - begin, file) != end - begin)
+            {
+                good = false;
+            }
+        }
+        offset += count * sizeof(float);
+        writePadding(file, offset, good);
+    }
+    writeSection(file, count > 0 ? &m_state.m_hit[0] : 0, count, offset, good);
+    writeSection(file, count > 0 ? &m_state.m_wireframe[0] : 0, count, offset, good);
+
+    good = std::fclose(file) == 0 && good && offset == header.m_bytes;
+    if(!good || std::rename(temporary.c_str(), _file.c_str()) != 0)
+    {
+        std::remove(temporary.c_str());
+        return false;
+    }
+    return true;
+}
+//----------------------------------------------------------------------------------------------------------------------
+bool Flock::readSnapshotHeader(const std::string &_file, SnapshotHeader &_header)
+{
+    SnapshotHeader header;
+    FILE *file = std::fopen(_file.c_str(), "rb");
+    if(file == 0)
+    {
+        return false;
+    }
+    bool read = std::fread(&header, sizeof(header), 1, file) == 1;
+    std::fclose(file);
+    if(!read || std::memcmp(header.m_magic, "FSNP", 4) != 0 || header.m_version != FlockSnapshot::s_version)
+    {
+        return false;
+    }
+    _header = header;
+    return true;
+}
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief true for a size read from a snapshot that is finite and not negative
+static bool isSize(float _size)
+{
+    return std::isfinite(_size) && _size >= 0.0f;
+}
+//----------------------------------------------------------------------------------------------------------------------
+bool Flock::loadSnapshot(const std::string &_file)
+{
+    // the whole file is read straight away, so it is faulted in up front
+    MappedFile file;
+    if(!file.open(_file, true) || file.size() < sizeof(SnapshotHeader))
+    {
+        return false;
+    }
+    const uint64_t bytes = file.size();
+    const char *data = file.data();
+
+    SnapshotHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    bool valid = std::memcmp(header.m_magic, "FSNP", 4) == 0 && header.m_version == FlockSnapshot::s_version &&
+                 header.m_boids <= (uint64_t)std::numeric_limits<int>::max() && header.m_bytes == bytes &&
+                 snapshotBytes(header.m_boids, header.m_obstacles) == bytes;
+    // the modes index the steering passes and the sizes shape the box, a damaged file is turned away here
+    // before any state is touched
+    const SnapshotSettings &checked = header.m_settings;
+    valid = valid && checked.m_boundaryMode >= Boundary::REFLECT && checked.m_boundaryMode <= Boundary::WRAP &&
+            checked.m_neighbourMode >= METRIC && checked.m_neighbourMode <= APPROXIMATE &&
+            isSize(checked.m_boxWidth) && isSize(checked.m_boxHeight) && isSize(checked.m_boxDepth) &&
+            isSize(checked.m_obstacleRadius);
+    if(valid)
+    {
+        const int count = (int)header.m_boids;
+        const SnapshotSettings &settings = header.m_settings;
+        uint64_t offset = FlockSnapshot::align(sizeof(header));
+
+        const float *obstacles[FlockSnapshot::s_obstacleFloatArrays];
+        for(int a=0; a<FlockSnapshot::s_obstacleFloatArrays; ++a)
+        {
+            obstacles[a] = (const float *)(data + offset);
+            offset += FlockSnapshot::align(header.m_obstacles * sizeof(float));
+        }
+        const float *floats[FlockSnapshot::s_boidFloatArrays];
+        for(int a=0; a<FlockSnapshot::s_boidFloatArrays; ++a)
+        {
+            floats[a] = (const float *)(data + offset);
+            offset += FlockSnapshot::align(count * sizeof(float));
+        }
+        const char *hit = data + offset;
+        const char *wireframe = hit + FlockSnapshot::align(count);
+
+        // assign copies straight from the mapping without filling the arrays first
+        FloatArray *arrays[13] = {&m_state.m_posX, &m_state.m_posY, &m_state.m_posZ, &m_state.m_velX, &m_state.m_velY,
+                                  &m_state.m_velZ, &m_state.m_lastX, &m_state.m_lastY, &m_state.m_lastZ,
+                                  &m_state.m_newDirX, &m_state.m_newDirY, &m_state.m_newDirZ, &m_state.m_size};
+        for(int a=0; a<13; ++a)
+        {
+            arrays[a]->assign(floats[a], floats[a] + count);
+        }
+        m_state.m_hit.assign(hit, hit + count);
+        m_state.m_wireframe.assign(wireframe, wireframe + count);
+        m_state.m_scale.resize(count);
+        m_state.m_colour.resize(count);
+        m_pool->parallelFor(count, 65536, [&](int _begin, int _end, int)
+        {
+            for(int i=_begin; i<_end; ++i)
+            {
+                m_state.m_scale[i].set(floats[13][i], floats[14][i], floats[15][i]);
+                m_state.m_colour[i].set(floats[16][i], floats[17][i], floats[18][i], floats[19][i]);
+            }
+        });
+        m_state.m_minVelocity = settings.m_minVelocity;
+        m_state.m_maxVelocity = settings.m_maxVelocity;
+        m_numberOfBoids = count;
+        m_rngCounter = settings.m_rngCounter;
+
+        setSimDistance(settings.m_behaviourDistance);
+        setSimFlockDistance(settings.m_flockDistance);
+        setSimCohesion(settings.m_cohesion);
+        setSimSeparation(settings.m_separation);
+        setSimAlignment(settings.m_alignment);
+        setBoxSize(settings.m_boxWidth, settings.m_boxHeight, settings.m_boxDepth);
+        setBoundaryMode((Boundary::Mode)settings.m_boundaryMode);
+        setTopologicalCount(settings.m_topologicalCount);
+        setOpeningAngle(settings.m_openingAngle);
+        m_neighbourMode = (NeighbourMode)settings.m_neighbourMode;
+        m_neighbourSkin = std::max(0.0f, settings.m_neighbourSkin);
+        m_neighbourList.invalidate();
+
+        m_obstacles.clear();
+        m_obstacleId = -1;
+        if(m_obstacle != 0)
+        {
+            if(settings.m_hasObstacle)
+            {
+                m_obstacle->setSpherePosition(ngl::Vector(settings.m_obstacleX, settings.m_obstacleY, settings.m_obstacleZ));
+                m_obstacle->setSphereRadius(settings.m_obstacleRadius);
+            }
+            m_obstacleId = m_obstacles.add(m_obstacle->getSpherePosition(), m_obstacle->getSphereRadius());
+        }
+        for(uint64_t i=0; i<header.m_obstacles; ++i)
+        {
+            m_obstacles.add(ngl::Vector(obstacles[0][i], obstacles[1][i], obstacles[2][i]), obstacles[3][i]);
+        }
+    }
+    return valid;
+}
+//----------------------------------------------------------------------------------------------------------------------
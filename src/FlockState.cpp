@@ -0,0 +1,343 @@
+#include "FlockState.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <new>
+
+#if defined(__SSE2__)
+    #define FLOCK_SSE 1
+    #include <emmintrin.h>
+#endif
+
+FlockState::FlockState()
+{
+    m_maxVelocity = 0.9;
+    m_minVelocity = 0.3;
+}
+//----------------------------------------------------------------------------------------------------------------------
+void FlockState::reserve(int _count)
+{
+    m_posX.reserve(_count); m_posY.reserve(_count); m_posZ.reserve(_count);
+    m_velX.reserve(_count); m_velY.reserve(_count); m_velZ.reserve(_count);
+    m_lastX.reserve(_count); m_lastY.reserve(_count); m_lastZ.reserve(_count);
+    m_newDirX.reserve(_count); m_newDirY.reserve(_count); m_newDirZ.reserve(_count);
+    m_size.reserve(_count);
+    m_hit.reserve(_count);
+    m_scale.reserve(_count);
+    m_colour.reserve(_count);
+    m_wireframe.reserve(_count);
+}
+//----------------------------------------------------------------------------------------------------------------------
+void FlockState::addBoid(const ngl::Vector &_position)
+{
+    setPosition(addBoids(1), _position);
+}
+//----------------------------------------------------------------------------------------------------------------------
+int FlockState::addBoids(int _count)
+{
+    int first = size();
+    int count = first + std::max(0, std::min(_count, std::numeric_limits<int>::max() - first));
+    try
+    {
+        m_posX.resize(count, 0.0f); m_posY.resize(count, 0.0f); m_posZ.resize(count, 0.0f);
+        m_velX.resize(count, 8.0f); m_velY.resize(count, 8.0f); m_velZ.resize(count, 0.0f);
+        m_lastX.resize(count, 0.0f); m_lastY.resize(count, 0.0f); m_lastZ.resize(count, 0.0f);
+        m_newDirX.resize(count, 0.0f); m_newDirY.resize(count, 0.0f); m_newDirZ.resize(count, 0.0f);
+        m_size.resize(count, 1.0f);
+        m_hit.resize(count, false);
+        m_scale.resize(count, ngl::Vector(1.0f, 1.0f, 1.0f));
+        m_colour.resize(count, ngl::Colour(1.0f, 0.0f, 0.5f, 1.0f));
+        m_wireframe.resize(count, false);
+    }
+    catch(const std::bad_alloc &)
+    {
+        // the arrays that already grew are cut back so every array keeps the same size, shrinking never throws
+        m_posX.resize(first); m_posY.resize(first); m_posZ.resize(first);
+        m_velX.resize(first); m_velY.resize(first); m_velZ.resize(first);
+        m_lastX.resize(first); m_lastY.resize(first); m_lastZ.resize(first);
+        m_newDirX.resize(first); m_newDirY.resize(first); m_newDirZ.resize(first);
+        m_size.resize(first);
+        m_hit.resize(first);
+        m_scale.resize(first);
+        m_colour.resize(first);
+        m_wireframe.resize(first);
+        throw;
+    }
+    return first;
+}
+//----------------------------------------------------------------------------------------------------------------------
+void FlockState::removeLast(int _count)
+{
+    int count = std::max(0, size() - _count);
+    m_posX.resize(count); m_posY.resize(count); m_posZ.resize(count);
+    m_velX.resize(count); m_velY.resize(count); m_velZ.resize(count);
+    m_lastX.resize(count); m_lastY.resize(count); m_lastZ.resize(count);
+    m_newDirX.resize(count); m_newDirY.resize(count); m_newDirZ.resize(count);
+    m_size.resize(count);
+    m_hit.resize(count);
+    m_scale.resize(count);
+    m_colour.resize(count);
+    m_wireframe.resize(count);
+}
+//----------------------------------------------------------------------------------------------------------------------
+void FlockState::swapRemove(int _i)
+{
+    int last = size() - 1;
+    m_posX[_i] = m_posX[last]; m_posY[_i] = m_posY[last]; m_posZ[_i] = m_posZ[last];
+    m_velX[_i] = m_velX[last]; m_velY[_i] = m_velY[last]; m_velZ[_i] = m_velZ[last];
+    m_lastX[_i] = m_lastX[last]; m_lastY[_i] = m_lastY[last]; m_lastZ[_i] = m_lastZ[last];
+    m_newDirX[_i] = m_newDirX[last]; m_newDirY[_i] = m_newDirY[last]; m_newDirZ[_i] = m_newDirZ[last];
+    m_size[_i] = m_size[last];
+    m_hit[_i] = m_hit[last];
+    m_scale[_i] = m_scale[last];
+    m_colour[_i] = m_colour[last];
+    m_wireframe[_i] = m_wireframe[last];
+    removeLast(1);
+}
+//----------------------------------------------------------------------------------------------------------------------
+void FlockState::clear()
+{
+    m_posX.clear(); m_posY.clear(); m_posZ.clear();
+    m_velX.clear(); m_velY.clear(); m_velZ.clear();
+    m_lastX.clear(); m_lastY.clear(); m_lastZ.clear();
+    m_newDirX.clear(); m_newDirY.clear(); m_newDirZ.clear();
+    m_size.clear();
+    m_hit.clear();
+    m_scale.clear();
+    m_colour.clear();
+    m_wireframe.clear();
+}
+//----------------------------------------------------------------------------------------------------------------------
+void FlockState::integrate(int _i, const ngl::Vector &_steering, FlockState &_next) const
+{
+    float vx = m_velX[_i] + _steering.m_x;
+    float vy = m_velY[_i] + _steering.m_y;
+    float vz = m_velZ[_i] + _steering.m_z;
+
+    // velocity constraint, a boid going too fast is brought back to the maximum speed
+    // and a boid going too slow is slowed down by the minimum speed
+    float speed = std::sqrt(vx * vx + vy * vy + vz * vz);
+    if(speed > m_maxVelocity)
+    {
+        vx = vx / speed * m_maxVelocity;
+        vy = vy / speed * m_maxVelocity;
+        vz = vz / speed * m_maxVelocity;
+        speed = m_maxVelocity;
+    }
+    if(speed < m_minVelocity)
+    {
+        vx *= m_minVelocity;
+        vy *= m_minVelocity;
+        vz *= m_minVelocity;
+    }
+    _next.m_velX[_i] = vx;
+    _next.m_velY[_i] = vy;
+    _next.m_velZ[_i] = vz;
+
+    // boid direction, the movement since the last integration carries on with the velocity
+    float dx = m_posX[_i] - m_lastX[_i];
+    float dy = m_posY[_i] - m_lastY[_i];
+    float dz = m_posZ[_i] - m_lastZ[_i];
+    _next.m_newDirX[_i] = dx;
+    _next.m_newDirY[_i] = dy;
+    _next.m_newDirZ[_i] = dz;
+    float px = m_posX[_i] + (vx + dx) * 2.2f;
+    float py = m_posY[_i] + (vy + dy) * 2.2f;
+    float pz = m_posZ[_i] + (vz + dz) * 2.2f;
+    _next.m_posX[_i] = px;
+    _next.m_posY[_i] = py;
+    _next.m_posZ[_i] = pz;
+    _next.m_lastX[_i] = px;
+    _next.m_lastY[_i] = py;
+    _next.m_lastZ[_i] = pz;
+}
+//----------------------------------------------------------------------------------------------------------------------
+/// The following section is modified from :-
+/// John Macey(2011).Collisions Example, BoundingBox. [Accessed 2012]
+/// Available from: bzr branch http://nccastaff.bournemouth.ac.uk/jmacey/Code/Collisions
+/// @brief bounces the boids [_begin, _end) off the planes of the box. The planes are tested in order and a
+/// later plane works on the velocity an earlier one left, the same as the separate bounding box pass did.
+static void reflect(int _begin, int _end, const Boundary &_boundary, const float *_size,
+                    const float *_px, const float *_py, const float *_pz, float *_vx, float *_vy, float *_vz)
+{
+    const ngl::Vector *normals = _boundary.m_normals;
+    const float *ext = _boundary.m_extents;
+    int s = _begin;
+#ifdef FLOCK_SSE
+    __m128 nx[6], ny[6], nz[6], negNx[6], negNy[6], negNz[6], extent[6];
+    for(int i=0; i<6; ++i)
+    {
+        nx[i] = _mm_set1_ps(normals[i].m_x);
+        ny[i] = _mm_set1_ps(normals[i].m_y);
+        nz[i] = _mm_set1_ps(normals[i].m_z);
+        negNx[i] = _mm_set1_ps(-normals[i].m_x);
+        negNy[i] = _mm_set1_ps(-normals[i].m_y);
+        negNz[i] = _mm_set1_ps(-normals[i].m_z);
+        extent[i] = _mm_set1_ps(ext[i]);
+    }
+    const __m128 two = _mm_set1_ps(2.0f);
+    const __m128 five = _mm_set1_ps(5.0f);
+    for(; s + 4 <= _end; s += 4)
+    {
+        __m128 px = _mm_loadu_ps(_px + s);
+        __m128 py = _mm_loadu_ps(_py + s);
+        __m128 pz = _mm_loadu_ps(_pz + s);
+        __m128 size = _mm_loadu_ps(_size + s);
+        __m128 vx = _mm_loadu_ps(_vx + s);
+        __m128 vy = _mm_loadu_ps(_vy + s);
+        __m128 vz = _mm_loadu_ps(_vz + s);
+        for(int i=0; i<6; ++i)
+        {
+            // the distance of the sphere from the plane against the extent, the hit lanes take the new direction
+            __m128 distance = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(nx[i], px), _mm_mul_ps(ny[i], py)), _mm_mul_ps(nz[i], pz)), size);
+            __m128 hit = _mm_cmpge_ps(distance, extent[i]);
+            __m128 x = _mm_mul_ps(two, _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx[i], vx), _mm_mul_ps(ny[i], vy)), _mm_mul_ps(nz[i], vz)));
+            vx = _mm_or_ps(_mm_and_ps(hit, _mm_mul_ps(_mm_mul_ps(negNx[i], x), five)), _mm_andnot_ps(hit, vx));
+            vy = _mm_or_ps(_mm_and_ps(hit, _mm_mul_ps(_mm_mul_ps(negNy[i], x), five)), _mm_andnot_ps(hit, vy));
+            vz = _mm_or_ps(_mm_and_ps(hit, _mm_mul_ps(_mm_mul_ps(negNz[i], x), five)), _mm_andnot_ps(hit, vz));
+        }
+        _mm_storeu_ps(_vx + s, vx);
+        _mm_storeu_ps(_vy + s, vy);
+        _mm_storeu_ps(_vz + s, vz);
+    }
+#endif
+    for(; s<_end; ++s)
+    {
+        for(int i=0; i<6; ++i)
+        {
+            //to calculate the distance we take the dotporduct of the Plane Normal
+            //with the new point P and add the Radius of the sphere
+            float Distance = normals[i].m_x * _px[s] + normals[i].m_y * _py[s] + normals[i].m_z * _pz[s];
+            Distance+=_size[s];
+            bool hit = Distance >= ext[i];
+            //We use the same calculation as in raytracing to determine the new direction
+            float x= 2*( normals[i].m_x * _vx[s] + normals[i].m_y * _vy[s] + normals[i].m_z * _vz[s]);
+            _vx[s] = hit ? -normals[i].m_x * x * 5.0f : _vx[s];
+            _vy[s] = hit ? -normals[i].m_y * x * 5.0f : _vy[s];
+            _vz[s] = hit ? -normals[i].m_z * x * 5.0f : _vz[s];
+        }
+    }
+}
+/// end of Citation
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief keeps the boids [_begin, _end) inside [_lo, _hi] along one axis, moving the last position with them.
+/// CLAMP stops a boid on the inside of the planes and drops the velocity taking it out, WRAP moves a boid that
+/// left through one plane in by the width of the box from the opposite one.
+template <Boundary::Mode Mode>
+static void constrainAxis(int _begin, int _end, float _lo, float _hi, const float *_size,
+                          float *_p, float *_last, float *_v)
+{
+    const float span = _hi - _lo;
+    int s = _begin;
+#ifdef FLOCK_SSE
+    const __m128 lo = _mm_set1_ps(_lo);
+    const __m128 hi = _mm_set1_ps(_hi);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 spanV = _mm_set1_ps(span);
+    const __m128 invSpan = _mm_set1_ps(1.0f / span);
+    for(; s + 4 <= _end; s += 4)
+    {
+        __m128 p = _mm_loadu_ps(_p + s);
+        __m128 moved;
+        if(Mode == Boundary::CLAMP)
+        {
+            __m128 size = _mm_loadu_ps(_size + s);
+            __m128 low = _mm_add_ps(lo, size);
+            __m128 high = _mm_sub_ps(hi, size);
+            __m128 v = _mm_loadu_ps(_v + s);
+            v = _mm_or_ps(_mm_and_ps(_mm_cmpgt_ps(p, high), _mm_min_ps(v, zero)), _mm_andnot_ps(_mm_cmpgt_ps(p, high), v));
+            v = _mm_or_ps(_mm_and_ps(_mm_cmplt_ps(p, low), _mm_max_ps(v, zero)), _mm_andnot_ps(_mm_cmplt_ps(p, low), v));
+            _mm_storeu_ps(_v + s, v);
+            moved = _mm_min_ps(_mm_max_ps(p, low), high);
+        }
+        else
+        {
+            // floor by truncating and stepping down where the truncation went up, SSE2 has no floor
+            __m128 t = _mm_mul_ps(_mm_sub_ps(p, lo), invSpan);
+            __m128 truncated = _mm_cvtepi32_ps(_mm_cvttps_epi32(t));
+            __m128 floored = _mm_sub_ps(truncated, _mm_and_ps(_mm_cmpgt_ps(truncated, t), one));
+            moved = _mm_sub_ps(p, _mm_mul_ps(spanV, floored));
+        }
+        _mm_storeu_ps(_last + s, _mm_add_ps(_mm_loadu_ps(_last + s), _mm_sub_ps(moved, p)));
+        _mm_storeu_ps(_p + s, moved);
+    }
+#endif
+    for(; s<_end; ++s)
+    {
+        float p = _p[s];
+        float moved;
+        if(Mode == Boundary::CLAMP)
+        {
+            float low = _lo + _size[s];
+            float high = _hi - _size[s];
+            _v[s] = p > high ? std::min(_v[s], 0.0f) : _v[s];
+            _v[s] = p < low ? std::max(_v[s], 0.0f) : _v[s];
+            moved = std::min(std::max(p, low), high);
+        }
+        else
+        {
+            moved = p - span * std::floor((p - _lo) / span);
+        }
+        _last[s] += moved - p;
+        _p[s] = moved;
+    }
+}
+//----------------------------------------------------------------------------------------------------------------------
+template <Boundary::Mode Mode>
+void FlockState::constrain(int _begin, int _end, const Boundary &_boundary, FlockState &_next) const
+{
+    const float *ext = _boundary.m_extents;
+    if(Mode == Boundary::REFLECT)
+    {
+        reflect(_begin, _end, _boundary, &m_size[0], &_next.m_posX[0], &_next.m_posY[0], &_next.m_posZ[0],
+                &_next.m_velX[0], &_next.m_velY[0], &_next.m_velZ[0]);
+        return;
+    }
+    // the planes come in pairs along y, x and z
+    constrainAxis<Mode>(_begin, _end, -ext[1], ext[0], &m_size[0], &_next.m_posY[0], &_next.m_lastY[0], &_next.m_velY[0]);
+    constrainAxis<Mode>(_begin, _end, -ext[3], ext[2], &m_size[0], &_next.m_posX[0], &_next.m_lastX[0], &_next.m_velX[0]);
+    constrainAxis<Mode>(_begin, _end, -ext[5], ext[4], &m_size[0], &_next.m_posZ[0], &_next.m_lastZ[0], &_next.m_velZ[0]);
+}
+template void FlockState::constrain<Boundary::REFLECT>(int, int, const Boundary &, FlockState &) const;
+template void FlockState::constrain<Boundary::CLAMP>(int, int, const Boundary &, FlockState &) const;
+template void FlockState::constrain<Boundary::WRAP>(int, int, const Boundary &, FlockState &) const;
+//----------------------------------------------------------------------------------------------------------------------
+void FlockState::constrain(int _begin, int _end, const Boundary &_boundary, FlockState &_next) const
+{
+    switch(_boundary.m_mode)
+    {
+        case Boundary::CLAMP : constrain<Boundary::CLAMP>(_begin, _end, _boundary, _next); break;
+        case Boundary::WRAP : constrain<Boundary::WRAP>(_begin, _end, _boundary, _next); break;
+        default : constrain<Boundary::REFLECT>(_begin, _end, _boundary, _next); break;
+    }
+}
+//----------------------------------------------------------------------------------------------------------------------
+void FlockState::resizeMotion(int _count)
+{
+    m_posX.resize(_count); m_posY.resize(_count); m_posZ.resize(_count);
+    m_velX.resize(_count); m_velY.resize(_count); m_velZ.resize(_count);
+    m_lastX.resize(_count); m_lastY.resize(_count); m_lastZ.resize(_count);
+    m_newDirX.resize(_count); m_newDirY.resize(_count); m_newDirZ.resize(_count);
+}
+//----------------------------------------------------------------------------------------------------------------------
+void FlockState::swapMotion(FlockState &_next)
+{
+    m_posX.swap(_next.m_posX); m_posY.swap(_next.m_posY); m_posZ.swap(_next.m_posZ);
+    m_velX.swap(_next.m_velX); m_velY.swap(_next.m_velY); m_velZ.swap(_next.m_velZ);
+    m_lastX.swap(_next.m_lastX); m_lastY.swap(_next.m_lastY); m_lastZ.swap(_next.m_lastZ);
+    m_newDirX.swap(_next.m_newDirX); m_newDirY.swap(_next.m_newDirY); m_newDirZ.swap(_next.m_newDirZ);
+}
+//----------------------------------------------------------------------------------------------------------------------
+void FlockState::copyDrawData(const FlockState &_source)
+{
+    // assign reuses the memory of the frame, after the first few frames nothing is allocated
+    m_posX.assign(_source.m_posX.begin(), _source.m_posX.end());
+    m_posY.assign(_source.m_posY.begin(), _source.m_posY.end());
+    m_posZ.assign(_source.m_posZ.begin(), _source.m_posZ.end());
+    m_size.assign(_source.m_size.begin(), _source.m_size.end());
+    m_scale.assign(_source.m_scale.begin(), _source.m_scale.end());
+    m_colour.assign(_source.m_colour.begin(), _source.m_colour.end());
+    m_wireframe.assign(_source.m_wireframe.begin(), _source.m_wireframe.end());
+}
+//----------------------------------------------------------------------------------------------------------------------
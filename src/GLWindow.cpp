@@ -1,7 +1,10 @@
 #include "obstacle.h"
+#include "ObstacleRenderer.h"
 
 #include "GLWindow.h"
 #include <iostream>
+#include <algorithm>
+#include <limits>
 #include "ngl/Camera.h"
 #include "ngl/Light.h"
 #include "ngl/Transformation.h"
@@ -15,6 +18,9 @@
 #include "flock.h"
 #include "ngl/BBox.h"
 #include <ngl/Util.h>
+#include <cstdio>
+#include "Profiler.h"
+#include "Tracer.h"
 
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -26,6 +32,10 @@ const static float INCREMENT = 1;
 //----------------------------------------------------------------------------------------------------------------------
 const static float ZOOM = 10.0;
 //----------------------------------------------------------------------------------------------------------------------
+/// @brief the file the trace is written to on F9 and on exit when FLOCK_TRACE is compiled in
+//----------------------------------------------------------------------------------------------------------------------
+const static char *TRACE_FILE = "flock_trace.json";
+//----------------------------------------------------------------------------------------------------------------------
 // in this ctor we need to call the CreateCoreGLContext class, this is mainly for the MacOS Lion version as
 // we need to init the OpenGL 3.2 sub-system which is different than other platforms
 //----------------------------------------------------------------------------------------------------------------------
@@ -35,6 +45,14 @@ GLWindow::GLWindow(
     : QGLWidget( new CreateCoreGLContext(QGLFormat::defaultFormat()), _parent )
 {
     obstacle = new Obstacle(ngl::Vector(12,30,0), 4.0);
+    // the flock collides with its own copy of the obstacle, it is changed through the simulation thread
+    m_simObstacle = new Obstacle(ngl::Vector(12,30,0), 4.0);
+    m_flockSize = 200;
+    flock = 0;
+    m_simulation = 0;
+    m_flockRenderer = 0;
+    m_replayFrame = 0;
+    m_text = 0;
 
     // set this widget to have the initial keyboard focus
     setFocus();
@@ -46,7 +64,7 @@ GLWindow::GLWindow(
     // mouse rotation values set to 0
     m_spinXFace = 0;
     m_spinYFace = 0;
-    m_sphereUpdateTimer = startTimer(1000 / 60); //run at 60FPS
+    m_sphereUpdateTimer = startTimer(1000 / 60); //redraw at 60FPS when a new frame is there
     m_animate = true;
     m_backgroundColour.set(0.6f, 0.6f, 0.6f, 1.0f);
 }
@@ -55,6 +73,16 @@ GLWindow::GLWindow(
 GLWindow::~GLWindow()
 {
     ngl::NGLInit *Init = ngl::NGLInit::instance();
+    // the simulation has to stop before the flock it runs goes
+    delete m_simulation;
+    delete flock;
+#ifdef FLOCK_TRACE
+    // every thread that recorded has stopped, the trace holds the last events of the run
+    Tracer::instance().writeJson(TRACE_FILE);
+#endif
+    delete m_simObstacle;
+    delete m_flockRenderer;
+    delete m_text;
     std::cout<<"Shutting down NGL, removing VAO's and Shaders\n";
     delete m_light;
     Init->NGLQuit();
@@ -62,34 +90,47 @@ GLWindow::~GLWindow()
 
 int GLWindow::getCurrentBoidSize()
 {
-    return flock->getFlockSize();
+    // the flock is owned by the simulation thread, the GUI keeps its own count of the changes it asked for
+    return m_flockSize;
 }
 
 void GLWindow::resetFlock()
 {
-    flock->setFlockSize(200);
-    flock->resetBoids();
+    m_flockSize = 200;
+    m_simulation->post([](Flock &_flock)
+    {
+        _flock.setFlockSize(200);
+        _flock.resetBoids();
+    });
 }
 
 void GLWindow::applyFlock(int size)
 {
-    flock->setFlockSize(size);
-    flock->resetBoids();
+    m_flockSize = size;
+    m_simulation->post([size](Flock &_flock)
+    {
+        _flock.setFlockSize(size);
+        _flock.resetBoids();
+    });
 }
 
-void GLWindow::addBoidsToFlock()
+void GLWindow::addBoidsToFlock(int count)
 {
-    flock->addBoids();
+    // the flock cuts the count down the same way, so the two sizes stay in step
+    count = std::min(count, std::numeric_limits<int>::max() - m_flockSize);
+    m_flockSize += count;
+    m_simulation->post([count](Flock &_flock){_flock.spawn(count);});
 }
 
-void GLWindow::removeBoidsFromFlock()
+void GLWindow::removeBoidsFromFlock(int count)
 {
-    flock->removeBoids();
+    m_flockSize = std::max(0, m_flockSize - count);
+    m_simulation->post([count](Flock &_flock){_flock.despawn(count);});
 }
 
 void GLWindow::setBoidSize(double size)
 {
-    flock->setBoidSize(size);
+    m_simulation->post([size](Flock &_flock){_flock.setBoidSize(size);});
 }
 
 void GLWindow::setBoidColor(QColor colour)
@@ -97,22 +138,26 @@ void GLWindow::setBoidColor(QColor colour)
     ngl::Colour colourToSet;
     colourToSet.set(colour.redF(), colour.greenF(), colour.blueF());
 
-    flock->setColour(colourToSet);
+    m_simulation->post([colourToSet](Flock &_flock){_flock.setColour(colourToSet);});
 }
 
 void GLWindow::setFlockWireframe(bool value)
 {
-    flock->setWireframe(value);
+    m_simulation->post([value](Flock &_flock){_flock.setWireframe(value);});
 }
 
 void GLWindow::setObstaclePosition(ngl::Vector position)
 {
     obstacle->setSpherePosition(position);
+    Obstacle *simObstacle = m_simObstacle;
+    m_simulation->post([simObstacle, position](Flock &){simObstacle->setSpherePosition(position);});
 }
 
 void GLWindow::setObstacleSize(double size)
 {
     obstacle->setSphereRadius(size);
+    Obstacle *simObstacle = m_simObstacle;
+    m_simulation->post([simObstacle, size](Flock &){simObstacle->setSphereRadius(size);});
 }
 
 void GLWindow::setObstacleColour(QColor colour)
@@ -130,27 +175,38 @@ void GLWindow::setObstacleWireframe(bool value)
 
 void GLWindow::setSimDistance(double distance)
 {
-    flock->setSimDistance(distance);
+    m_simulation->post([distance](Flock &_flock){_flock.setSimDistance(distance);});
 }
 
 void GLWindow::setSimFlockDistance(double distance)
 {
-    flock->setSimFlockDistance(distance);
+    m_simulation->post([distance](Flock &_flock){_flock.setSimFlockDistance(distance);});
 }
 
 void GLWindow::setSimCohesion(double cohesion)
 {
-    flock->setSimCohesion(cohesion);
+    m_simulation->post([cohesion](Flock &_flock){_flock.setSimCohesion(cohesion);});
 }
 
 void GLWindow::setSimSeparation(double separation)
 {
-    flock->setSimSeparation(separation);
+    m_simulation->post([separation](Flock &_flock){_flock.setSimSeparation(separation);});
 }
 
 void GLWindow::setSimAlignment(double alignment)
 {
-    flock->setSimAlignment(alignment);
+    m_simulation->post([alignment](Flock &_flock){_flock.setSimAlignment(alignment);});
+}
+
+void GLWindow::setSimTopological(bool value)
+{
+    Flock::NeighbourMode mode = value ? Flock::TOPOLOGICAL : Flock::METRIC;
+    m_simulation->post([mode](Flock &_flock){_flock.setNeighbourMode(mode);});
+}
+
+void GLWindow::setSimNeighbourCount(int count)
+{
+    m_simulation->post([count](Flock &_flock){_flock.setTopologicalCount(count);});
 }
 
 void GLWindow::setBackgroundColour(ngl::Colour colour)
@@ -163,7 +219,78 @@ void GLWindow::setBBoxSize(ngl::Vector size)
 {
     delete bbox;
     bbox = new ngl::BBox(ngl::Vector(0,0,0), size.m_x, size.m_y, size.m_z);
+    m_simulation->post([size](Flock &_flock){_flock.setBoxSize(size.m_x, size.m_y, size.m_z);});
+}
+void GLWindow::saveSnapshot(const std::string &file)
+{
+    // saved between two steps on the simulation thread, which owns the flock
+    m_simulation->post([file](Flock &_flock)
+    {
+        if(!_flock.saveSnapshot(file))
+        {
+            std::cerr<<"could not save the snapshot "<<file<<"\n";
+        }
+    });
+}
+
+void GLWindow::loadSnapshot(const std::string &file, int boids)
+{
+    m_flockSize = boids;
+    m_simulation->post([file](Flock &_flock)
+    {
+        if(!_flock.loadSnapshot(file))
+        {
+            std::cerr<<"could not load the snapshot "<<file<<"\n";
+        }
+    });
+}
+
+void GLWindow::startRecording(const std::string &file)
+{
+    m_simulation->startRecording(file);
+}
+
+void GLWindow::stopRecording()
+{
+    m_simulation->stopRecording();
+}
+
+bool GLWindow::openReplay(const std::string &file)
+{
+    if(!m_replay.open(file) || m_replay.getFrameCount() == 0)
+    {
+        m_replay.close();
+        return false;
+    }
+    // the recorded frames are only drawn, there is nothing to simulate while they play
+    m_simulation->setPaused(true);
+    m_replayFrame = 0;
+    updateGL();
+    return true;
+}
+
+void GLWindow::closeReplay()
+{
+    m_replay.close();
+    m_simulation->setPaused(false);
+    updateGL();
+}
+
+int GLWindow::getReplayFrameCount() const
+{
+    return m_replay.getFrameCount();
+}
+
+void GLWindow::setReplayFrame(int frame)
+{
+    if(m_replay.isOpen() && frame >= 0 && frame < m_replay.getFrameCount())
+    {
+        // the index gives the frame straight away, no matter how far it is from the current one
+        m_replayFrame = frame;
+        updateGL();
+    }
 }
+
 //----------------------------------------------------------------------------------------------------------------------
 // This virtual function is called once before the first call to paintGL() or resizeGL(),
 //and then once whenever the widget has been assigned a new QGLContext.
@@ -237,6 +364,27 @@ void GLWindow::initializeGL()
     m_light->setTransform(iv);
     // load these values to the shader as well
     m_light->loadToShader("light");
+    // the flock is drawn with the instanced version of Phong, the boid data comes in as instance attributes
+    m_shader->createShaderProgram("PhongInstanced");
+    m_shader->attachShader("PhongInstancedVertex",ngl::VERTEX);
+    m_shader->attachShader("PhongInstancedFragment",ngl::FRAGMENT);
+    m_shader->loadShaderSource("PhongInstancedVertex","shaders/PhongInstanced.vs");
+    m_shader->loadShaderSource("PhongInstancedFragment","shaders/PhongInstanced.fs");
+    m_shader->compileShader("PhongInstancedVertex");
+    m_shader->compileShader("PhongInstancedFragment");
+    m_shader->attachShaderToProgram("PhongInstanced","PhongInstancedVertex");
+    m_shader->attachShaderToProgram("PhongInstanced","PhongInstancedFragment");
+    m_shader->bindAttribute("PhongInstanced",0,"inVert");
+    m_shader->bindAttribute("PhongInstanced",1,"inUV");
+    m_shader->bindAttribute("PhongInstanced",2,"inNormal");
+    m_shader->bindAttribute("PhongInstanced",FlockRenderer::POSITION,"inInstancePosition");
+    m_shader->bindAttribute("PhongInstanced",FlockRenderer::SCALE,"inInstanceScale");
+    m_shader->bindAttribute("PhongInstanced",FlockRenderer::COLOUR,"inInstanceColour");
+    m_shader->linkProgramObject("PhongInstanced");
+    (*m_shader)["PhongInstanced"]->use();
+    m_shader->setShaderParam3f("viewerPos",m_cam->getEye().m_x,m_cam->getEye().m_y,m_cam->getEye().m_z);
+    m_light->loadToShader("light");
+
     m_shader->createShaderProgram("Colour");
 
     m_shader->attachShader("ColourVertex",ngl::VERTEX);
@@ -257,10 +405,19 @@ void GLWindow::initializeGL()
     glEnable(GL_DEPTH_TEST); // for removal of hidden surfaces
     ngl::VAOPrimitives *prim=ngl::VAOPrimitives::instance();
     prim->createSphere("sphere",0.8,1);
+    m_flockRenderer = new FlockRenderer(0.8f);
     bbox = new ngl::BBox(ngl::Vector(0,0,0),120,120,120);
     bbox->setDrawMode(GL_LINE);
-    flock = new Flock(bbox, obstacle);
-
+    flock = new Flock(bbox->width(), bbox->height(), bbox->depth(), m_simObstacle);
+    // from here on the flock belongs to the simulation thread
+    m_simulation = new SimulationThread(flock);
+    m_simulation->start();
+    FLOCK_TRACE_THREAD("gui");
+#ifdef FLOCK_PROFILE
+    m_text = new ngl::Text(QFont("Courier", 10));
+    m_text->setScreenSize(width(), height());
+    m_text->setColour(1.0f, 1.0f, 1.0f);
+#endif
 }
 //----------------------------------------------------------------------------------------------------------------------
 //This virtual function is called whenever the widget has been updateVelocityresized.
@@ -275,6 +432,10 @@ void GLWindow::resizeGL(
     glViewport(0,0,_w,_h);
     // now set the camera size values as the screen size has changed
     m_cam->setShape(45,(float)_w/_h,0.05,350,ngl::PERSPECTIVE);
+    if(m_text != 0)
+    {
+        m_text->setScreenSize(_w, _h);
+    }
 }
 
 
@@ -325,6 +486,7 @@ void GLWindow::loadMatricesToColourShader(
 //----------------------------------------------------------------------------------------------------------------------
 void GLWindow::paintGL()
 {
+    FLOCK_TRACE_SCOPE("paintGL");
     // clear the screen and depth buffer
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
@@ -353,14 +515,24 @@ void GLWindow::paintGL()
     loadMatricesToShader(m_transformStack);
 
     bbox->draw();
-    flock->draw("Phong",m_transformStack,m_cam);
+    // always draw the newest finished step, this never waits for the simulation
+    m_simulation->newFrame();
+    if(m_replay.isOpen())
+    {
+        // a recorded frame is drawn from the mapped file, looking like the live flock
+        m_flockRenderer->drawFlock(m_replay.getFrame(m_replayFrame),m_simulation->frame(),"PhongInstanced",m_transformStack,m_cam);
+    }
+    else
+    {
+        m_flockRenderer->drawFlock(m_simulation->frame(),"PhongInstanced",m_transformStack,m_cam);
+    }
 
     {
         m_transformStack.pushTransform();
         {
             //m_transformStack.setCurrent(0,10,0);
             loadMatricesToShader(m_transformStack);
-            obstacle->ObsDraw("Phong",m_transformStack,m_cam);
+            ObstacleRenderer::draw(*obstacle,"Phong",m_transformStack,m_cam);
         }
         m_transformStack.popTransform();
     }
@@ -372,9 +544,69 @@ void GLWindow::paintGL()
         }
         m_transformStack.popTransform();
     }
-
+    drawProfile();
+}
+//----------------------------------------------------------------------------------------------------------------------
+void GLWindow::drawProfile()
+{
+    if(m_text == 0)
+    {
+        return;
+    }
+    // the histograms share the buckets from the fastest to the slowest time of any phase so they line up, every
+    // bucket is one character shaded by its share of the fullest bucket of the phase
+    static const char shades[] = " .:-=+*#%@";
+    const int levels = sizeof(shades) - 2;
+    Profiler::Stats stats[Profiler::PHASES];
+    int first = Profiler::s_buckets;
+    int last = -1;
+    for(int p=0; p<Profiler::PHASES; ++p)
+    {
+        stats[p] = Profiler::instance().getStats((Profiler::Phase)p);
+        for(int b=0; b<Profiler::s_buckets; ++b)
+        {
+            if(stats[p].m_histogram[b] > 0)
+            {
+                first = std::min(first, b);
+                last = std::max(last, b);
+            }
+        }
+    }
+    char line[256];
+    std::snprintf(line, sizeof(line), "%-14s %9s %9s %9s  histogram from %lu us", "phase", "last ms", "mean ms", "p99 ms",
+                  first < Profiler::s_buckets && first > 0 ? 1ul << first : 0ul);
+    m_text->renderText(10, 10, line);
+    for(int p=0; p<Profiler::PHASES; ++p)
+    {
+        const Profiler::Stats &s = stats[p];
+        int fullest = *std::max_element(s.m_histogram, s.m_histogram + Profiler::s_buckets);
+        std::string bars;
+        for(int b=first; b<=last; ++b)
+        {
+            int shade = fullest > 0 ? (s.m_histogram[b] * levels + fullest - 1) / fullest : 0;
+            bars += shades[shade];
+        }
+        std::snprintf(line, sizeof(line), "%-14s %9.3f %9.3f %9.3f  |%s|", Profiler::name((Profiler::Phase)p),
+                      s.m_lastMs, s.m_meanMs, s.m_p99Ms, bars.c_str());
+        m_text->renderText(10, 28 + 18 * p, line);
+    }
 }
 
+//----------------------------------------------------------------------------------------------------------------------
+void GLWindow::keyPressEvent(
+        QKeyEvent *_event
+        )
+{
+#ifdef FLOCK_TRACE
+    if(_event->key() == Qt::Key_F9)
+    {
+        // written while the threads keep running, the trace is whatever the rings hold right now
+        Tracer::instance().writeJson(TRACE_FILE);
+        return;
+    }
+#endif
+    QGLWidget::keyPressEvent(_event);
+}
 //----------------------------------------------------------------------------------------------------------------------
 void GLWindow::mouseMoveEvent (
         QMouseEvent * _event
@@ -487,8 +719,29 @@ void GLWindow::timerEvent(
         }
 
 
-        flock->update();
-        updateGL();
+        if(m_replay.isOpen())
+        {
+            // the replay moves on one recorded frame per tick and starts over at the end
+            m_replayFrame = (m_replayFrame + 1) % m_replay.getFrameCount();
+            emit replayFrameChanged(m_replayFrame);
+            updateGL();
+            return;
+        }
+        int boids;
+        if(m_simulation->takeOutOfMemory(boids))
+        {
+            m_flockSize = boids;
+            emit flockOutOfMemory(boids);
+        }
+        if(m_simulation->takeRecordingFailed())
+        {
+            emit recordingFailed();
+        }
+        // the flock steps on the simulation thread, only redraw when it finished a new step
+        if(m_simulation->newFrame())
+        {
+            updateGL();
+        }
     }
 
 }
@@ -0,0 +1,223 @@
+#include "KdTree.h"
+#include <algorithm>
+#include <limits>
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief ranges this small are not split, a query scans them
+const static int s_leafSize = 16;
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the calling thread splits until there are this many subtrees per worker to hand out
+const static int s_subtreesPerWorker = 8;
+//----------------------------------------------------------------------------------------------------------------------
+KdTree::KdTree()
+{
+}
+//----------------------------------------------------------------------------------------------------------------------
+void KdTree::build(const FlockState &_state, ThreadPool &_pool)
+{
+    const int count = _state.size();
+    m_index.resize(count);
+    m_axis.assign(count, 0);
+    for(int i=0; i<count; ++i)
+    {
+        m_index[i] = i;
+    }
+    if(count == 0)
+    {
+        return;
+    }
+
+    // the top of the tree is split breadth first so the subtrees left are about the same size. Every range is
+    // split the same way wherever it is split, so the tree does not depend on how deep this goes.
+    m_subtrees.clear();
+    m_subtrees.push_back(0);
+    m_subtrees.push_back(count);
+    const int wanted = s_subtreesPerWorker * _pool.size();
+    bool splitAny = _pool.size() > 1;
+    while(splitAny && (int)m_subtrees.size() / 2 < wanted)
+    {
+        std::vector <int> next;
+        splitAny = false;
+        for(unsigned int r=0; r<m_subtrees.size(); r+=2)
+        {
+            int lo = m_subtrees[r];
+            int hi = m_subtrees[r + 1];
+            if(hi - lo <= s_leafSize)
+            {
+                next.push_back(lo);
+                next.push_back(hi);
+                continue;
+            }
+            int middle = splitOnce(lo, hi, _state);
+            next.push_back(lo);
+            next.push_back(middle);
+            next.push_back(middle + 1);
+            next.push_back(hi);
+            splitAny = true;
+        }
+        m_subtrees.swap(next);
+    }
+    _pool.parallelFor((int)m_subtrees.size() / 2, 1, [&](int _begin, int _end, int)
+    {
+        for(int r=_begin; r<_end; ++r)
+        {
+            split(m_subtrees[2 * r], m_subtrees[2 * r + 1], _state);
+        }
+    });
+
+    // the positions in tree order for the queries
+    const float *positions[3] = {&_state.m_posX[0], &_state.m_posY[0], &_state.m_posZ[0]};
+    for(int a=0; a<3; ++a)
+    {
+        m_coords[a].resize(count);
+    }
+    _pool.parallelFor(count, 4096, [&](int _begin, int _end, int)
+    {
+        for(int a=0; a<3; ++a)
+        {
+            for(int i=_begin; i<_end; ++i)
+            {
+                m_coords[a][i] = positions[a][m_index[i]];
+            }
+        }
+    });
+}
+//----------------------------------------------------------------------------------------------------------------------
+int KdTree::splitOnce(int _lo, int _hi, const FlockState &_state)
+{
+    const float *positions[3] = {&_state.m_posX[0], &_state.m_posY[0], &_state.m_posZ[0]};
+    float low[3] = {positions[0][m_index[_lo]], positions[1][m_index[_lo]], positions[2][m_index[_lo]]};
+    float high[3] = {low[0], low[1], low[2]};
+    for(int i=_lo + 1; i<_hi; ++i)
+    {
+        for(int a=0; a<3; ++a)
+        {
+            float value = positions[a][m_index[i]];
+            low[a] = std::min(low[a], value);
+            high[a] = std::max(high[a], value);
+        }
+    }
+    int axis = 0;
+    for(int a=1; a<3; ++a)
+    {
+        if(high[a] - low[a] > high[axis] - low[axis])
+        {
+            axis = a;
+        }
+    }
+    // equal coordinates are ordered by index so the split never depends on the order the range arrived in
+    const float *coord = positions[axis];
+    int middle = (_lo + _hi) / 2;
+    std::nth_element(m_index.begin() + _lo, m_index.begin() + middle, m_index.begin() + _hi, [coord](int _a, int _b)
+    {
+        return coord[_a] < coord[_b] || (coord[_a] == coord[_b] && _a < _b);
+    });
+    m_axis[middle] = (unsigned char)axis;
+    return middle;
+}
+//----------------------------------------------------------------------------------------------------------------------
+void KdTree::split(int _lo, int _hi, const FlockState &_state)
+{
+    if(_hi - _lo <= s_leafSize)
+    {
+        return;
+    }
+    int middle = splitOnce(_lo, _hi, _state);
+    split(_lo, middle, _state);
+    split(middle + 1, _hi, _state);
+}
+//----------------------------------------------------------------------------------------------------------------------
+inline void KdTree::consider(int _entry, Query &_query) const
+{
+    int boid = m_index[_entry];
+    float dx = m_coords[0][_entry] - _query.m_position[0];
+    float dy = m_coords[1][_entry] - _query.m_position[1];
+    float dz = m_coords[2][_entry] - _query.m_position[2];
+    float distanceSq = dx * dx + dy * dy + dz * dz;
+    int *neighbours = _query.m_neighbours;
+    float *distances = _query.m_distancesSq;
+    int found = _query.m_found;
+    // ties go to the lower boid index so the result does not depend on the order the tree is walked
+    if(boid == _query.m_exclude || (found == _query.m_k &&
+       (distanceSq > distances[found - 1] || (distanceSq == distances[found - 1] && boid > neighbours[found - 1]))))
+    {
+        return;
+    }
+    if(found < _query.m_k)
+    {
+        _query.m_found = ++found;
+    }
+    // k is small so an insertion into the sorted list beats a heap
+    int slot = found - 1;
+    while(slot > 0 && (distances[slot - 1] > distanceSq || (distances[slot - 1] == distanceSq && neighbours[slot - 1] > boid)))
+    {
+        neighbours[slot] = neighbours[slot - 1];
+        distances[slot] = distances[slot - 1];
+        --slot;
+    }
+    neighbours[slot] = boid;
+    distances[slot] = distanceSq;
+    if(found == _query.m_k)
+    {
+        _query.m_worstSq = distances[found - 1];
+    }
+}
+//----------------------------------------------------------------------------------------------------------------------
+void KdTree::search(int _lo, int _hi, float _boxDistanceSq, float *_offsets, Query &_query) const
+{
+    if(_hi - _lo <= s_leafSize)
+    {
+        for(int i=_lo; i<_hi; ++i)
+        {
+            consider(i, _query);
+        }
+        return;
+    }
+    int middle = (_lo + _hi) / 2;
+    int axis = m_axis[middle];
+    consider(middle, _query);
+    float offset = _query.m_position[axis] - m_coords[axis][middle];
+    int nearLo = offset < 0.0f ? _lo : middle + 1;
+    int nearHi = offset < 0.0f ? middle : _hi;
+    int farLo = offset < 0.0f ? middle + 1 : _lo;
+    int farHi = offset < 0.0f ? _hi : middle;
+    search(nearLo, nearHi, _boxDistanceSq, _offsets, _query);
+    // the box of the far side is the box of this node cut at the split, its distance only changes along the
+    // split axis. It can only hold a closer boid if that box is closer than the furthest boid kept.
+    float previous = _offsets[axis];
+    float farDistanceSq = _boxDistanceSq - previous * previous + offset * offset;
+    if(farDistanceSq <= _query.m_worstSq)
+    {
+        _offsets[axis] = offset;
+        search(farLo, farHi, farDistanceSq, _offsets, _query);
+        _offsets[axis] = previous;
+    }
+}
+//----------------------------------------------------------------------------------------------------------------------
+void KdTree::nearest(const ngl::Vector &_position, int _k, int _exclude, std::vector <int> &_neighbours,
+                     std::vector <float> &_distancesSq) const
+{
+    _neighbours.resize(std::max(_k, 0));
+    _distancesSq.resize(std::max(_k, 0));
+    if(_k <= 0 || m_index.empty())
+    {
+        _neighbours.clear();
+        _distancesSq.clear();
+        return;
+    }
+    Query query;
+    query.m_position[0] = _position.m_x;
+    query.m_position[1] = _position.m_y;
+    query.m_position[2] = _position.m_z;
+    query.m_k = _k;
+    query.m_exclude = _exclude;
+    query.m_found = 0;
+    query.m_worstSq = std::numeric_limits<float>::max();
+    query.m_neighbours = &_neighbours[0];
+    query.m_distancesSq = &_distancesSq[0];
+    float offsets[3] = {0.0f, 0.0f, 0.0f};
+    search(0, (int)m_index.size(), 0.0f, offsets, query);
+    _neighbours.resize(query.m_found);
+    _distancesSq.resize(query.m_found);
+}
+//----------------------------------------------------------------------------------------------------------------------
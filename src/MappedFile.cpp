@@ -0,0 +1,99 @@
+#include "MappedFile.h"
+#include <algorithm>
+#include <cstdio>
+#include <sys/stat.h>
+#ifndef WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+//----------------------------------------------------------------------------------------------------------------------
+MappedFile::MappedFile()
+{
+    m_data = 0;
+    m_bytes = 0;
+    m_mapping = 0;
+}
+//----------------------------------------------------------------------------------------------------------------------
+MappedFile::~MappedFile()
+{
+    close();
+}
+//----------------------------------------------------------------------------------------------------------------------
+void MappedFile::close()
+{
+#ifndef WIN32
+    if(m_mapping != 0)
+    {
+        munmap(m_mapping, m_bytes);
+    }
+#endif
+    m_mapping = 0;
+    m_data = 0;
+    m_bytes = 0;
+    std::vector <uint64_t>().swap(m_copy);
+}
+//----------------------------------------------------------------------------------------------------------------------
+void MappedFile::swap(MappedFile &_other)
+{
+    std::swap(m_data, _other.m_data);
+    std::swap(m_bytes, _other.m_bytes);
+    std::swap(m_mapping, _other.m_mapping);
+    m_copy.swap(_other.m_copy);
+}
+//----------------------------------------------------------------------------------------------------------------------
+bool MappedFile::open(const std::string &_file, bool _populate)
+{
+    close();
+    struct stat info;
+    if(stat(_file.c_str(), &info) != 0 || info.st_size <= 0)
+    {
+        return false;
+    }
+    uint64_t bytes = info.st_size;
+
+#ifndef WIN32
+    int descriptor = ::open(_file.c_str(), O_RDONLY);
+    if(descriptor < 0)
+    {
+        return false;
+    }
+    int flags = MAP_PRIVATE;
+#ifdef MAP_POPULATE
+    // faulting the whole file in up front is cheaper than a fault per page
+    if(_populate)
+    {
+        flags |= MAP_POPULATE;
+    }
+#endif
+    void *mapping = mmap(0, bytes, PROT_READ, flags, descriptor, 0);
+    ::close(descriptor);
+    if(mapping == MAP_FAILED)
+    {
+        return false;
+    }
+    m_mapping = mapping;
+    m_data = (const char *)mapping;
+#else
+    // no mmap here, read the file into memory instead, which populates it anyway
+    (void)_populate;
+    m_copy.resize((bytes + 7) / 8);
+    FILE *file = std::fopen(_file.c_str(), "rb");
+    if(file == 0)
+    {
+        return false;
+    }
+    bool read = std::fread(&m_copy[0], 1, bytes, file) == bytes;
+    std::fclose(file);
+    if(!read)
+    {
+        std::vector <uint64_t>().swap(m_copy);
+        return false;
+    }
+    m_data = (const char *)&m_copy[0];
+#endif
+    m_bytes = bytes;
+    return true;
+}
+//----------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,145 @@
+#include "NeighbourList.h"
+#include <algorithm>
+#include <atomic>
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the number of boids a worker takes at a time, every chunk of the build collects its own neighbours
+const static int s_grain = 256;
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the most neighbours the lists hold over all boids, 4 bytes each in the lists and again in the chunks
+/// while they are built. A flock packed tighter than the skin lists every pair, which grows with the square of
+/// the flock, so past this the lists give up and the grid is used.
+const static long s_pairBudget = 1L << 24;
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the updates the lists wait after giving up before they try to build again
+const static int s_overflowBackoff = 60;
+//----------------------------------------------------------------------------------------------------------------------
+NeighbourList::NeighbourList()
+{
+    m_radius = 0.0f;
+    m_skin = 0.0f;
+    m_valid = false;
+    m_backoff = 0;
+}
+//----------------------------------------------------------------------------------------------------------------------
+bool NeighbourList::update(const FlockState &_state, float _radius, float _skin, ThreadPool &_pool)
+{
+    ++m_stats.m_updates;
+    if(m_backoff > 0)
+    {
+        // the last build ran over the budget, a dense flock takes a while to spread out
+        --m_backoff;
+        return false;
+    }
+    bool rebuild = !m_valid || _radius != m_radius || _skin != m_skin || (int)m_refX.size() != _state.size() ||
+                   movedTooFar(_state, 0.5f * _skin, _pool);
+    if(!rebuild)
+    {
+        return false;
+    }
+    m_radius = _radius;
+    m_skin = _skin;
+    ++m_stats.m_builds;
+    m_valid = build(_state, _radius + _skin, _pool);
+    if(!m_valid)
+    {
+        ++m_stats.m_overflows;
+        m_backoff = s_overflowBackoff;
+        // the memory of the partial build is handed back, holding on to it is what the budget is there to stop
+        std::vector <int>().swap(m_indices);
+        std::vector <std::vector <int> >().swap(m_chunkIndices);
+    }
+    m_stats.m_pairs = m_indices.size();
+    return m_valid;
+}
+//----------------------------------------------------------------------------------------------------------------------
+bool NeighbourList::movedTooFar(const FlockState &_state, float _limit, ThreadPool &_pool)
+{
+    m_workerMax.assign(_pool.size(), 0.0f);
+    _pool.parallelFor(_state.size(), s_grain, [&](int _begin, int _end, int _worker)
+    {
+        // no early out so the loop stays a plain max the compiler can vectorise
+        float largest = m_workerMax[_worker];
+        for(int i=_begin; i<_end; ++i)
+        {
+            float dx = _state.m_posX[i] - m_refX[i];
+            float dy = _state.m_posY[i] - m_refY[i];
+            float dz = _state.m_posZ[i] - m_refZ[i];
+            largest = std::max(largest, dx * dx + dy * dy + dz * dz);
+        }
+        m_workerMax[_worker] = largest;
+    });
+    float largest = *std::max_element(m_workerMax.begin(), m_workerMax.end());
+    return largest > _limit * _limit;
+}
+//----------------------------------------------------------------------------------------------------------------------
+bool NeighbourList::build(const FlockState &_state, float _reach, ThreadPool &_pool)
+{
+    const int count = _state.size();
+    m_refX = _state.m_posX;
+    m_refY = _state.m_posY;
+    m_refZ = _state.m_posZ;
+    m_grid.rebuild(_state, _reach);
+    m_offsets.resize(count + 1);
+    m_offsets[0] = 0;
+    m_chunkIndices.resize((count + s_grain - 1) / s_grain);
+    m_candidates.resize(_pool.size());
+    const float reachSq = _reach * _reach;
+    std::atomic<long> pairs(0);
+
+    // every chunk lists its boids into its own array and writes how many each boid got, all of them stop once
+    // the chunks together went over the budget
+    _pool.parallelFor(count, s_grain, [&](int _begin, int _end, int _worker)
+    {
+        if(pairs.load(std::memory_order_relaxed) > s_pairBudget)
+        {
+            return;
+        }
+        std::vector <int> &candidates = m_candidates[_worker];
+        std::vector <int> &indices = m_chunkIndices[_begin / s_grain];
+        indices.clear();
+        for(int i=_begin; i<_end; ++i)
+        {
+            const float px = _state.m_posX[i];
+            const float py = _state.m_posY[i];
+            const float pz = _state.m_posZ[i];
+            m_grid.gatherNeighbours(ngl::Vector(px, py, pz), candidates);
+            int found = 0;
+            for(unsigned int n=0; n<candidates.size(); ++n)
+            {
+                int j = candidates[n];
+                float dx = _state.m_posX[j] - px;
+                float dy = _state.m_posY[j] - py;
+                float dz = _state.m_posZ[j] - pz;
+                if(j != i && dx * dx + dy * dy + dz * dz <= reachSq)
+                {
+                    indices.push_back(j);
+                    ++found;
+                }
+            }
+            m_offsets[i + 1] = found;
+            if(pairs.fetch_add(found, std::memory_order_relaxed) + found > s_pairBudget)
+            {
+                return;
+            }
+        }
+    });
+    if(pairs.load() > s_pairBudget)
+    {
+        return false;
+    }
+
+    // the counts become the row starts and the chunks are copied into place
+    for(int i=0; i<count; ++i)
+    {
+        m_offsets[i + 1] += m_offsets[i];
+    }
+    m_indices.resize(m_offsets[count]);
+    _pool.parallelFor(count, s_grain, [&](int _begin, int, int)
+    {
+        const std::vector <int> &indices = m_chunkIndices[_begin / s_grain];
+        std::copy(indices.begin(), indices.end(), m_indices.begin() + m_offsets[_begin]);
+    });
+    return true;
+}
+//----------------------------------------------------------------------------------------------------------------------
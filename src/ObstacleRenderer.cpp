@@ -0,0 +1,57 @@
+#include "ObstacleRenderer.h"
+#include "Profiler.h"
+#include <ngl/ShaderLib.h>
+#include <ngl/VAOPrimitives.h>
+#include <ngl/Material.h>
+
+void ObstacleRenderer::loadMatricesToShader(ngl::TransformStack &_tx, ngl::Camera *_cam)
+{
+    ngl::ShaderLib *shader=ngl::ShaderLib::instance();
+
+    ngl::Matrix MV;
+    ngl::Matrix MVP;
+    ngl::Mat3x3 normalMatrix;
+    ngl::Matrix M;
+    M=_tx.getCurrentTransform().getMatrix();
+    MV=  _tx.getCurrAndGlobal().getMatrix()*_cam->getViewMatrix();
+    MVP=  MV*_cam->getProjectionMatrix();
+    normalMatrix=MV;
+    normalMatrix.inverse();
+    shader->setShaderParamFromMatrix("MV",MV);
+    shader->setShaderParamFromMatrix("MVP",MVP);
+    shader->setShaderParamFromMat3x3("normalMatrix",normalMatrix);
+    shader->setShaderParamFromMatrix("M",M);
+
+}
+
+void ObstacleRenderer::draw(const Obstacle &_obstacle, const std::string &_shaderName, ngl::TransformStack &_transformStack, ngl::Camera *_cam)
+{
+    FLOCK_PROFILE_SCOPE(OBSTACLE_DRAW);
+    const float radius = _obstacle.getSphereRadius();
+    ngl::ShaderLib *shader=ngl::ShaderLib::instance();
+    shader->use(_shaderName);
+    ngl::Material m(ngl::PEWTER);
+    m.setDiffuse(_obstacle.getColour());
+    m.loadToShader("material");
+    // grab an instance of the primitives for drawing
+    ngl::VAOPrimitives *prim=ngl::VAOPrimitives::instance();
+    prim->createSphere("obstacle",radius,20);
+
+    if (_obstacle.isWireframe())
+        glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+    else
+        glPolygonMode(GL_FRONT_AND_BACK,GL_FILL);
+
+    _transformStack.pushTransform();
+    {
+
+        _transformStack.setPosition(_obstacle.getSpherePosition());
+        _transformStack.setScale(radius,radius,radius);
+        loadMatricesToShader(_transformStack,_cam);
+        prim->draw("obstacle");
+
+
+    } // and before a pop
+    _transformStack.popTransform();
+
+}
@@ -0,0 +1,209 @@
+#include "ObstacleSet.h"
+#include <algorithm>
+
+ObstacleSet::ObstacleSet(float _reach)
+{
+    m_reach = _reach;
+    m_needsBuild = false;
+}
+//----------------------------------------------------------------------------------------------------------------------
+int ObstacleSet::add(const ngl::Vector &_centre, float _radius)
+{
+    m_x.push_back(_centre.m_x);
+    m_y.push_back(_centre.m_y);
+    m_z.push_back(_centre.m_z);
+    m_radius.push_back(_radius);
+    m_needsBuild = true;
+    return size() - 1;
+}
+//----------------------------------------------------------------------------------------------------------------------
+void ObstacleSet::remove(int _i)
+{
+    int last = size() - 1;
+    m_x[_i] = m_x[last];
+    m_y[_i] = m_y[last];
+    m_z[_i] = m_z[last];
+    m_radius[_i] = m_radius[last];
+    m_x.pop_back();
+    m_y.pop_back();
+    m_z.pop_back();
+    m_radius.pop_back();
+    m_needsBuild = true;
+}
+//----------------------------------------------------------------------------------------------------------------------
+void ObstacleSet::clear()
+{
+    m_x.clear();
+    m_y.clear();
+    m_z.clear();
+    m_radius.clear();
+    m_needsBuild = true;
+}
+//----------------------------------------------------------------------------------------------------------------------
+void ObstacleSet::move(int _i, const ngl::Vector &_centre)
+{
+    if(m_x[_i] == _centre.m_x && m_y[_i] == _centre.m_y && m_z[_i] == _centre.m_z)
+    {
+        return;
+    }
+    m_x[_i] = _centre.m_x;
+    m_y[_i] = _centre.m_y;
+    m_z[_i] = _centre.m_z;
+    touch(_i);
+}
+//----------------------------------------------------------------------------------------------------------------------
+void ObstacleSet::setRadius(int _i, float _radius)
+{
+    if(m_radius[_i] == _radius)
+    {
+        return;
+    }
+    m_radius[_i] = _radius;
+    touch(_i);
+}
+//----------------------------------------------------------------------------------------------------------------------
+void ObstacleSet::touch(int _i)
+{
+    // obstacles added since the last build have no leaf yet, the build will take them in
+    if(m_needsBuild || _i >= (int)m_leafOf.size())
+    {
+        return;
+    }
+    int leaf = m_leafOf[_i];
+    if(!m_dirty[leaf])
+    {
+        m_dirty[leaf] = 1;
+        m_dirtyLeaves.push_back(leaf);
+    }
+}
+//----------------------------------------------------------------------------------------------------------------------
+void ObstacleSet::update()
+{
+    if(m_needsBuild)
+    {
+        rebuild();
+        return;
+    }
+    for(unsigned int d=0; d<m_dirtyLeaves.size(); ++d)
+    {
+        int n = m_dirtyLeaves[d];
+        m_dirty[n] = 0;
+        // walk up until a box does not change, the boxes above it already hold it
+        bool changed = fitLeaf(m_nodes[n]);
+        while(changed && m_nodes[n].m_parent >= 0)
+        {
+            n = m_nodes[n].m_parent;
+            changed = fitInner(m_nodes[n]);
+        }
+    }
+    m_dirtyLeaves.clear();
+}
+//----------------------------------------------------------------------------------------------------------------------
+void ObstacleSet::rebuild()
+{
+    m_needsBuild = false;
+    m_dirtyLeaves.clear();
+    m_nodes.clear();
+    int count = size();
+    m_order.resize(count);
+    m_leafOf.resize(count);
+    for(int i=0; i<count; ++i)
+    {
+        m_order[i] = i;
+    }
+    if(count == 0)
+    {
+        m_dirty.clear();
+        return;
+    }
+    m_nodes.reserve(2 * count);
+    Node root;
+    root.m_parent = -1;
+    m_nodes.push_back(root);
+    build(0, 0, count);
+    m_dirty.assign(m_nodes.size(), 0);
+}
+//----------------------------------------------------------------------------------------------------------------------
+void ObstacleSet::build(int _node, int _first, int _count)
+{
+    if(_count <= s_leafSize)
+    {
+        Node &leaf = m_nodes[_node];
+        leaf.m_first = _first;
+        leaf.m_count = _count;
+        for(int i=_first; i<_first + _count; ++i)
+        {
+            m_leafOf[m_order[i]] = _node;
+        }
+        fitLeaf(leaf);
+        return;
+    }
+
+    // split at the median of the centres along the longest side of their bounds
+    float lo[3] = {m_x[m_order[_first]], m_y[m_order[_first]], m_z[m_order[_first]]};
+    float hi[3] = {lo[0], lo[1], lo[2]};
+    for(int i=_first + 1; i<_first + _count; ++i)
+    {
+        int o = m_order[i];
+        lo[0] = std::min(lo[0], m_x[o]); hi[0] = std::max(hi[0], m_x[o]);
+        lo[1] = std::min(lo[1], m_y[o]); hi[1] = std::max(hi[1], m_y[o]);
+        lo[2] = std::min(lo[2], m_z[o]); hi[2] = std::max(hi[2], m_z[o]);
+    }
+    int axis = 0;
+    if(hi[1] - lo[1] > hi[axis] - lo[axis]) axis = 1;
+    if(hi[2] - lo[2] > hi[axis] - lo[axis]) axis = 2;
+    const float *key = axis == 0 ? &m_x[0] : axis == 1 ? &m_y[0] : &m_z[0];
+    int half = _count / 2;
+    std::nth_element(m_order.begin() + _first, m_order.begin() + _first + half, m_order.begin() + _first + _count,
+                     [key](int _a, int _b){return key[_a] < key[_b];});
+
+    int children = (int)m_nodes.size();
+    Node child;
+    child.m_parent = _node;
+    m_nodes.push_back(child);
+    m_nodes.push_back(child);
+    m_nodes[_node].m_first = children;
+    m_nodes[_node].m_count = 0;
+    build(children, _first, half);
+    build(children + 1, _first + half, _count - half);
+    fitInner(m_nodes[_node]);
+}
+//----------------------------------------------------------------------------------------------------------------------
+bool ObstacleSet::fitLeaf(Node &_node) const
+{
+    float lo[3] = {1e30f, 1e30f, 1e30f};
+    float hi[3] = {-1e30f, -1e30f, -1e30f};
+    for(int i=_node.m_first; i<_node.m_first + _node.m_count; ++i)
+    {
+        int o = m_order[i];
+        float r = m_radius[o] * m_reach;
+        lo[0] = std::min(lo[0], m_x[o] - r); hi[0] = std::max(hi[0], m_x[o] + r);
+        lo[1] = std::min(lo[1], m_y[o] - r); hi[1] = std::max(hi[1], m_y[o] + r);
+        lo[2] = std::min(lo[2], m_z[o] - r); hi[2] = std::max(hi[2], m_z[o] + r);
+    }
+    bool changed = false;
+    for(int a=0; a<3; ++a)
+    {
+        changed |= lo[a] != _node.m_min[a] || hi[a] != _node.m_max[a];
+        _node.m_min[a] = lo[a];
+        _node.m_max[a] = hi[a];
+    }
+    return changed;
+}
+//----------------------------------------------------------------------------------------------------------------------
+bool ObstacleSet::fitInner(Node &_node) const
+{
+    const Node &left = m_nodes[_node.m_first];
+    const Node &right = m_nodes[_node.m_first + 1];
+    bool changed = false;
+    for(int a=0; a<3; ++a)
+    {
+        float lo = std::min(left.m_min[a], right.m_min[a]);
+        float hi = std::max(left.m_max[a], right.m_max[a]);
+        changed |= lo != _node.m_min[a] || hi != _node.m_max[a];
+        _node.m_min[a] = lo;
+        _node.m_max[a] = hi;
+    }
+    return changed;
+}
+//----------------------------------------------------------------------------------------------------------------------
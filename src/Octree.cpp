@@ -0,0 +1,192 @@
+#include "Octree.h"
+#include <algorithm>
+#include <limits>
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the number of boids a worker takes at a time
+const static int s_grain = 4096;
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief spreads the low ten bits of _value so there are two zero bits between each of them
+static inline uint32_t spreadBits(uint32_t _value)
+{
+    _value &= 0x3ff;
+    _value = (_value | (_value << 16)) & 0x030000ff;
+    _value = (_value | (_value << 8)) & 0x0300f00f;
+    _value = (_value | (_value << 4)) & 0x030c30c3;
+    _value = (_value | (_value << 2)) & 0x09249249;
+    return _value;
+}
+//----------------------------------------------------------------------------------------------------------------------
+Octree::Octree()
+{
+}
+//----------------------------------------------------------------------------------------------------------------------
+void Octree::build(const FlockState &_state, ThreadPool &_pool)
+{
+    const int count = _state.size();
+    m_nodes.clear();
+    if(count == 0)
+    {
+        return;
+    }
+
+    // the bounds of the flock, six floats per worker
+    const float largest = std::numeric_limits<float>::max();
+    m_workerBounds.resize(6 * _pool.size());
+    for(int w=0; w<_pool.size(); ++w)
+    {
+        std::fill(m_workerBounds.begin() + 6 * w, m_workerBounds.begin() + 6 * w + 3, largest);
+        std::fill(m_workerBounds.begin() + 6 * w + 3, m_workerBounds.begin() + 6 * w + 6, -largest);
+    }
+    _pool.parallelFor(count, s_grain, [&](int _begin, int _end, int _worker)
+    {
+        float *bounds = &m_workerBounds[6 * _worker];
+        for(int i=_begin; i<_end; ++i)
+        {
+            bounds[0] = std::min(bounds[0], _state.m_posX[i]);
+            bounds[1] = std::min(bounds[1], _state.m_posY[i]);
+            bounds[2] = std::min(bounds[2], _state.m_posZ[i]);
+            bounds[3] = std::max(bounds[3], _state.m_posX[i]);
+            bounds[4] = std::max(bounds[4], _state.m_posY[i]);
+            bounds[5] = std::max(bounds[5], _state.m_posZ[i]);
+        }
+    });
+    float low[3] = {largest, largest, largest};
+    float high[3] = {-largest, -largest, -largest};
+    for(int w=0; w<_pool.size(); ++w)
+    {
+        for(int a=0; a<3; ++a)
+        {
+            low[a] = std::min(low[a], m_workerBounds[6 * w + a]);
+            high[a] = std::max(high[a], m_workerBounds[6 * w + 3 + a]);
+        }
+    }
+    // one scale for all the axes keeps the cells cubes
+    float extent = std::max(std::max(high[0] - low[0], high[1] - low[1]), high[2] - low[2]);
+    const float cells = (float)(1 << s_levels);
+    const float scale = extent > 0.0f ? (cells - 1.0f) / extent : 0.0f;
+
+    // the code sits above the index so the sort is stable and the same for any number of threads
+    m_keys.resize(count);
+    _pool.parallelFor(count, s_grain, [&](int _begin, int _end, int)
+    {
+        for(int i=_begin; i<_end; ++i)
+        {
+            uint32_t x = (uint32_t)((_state.m_posX[i] - low[0]) * scale);
+            uint32_t y = (uint32_t)((_state.m_posY[i] - low[1]) * scale);
+            uint32_t z = (uint32_t)((_state.m_posZ[i] - low[2]) * scale);
+            uint64_t code = spreadBits(x) | (spreadBits(y) << 1) | (spreadBits(z) << 2);
+            m_keys[i] = (code << 32) | (uint32_t)i;
+        }
+    });
+    std::sort(m_keys.begin(), m_keys.end());
+
+    m_order.resize(count);
+    m_posX.resize(count); m_posY.resize(count); m_posZ.resize(count);
+    m_velX.resize(count); m_velY.resize(count); m_velZ.resize(count);
+    _pool.parallelFor(count, s_grain, [&](int _begin, int _end, int)
+    {
+        for(int i=_begin; i<_end; ++i)
+        {
+            int boid = (int)(m_keys[i] & 0xffffffffu);
+            m_order[i] = boid;
+            m_posX[i] = _state.m_posX[boid];
+            m_posY[i] = _state.m_posY[boid];
+            m_posZ[i] = _state.m_posZ[boid];
+            m_velX[i] = _state.m_velX[boid];
+            m_velY[i] = _state.m_velY[boid];
+            m_velZ[i] = _state.m_velZ[boid];
+        }
+    });
+
+    m_nodes.resize(1);
+    buildNode(0, 0, count, 0);
+}
+//----------------------------------------------------------------------------------------------------------------------
+void Octree::buildNode(int _node, int _begin, int _end, int _level)
+{
+    m_nodes[_node].m_begin = _begin;
+    m_nodes[_node].m_end = _end;
+    m_nodes[_node].m_first = 0;
+    m_nodes[_node].m_children = 0;
+
+    if(_end - _begin > s_leafSize && _level < s_levels)
+    {
+        // the children are the runs of the next three bits, found by binary search in the sorted codes
+        const int shift = 32 + 3 * (s_levels - 1 - _level);
+        int starts[9];
+        int children = 0;
+        int begin = _begin;
+        while(begin < _end)
+        {
+            uint64_t octant = m_keys[begin] >> shift;
+            uint64_t bound = (octant + 1) << shift;
+            int end = (int)(std::lower_bound(m_keys.begin() + begin, m_keys.begin() + _end, bound) - m_keys.begin());
+            starts[children++] = begin;
+            begin = end;
+        }
+        starts[children] = _end;
+        // a node whose boids all share the octant moves straight on to the next level
+        if(children == 1)
+        {
+            buildNode(_node, _begin, _end, _level + 1);
+            return;
+        }
+        int first = (int)m_nodes.size();
+        m_nodes.resize(first + children);
+        m_nodes[_node].m_first = first;
+        m_nodes[_node].m_children = children;
+        for(int c=0; c<children; ++c)
+        {
+            buildNode(first + c, starts[c], starts[c + 1], _level + 1);
+        }
+        // the children may have grown the array so the node is looked up again
+        Node &node = m_nodes[_node];
+        const Node &head = m_nodes[first];
+        for(int a=0; a<3; ++a)
+        {
+            node.m_min[a] = head.m_min[a];
+            node.m_max[a] = head.m_max[a];
+            node.m_position[a] = 0.0f;
+            node.m_velocity[a] = 0.0f;
+        }
+        for(int c=0; c<children; ++c)
+        {
+            const Node &child = m_nodes[first + c];
+            for(int a=0; a<3; ++a)
+            {
+                node.m_min[a] = std::min(node.m_min[a], child.m_min[a]);
+                node.m_max[a] = std::max(node.m_max[a], child.m_max[a]);
+                node.m_position[a] += child.m_position[a];
+                node.m_velocity[a] += child.m_velocity[a];
+            }
+        }
+        return;
+    }
+
+    Node &node = m_nodes[_node];
+    node.m_min[0] = node.m_max[0] = m_posX[_begin];
+    node.m_min[1] = node.m_max[1] = m_posY[_begin];
+    node.m_min[2] = node.m_max[2] = m_posZ[_begin];
+    for(int a=0; a<3; ++a)
+    {
+        node.m_position[a] = 0.0f;
+        node.m_velocity[a] = 0.0f;
+    }
+    for(int i=_begin; i<_end; ++i)
+    {
+        node.m_min[0] = std::min(node.m_min[0], m_posX[i]);
+        node.m_min[1] = std::min(node.m_min[1], m_posY[i]);
+        node.m_min[2] = std::min(node.m_min[2], m_posZ[i]);
+        node.m_max[0] = std::max(node.m_max[0], m_posX[i]);
+        node.m_max[1] = std::max(node.m_max[1], m_posY[i]);
+        node.m_max[2] = std::max(node.m_max[2], m_posZ[i]);
+        node.m_position[0] += m_posX[i];
+        node.m_position[1] += m_posY[i];
+        node.m_position[2] += m_posZ[i];
+        node.m_velocity[0] += m_velX[i];
+        node.m_velocity[1] += m_velY[i];
+        node.m_velocity[2] += m_velZ[i];
+    }
+}
+//----------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,252 @@
+#include "PerfCounters.h"
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#ifdef __linux__
+    #include <linux/perf_event.h>
+    #include <sys/ioctl.h>
+    #include <sys/syscall.h>
+    #include <unistd.h>
+#endif
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the group of a thread, closed by the destructor when the thread ends
+class PerfThread
+{
+public:
+    PerfThread() : m_group(0), m_tried(false) {}
+    ~PerfThread()
+    {
+        if(m_group != 0)
+        {
+            PerfCounters::instance().removeGroup(m_group);
+        }
+    }
+    PerfCounters::Group *m_group;
+    bool m_tried;
+};
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the group of the calling thread
+static PerfThread &thisThread()
+{
+    static thread_local PerfThread t_thread;
+    return t_thread;
+}
+//----------------------------------------------------------------------------------------------------------------------
+PerfCounters &PerfCounters::instance()
+{
+    static PerfCounters counters;
+    return counters;
+}
+//----------------------------------------------------------------------------------------------------------------------
+bool PerfCounters::isEnabled()
+{
+#ifdef FLOCK_PERF
+    return true;
+#else
+    return false;
+#endif
+}
+//----------------------------------------------------------------------------------------------------------------------
+const char *PerfCounters::name(Phase _phase)
+{
+    static const char *names[PHASES] = {"update", "collisions", "neighbours", "steer"};
+    return _phase >= 0 && _phase < PHASES ? names[_phase] : "unknown";
+}
+//----------------------------------------------------------------------------------------------------------------------
+const char *PerfCounters::name(Counter _counter)
+{
+    static const char *names[COUNTERS] = {"cycles", "instructions", "llc_misses", "branch_misses"};
+    return _counter >= 0 && _counter < COUNTERS ? names[_counter] : "unknown";
+}
+//----------------------------------------------------------------------------------------------------------------------
+PerfCounters::PerfCounters()
+{
+    reset();
+}
+//----------------------------------------------------------------------------------------------------------------------
+void PerfCounters::reset()
+{
+    std::lock_guard <std::mutex> lock(m_mutex);
+    std::memset(m_samples, 0, sizeof(m_samples));
+    std::memset(m_totals, 0, sizeof(m_totals));
+}
+//----------------------------------------------------------------------------------------------------------------------
+std::string PerfCounters::getError() const
+{
+    std::lock_guard <std::mutex> lock(m_mutex);
+    return m_error;
+}
+//----------------------------------------------------------------------------------------------------------------------
+bool PerfCounters::addThread()
+{
+    PerfThread &thread = thisThread();
+    if(!thread.m_tried)
+    {
+        // a thread that failed once is not asked again, it would fail on every scope
+        thread.m_tried = true;
+        thread.m_group = openGroup();
+        if(thread.m_group != 0)
+        {
+            std::lock_guard <std::mutex> lock(m_mutex);
+            m_groups.push_back(thread.m_group);
+        }
+    }
+    return thread.m_group != 0;
+}
+//----------------------------------------------------------------------------------------------------------------------
+#ifdef __linux__
+/// @brief opens one counter of the calling thread, in the group of _leader or as a leader if it is -1
+static int openCounter(uint32_t _type, uint64_t _config, int _leader)
+{
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = _type;
+    attr.config = _config;
+    attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    // user space only, which perf_event_paranoid 2 still allows
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return (int)syscall(__NR_perf_event_open, &attr, 0, -1, _leader, 0);
+}
+#endif
+//----------------------------------------------------------------------------------------------------------------------
+PerfCounters::Group *PerfCounters::openGroup()
+{
+#ifdef __linux__
+    int leader = openCounter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, -1);
+    if(leader < 0)
+    {
+        int code = errno;
+        char error[256];
+        std::snprintf(error, sizeof(error), "perf_event_open failed: %s%s", std::strerror(code),
+                      code == EACCES || code == EPERM ? ", check /proc/sys/kernel/perf_event_paranoid" :
+                      (code == ENOENT || code == ENODEV ? ", the CPU or the VM has no hardware counters" : ""));
+        std::lock_guard <std::mutex> lock(m_mutex);
+        m_error = error;
+        return 0;
+    }
+    Group *group = new Group;
+    group->m_leader = leader;
+    group->m_fds.push_back(leader);
+    group->m_counter.push_back(CYCLES);
+    std::memset(group->m_open, 0, sizeof(group->m_open));
+    group->m_open[CYCLES] = true;
+
+    // the generic cache miss event is the last level on most CPUs, it stands in where LLC loads are not exposed
+    const uint64_t llcLoadMisses = PERF_COUNT_HW_CACHE_LL | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    int fds[COUNTERS];
+    fds[CYCLES] = leader;
+    fds[INSTRUCTIONS] = openCounter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS, leader);
+    fds[LLC_MISSES] = openCounter(PERF_TYPE_HW_CACHE, llcLoadMisses, leader);
+    if(fds[LLC_MISSES] < 0)
+    {
+        fds[LLC_MISSES] = openCounter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES, leader);
+    }
+    fds[BRANCH_MISSES] = openCounter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES, leader);
+    for(int c=INSTRUCTIONS; c<COUNTERS; ++c)
+    {
+        if(fds[c] >= 0)
+        {
+            group->m_fds.push_back(fds[c]);
+            group->m_counter.push_back(c);
+            group->m_open[c] = true;
+        }
+    }
+    ioctl(leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    return group;
+#else
+    std::lock_guard <std::mutex> lock(m_mutex);
+    m_error = "hardware counters need the Linux perf_event_open";
+    return 0;
+#endif
+}
+//----------------------------------------------------------------------------------------------------------------------
+void PerfCounters::removeGroup(Group *_group)
+{
+    {
+        std::lock_guard <std::mutex> lock(m_mutex);
+        for(unsigned int i=0; i<m_groups.size(); ++i)
+        {
+            if(m_groups[i] == _group)
+            {
+                m_groups.erase(m_groups.begin() + i);
+                break;
+            }
+        }
+    }
+#ifdef __linux__
+    for(unsigned int i=0; i<_group->m_fds.size(); ++i)
+    {
+        close(_group->m_fds[i]);
+    }
+#endif
+    delete _group;
+}
+//----------------------------------------------------------------------------------------------------------------------
+void PerfCounters::readGroup(const Group &_group, double _values[COUNTERS])
+{
+#ifdef __linux__
+    // nr, time enabled, time running and a value per counter
+    uint64_t data[3 + COUNTERS];
+    ssize_t size = ::read(_group.m_leader, data, sizeof(data));
+    if(size < (ssize_t)(3 * sizeof(uint64_t)) || data[0] != _group.m_counter.size() || data[2] == 0)
+    {
+        return;
+    }
+    // the group only ran part of the time the kernel shared the counters, the counts are scaled up to the whole
+    double scale = (double)data[1] / data[2];
+    for(uint64_t i=0; i<data[0]; ++i)
+    {
+        _values[_group.m_counter[i]] += data[3 + i] * scale;
+    }
+#else
+    (void)_group;
+    (void)_values;
+#endif
+}
+//----------------------------------------------------------------------------------------------------------------------
+void PerfCounters::read(double _values[COUNTERS])
+{
+    addThread();
+    std::memset(_values, 0, COUNTERS * sizeof(double));
+    std::lock_guard <std::mutex> lock(m_mutex);
+    for(unsigned int g=0; g<m_groups.size(); ++g)
+    {
+        readGroup(*m_groups[g], _values);
+    }
+}
+//----------------------------------------------------------------------------------------------------------------------
+void PerfCounters::add(Phase _phase, const double _start[COUNTERS], const double _end[COUNTERS])
+{
+    std::lock_guard <std::mutex> lock(m_mutex);
+    if(m_groups.empty())
+    {
+        return;
+    }
+    ++m_samples[_phase];
+    for(int c=0; c<COUNTERS; ++c)
+    {
+        m_totals[_phase][c] += _end[c] - _start[c];
+    }
+}
+//----------------------------------------------------------------------------------------------------------------------
+PerfCounters::Stats PerfCounters::getStats(Phase _phase) const
+{
+    Stats stats;
+    std::lock_guard <std::mutex> lock(m_mutex);
+    stats.m_samples = m_samples[_phase];
+    for(int c=0; c<COUNTERS; ++c)
+    {
+        stats.m_totals[c] = m_totals[_phase][c];
+        // a counter only adds up if every thread has it
+        stats.m_valid[c] = !m_groups.empty();
+        for(unsigned int g=0; g<m_groups.size(); ++g)
+        {
+            stats.m_valid[c] = stats.m_valid[c] && m_groups[g]->m_open[c];
+        }
+    }
+    return stats;
+}
+//----------------------------------------------------------------------------------------------------------------------
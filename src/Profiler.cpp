@@ -0,0 +1,143 @@
+#include "Profiler.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+//----------------------------------------------------------------------------------------------------------------------
+Profiler &Profiler::instance()
+{
+    static Profiler profiler;
+    return profiler;
+}
+//----------------------------------------------------------------------------------------------------------------------
+bool Profiler::isEnabled()
+{
+#ifdef FLOCK_PROFILE
+    return true;
+#else
+    return false;
+#endif
+}
+//----------------------------------------------------------------------------------------------------------------------
+const char *Profiler::name(Phase _phase)
+{
+    static const char *names[PHASES] = {"update", "collisions", "neighbours", "steer", "publish", "flock_draw", "obstacle_draw"};
+    return _phase >= 0 && _phase < PHASES ? names[_phase] : "unknown";
+}
+//----------------------------------------------------------------------------------------------------------------------
+Profiler::Profiler()
+{
+    reset();
+}
+//----------------------------------------------------------------------------------------------------------------------
+void Profiler::reset()
+{
+    std::lock_guard <std::mutex> lock(m_mutex);
+    std::memset(m_windows, 0, sizeof(m_windows));
+}
+//----------------------------------------------------------------------------------------------------------------------
+int Profiler::bucket(double _ms)
+{
+    double microseconds = _ms * 1000.0;
+    if(!(microseconds >= 2.0))
+    {
+        return 0;
+    }
+    return std::min((int)std::log2(microseconds), s_buckets - 1);
+}
+//----------------------------------------------------------------------------------------------------------------------
+void Profiler::add(Phase _phase, double _ms)
+{
+    std::lock_guard <std::mutex> lock(m_mutex);
+    Window &window = m_windows[_phase];
+    if(window.m_count == s_window)
+    {
+        // the oldest time is in the slot about to be written
+        --window.m_histogram[bucket(window.m_times[window.m_next])];
+    }
+    else
+    {
+        ++window.m_count;
+    }
+    window.m_times[window.m_next] = _ms;
+    ++window.m_histogram[bucket(_ms)];
+    window.m_next = (window.m_next + 1) % s_window;
+    ++window.m_total;
+}
+//----------------------------------------------------------------------------------------------------------------------
+Profiler::Stats Profiler::getStats(Phase _phase) const
+{
+    Stats stats;
+    std::memset(&stats, 0, sizeof(stats));
+    double times[s_window];
+    {
+        std::lock_guard <std::mutex> lock(m_mutex);
+        const Window &window = m_windows[_phase];
+        stats.m_samples = window.m_count;
+        stats.m_total = window.m_total;
+        std::memcpy(stats.m_histogram, window.m_histogram, sizeof(stats.m_histogram));
+        std::memcpy(times, window.m_times, window.m_count * sizeof(double));
+        if(window.m_count > 0)
+        {
+            stats.m_lastMs = window.m_times[(window.m_next + s_window - 1) % s_window];
+        }
+    }
+    const int count = stats.m_samples;
+    if(count == 0)
+    {
+        return stats;
+    }
+    std::sort(times, times + count);
+    for(int i=0; i<count; ++i)
+    {
+        stats.m_meanMs += times[i];
+    }
+    stats.m_meanMs /= count;
+    stats.m_minMs = times[0];
+    stats.m_maxMs = times[count - 1];
+    // nearest rank
+    stats.m_p50Ms = times[std::max((int)std::ceil(0.5 * count) - 1, 0)];
+    stats.m_p99Ms = times[std::max((int)std::ceil(0.99 * count) - 1, 0)];
+    return stats;
+}
+//----------------------------------------------------------------------------------------------------------------------
+bool Profiler::writeJson(const std::string &_file) const
+{
+    FILE *file = _file == "-" ? stdout : std::fopen(_file.c_str(), "w");
+    if(file == 0)
+    {
+        return false;
+    }
+    std::fprintf(file, "{\n");
+    std::fprintf(file, "  \"enabled\": %s,\n", isEnabled() ? "true" : "false");
+    std::fprintf(file, "  \"window\": %d,\n", s_window);
+    std::fprintf(file, "  \"bucket_floor_us\": [");
+    for(int b=0; b<s_buckets; ++b)
+    {
+        std::fprintf(file, "%s%lu", b > 0 ? ", " : "", b == 0 ? 0ul : 1ul << b);
+    }
+    std::fprintf(file, "],\n");
+    std::fprintf(file, "  \"phases\": {\n");
+    for(int p=0; p<PHASES; ++p)
+    {
+        Stats stats = getStats((Phase)p);
+        std::fprintf(file, "    \"%s\": {\"samples\": %d, \"total\": %llu, \"last_ms\": %.4f, \"mean_ms\": %.4f, \"min_ms\": %.4f, "
+                     "\"max_ms\": %.4f, \"p50_ms\": %.4f, \"p99_ms\": %.4f, \"histogram\": [",
+                     name((Phase)p), stats.m_samples, (unsigned long long)stats.m_total, stats.m_lastMs, stats.m_meanMs,
+                     stats.m_minMs, stats.m_maxMs, stats.m_p50Ms, stats.m_p99Ms);
+        for(int b=0; b<s_buckets; ++b)
+        {
+            std::fprintf(file, "%s%d", b > 0 ? ", " : "", stats.m_histogram[b]);
+        }
+        std::fprintf(file, "]}%s\n", p + 1 < PHASES ? "," : "");
+    }
+    std::fprintf(file, "  }\n}\n");
+    bool good = !std::ferror(file);
+    if(file != stdout)
+    {
+        good = std::fclose(file) == 0 && good;
+    }
+    return good;
+}
+//----------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,222 @@
+#include "RansCoder.h"
+#include <algorithm>
+#include <cstring>
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the lower bound of the coder state, it is renormalised a byte at a time to stay above it
+const static uint32_t s_ransLow = 1u << 23;
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the bit length of every byte, 0 for 0
+static const struct ByteLengths
+{
+    uint8_t m_length[256];
+    ByteLengths()
+    {
+        m_length[0] = 0;
+        for(int i=1; i<256; ++i)
+        {
+            m_length[i] = (uint8_t)(m_length[i >> 1] + 1);
+        }
+    }
+} s_byteLengths;
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the bit length of a value, 0 for 0
+static inline int bitLength(uint16_t _value)
+{
+    return _value >= 256 ? 8 + s_byteLengths.m_length[_value >> 8] : s_byteLengths.m_length[_value];
+}
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief scales the counts of the lengths so they add up to 1 << s_scaleBits, every length that occurs keeps
+/// at least 1
+static void normalise(const uint32_t *_counts, int _total, uint16_t *_frequencies)
+{
+    const int scale = 1 << RansCoder::s_scaleBits;
+    int sum = 0;
+    int largest = 0;
+    for(int s=0; s<RansCoder::s_symbols; ++s)
+    {
+        _frequencies[s] = 0;
+        if(_counts[s] > 0)
+        {
+            _frequencies[s] = (uint16_t)std::max<uint64_t>(1, (uint64_t)_counts[s] * scale / _total);
+            sum += _frequencies[s];
+            if(_counts[s] > _counts[largest])
+            {
+                largest = s;
+            }
+        }
+    }
+    // the rounding is settled on the most common length, which can take it with the least loss. The rounding
+    // is less than one per length, far below the share of the most common one.
+    _frequencies[largest] = (uint16_t)(_frequencies[largest] + scale - sum);
+}
+//----------------------------------------------------------------------------------------------------------------------
+void RansCoder::encode(const uint16_t *_values, int _count, std::vector <uint8_t> &_out)
+{
+    // the lengths are found once, they are needed for the counts, the coding and the low bits
+    std::vector <uint8_t> lengths(_count);
+    uint32_t counts[s_symbols] = {0};
+    uint32_t lowBits = 0;
+    for(int i=0; i<_count; ++i)
+    {
+        int length = bitLength(_values[i]);
+        lengths[i] = (uint8_t)length;
+        ++counts[length];
+        lowBits += length > 1 ? length - 1 : 0;
+    }
+    uint16_t frequencies[s_symbols];
+    if(_count > 0)
+    {
+        normalise(counts, _count, frequencies);
+    }
+    else
+    {
+        std::fill(frequencies, frequencies + s_symbols, 0);
+        frequencies[0] = 1 << s_scaleBits;
+    }
+    uint32_t starts[s_symbols];
+    uint32_t start = 0;
+    for(int s=0; s<s_symbols; ++s)
+    {
+        starts[s] = start;
+        start += frequencies[s];
+    }
+
+    // rANS works as a stack, the values are coded last to first into the end of a buffer so they come out
+    // first to last. A symbol puts out at most two bytes, the smallest frequency is 1.
+    std::vector <uint8_t> buffer(2 * (size_t)_count + 4);
+    uint8_t *end = &buffer[0] + buffer.size();
+    uint8_t *stream = end;
+    uint32_t state = s_ransLow;
+    for(int i=_count - 1; i>=0; --i)
+    {
+        int symbol = lengths[i];
+        uint32_t frequency = frequencies[symbol];
+        uint32_t limit = ((s_ransLow >> s_scaleBits) << 8) * frequency;
+        while(state >= limit)
+        {
+            *--stream = (uint8_t)(state & 0xff);
+            state >>= 8;
+        }
+        state = ((state / frequency) << s_scaleBits) + (state % frequency) + starts[symbol];
+    }
+    // the state goes first, most significant byte first
+    for(int b=0; b<4; ++b)
+    {
+        *--stream = (uint8_t)(state >> (8 * b));
+    }
+
+    const uint32_t streamBytes = (uint32_t)(end - stream);
+    size_t at = _out.size();
+    _out.resize(at + sizeof(frequencies) + sizeof(uint32_t) + streamBytes + (lowBits + 7) / 8);
+    uint8_t *out = &_out[at];
+    std::memcpy(out, frequencies, sizeof(frequencies));
+    out += sizeof(frequencies);
+    std::memcpy(out, &streamBytes, sizeof(streamBytes));
+    out += sizeof(streamBytes);
+    std::memcpy(out, stream, streamBytes);
+    out += streamBytes;
+
+    // the bits below the leading one of every value, least significant first
+    uint64_t bits = 0;
+    int used = 0;
+    for(int i=0; i<_count; ++i)
+    {
+        int length = lengths[i];
+        if(length > 1)
+        {
+            bits |= (uint64_t)(_values[i] & ((1u << (length - 1)) - 1)) << used;
+            used += length - 1;
+            while(used >= 8)
+            {
+                *out++ = (uint8_t)(bits & 0xff);
+                bits >>= 8;
+                used -= 8;
+            }
+        }
+    }
+    if(used > 0)
+    {
+        *out++ = (uint8_t)bits;
+    }
+}
+//----------------------------------------------------------------------------------------------------------------------
+bool RansCoder::decode(const uint8_t *_data, uint64_t _bytes, uint16_t *_values, int _count)
+{
+    uint16_t frequencies[s_symbols];
+    uint32_t streamBytes;
+    if(_bytes < sizeof(frequencies) + sizeof(streamBytes))
+    {
+        return false;
+    }
+    std::memcpy(frequencies, _data, sizeof(frequencies));
+    std::memcpy(&streamBytes, _data + sizeof(frequencies), sizeof(streamBytes));
+    const uint8_t *stream = _data + sizeof(frequencies) + sizeof(streamBytes);
+    const uint8_t *streamEnd = stream + streamBytes;
+    const uint8_t *end = _data + _bytes;
+    if(streamBytes < 4 || streamBytes > (uint64_t)(end - stream))
+    {
+        return false;
+    }
+
+    // the length of every slot of the frequency range, so a decode step is a table lookup
+    uint8_t slots[1 << s_scaleBits];
+    uint32_t starts[s_symbols];
+    uint32_t start = 0;
+    for(int s=0; s<s_symbols; ++s)
+    {
+        starts[s] = start;
+        if(start + frequencies[s] > (1u << s_scaleBits))
+        {
+            return false;
+        }
+        std::fill(slots + start, slots + start + frequencies[s], (uint8_t)s);
+        start += frequencies[s];
+    }
+    if(start != (1u << s_scaleBits))
+    {
+        return false;
+    }
+
+    uint32_t state = (uint32_t)stream[0] << 24 | (uint32_t)stream[1] << 16 | (uint32_t)stream[2] << 8 | stream[3];
+    stream += 4;
+    const uint32_t mask = (1u << s_scaleBits) - 1;
+    for(int i=0; i<_count; ++i)
+    {
+        uint32_t slot = state & mask;
+        int symbol = slots[slot];
+        state = frequencies[symbol] * (state >> s_scaleBits) + slot - starts[symbol];
+        while(state < s_ransLow && stream < streamEnd)
+        {
+            state = (state << 8) | *stream++;
+        }
+        // the length is kept in the value for now, the low bits are added below
+        _values[i] = (uint16_t)symbol;
+    }
+
+    const uint8_t *bits = streamEnd;
+    uint64_t buffer = 0;
+    int held = 0;
+    for(int i=0; i<_count; ++i)
+    {
+        int length = _values[i];
+        if(length <= 1)
+        {
+            continue;
+        }
+        while(held < length - 1)
+        {
+            if(bits == end)
+            {
+                return false;
+            }
+            buffer |= (uint64_t)(*bits++) << held;
+            held += 8;
+        }
+        _values[i] = (uint16_t)((1u << (length - 1)) | (buffer & ((1u << (length - 1)) - 1)));
+        buffer >>= length - 1;
+        held -= length - 1;
+    }
+    return true;
+}
+//----------------------------------------------------------------------------------------------------------------------
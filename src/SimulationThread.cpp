@@ -0,0 +1,155 @@
+#include "SimulationThread.h"
+#include "Profiler.h"
+#include "Tracer.h"
+#include <chrono>
+#include <iostream>
+#include <new>
+
+SimulationThread::SimulationThread(Flock *_flock, double _stepSeconds)
+{
+    m_flock = _flock;
+    m_stepSeconds = _stepSeconds;
+    m_quit = false;
+    m_paused = false;
+    m_recording = false;
+    m_recordingFailed = false;
+    m_outOfMemory = -1;
+}
+//----------------------------------------------------------------------------------------------------------------------
+SimulationThread::~SimulationThread()
+{
+    stop();
+}
+//----------------------------------------------------------------------------------------------------------------------
+void SimulationThread::start()
+{
+    if(m_thread.joinable())
+    {
+        return;
+    }
+    m_quit = false;
+    m_thread = std::thread(&SimulationThread::run, this);
+}
+//----------------------------------------------------------------------------------------------------------------------
+void SimulationThread::stop()
+{
+    m_quit = true;
+    if(m_thread.joinable())
+    {
+        m_thread.join();
+    }
+    // the writer finishes the queued frames and the index once no step can add to them
+    closeRecording();
+    m_recording = false;
+}
+//----------------------------------------------------------------------------------------------------------------------
+void SimulationThread::post(const Command &_command)
+{
+    std::lock_guard <std::mutex> lock(m_commandMutex);
+    m_commands.push_back(_command);
+}
+//----------------------------------------------------------------------------------------------------------------------
+void SimulationThread::startRecording(const std::string &_file)
+{
+    m_recording = true;
+    post([this, _file](Flock &)
+    {
+        m_recording = m_recorder.open(_file);
+    });
+}
+//----------------------------------------------------------------------------------------------------------------------
+void SimulationThread::stopRecording()
+{
+    m_recording = false;
+    post([this](Flock &)
+    {
+        closeRecording();
+    });
+}
+//----------------------------------------------------------------------------------------------------------------------
+void SimulationThread::closeRecording()
+{
+    if(m_recorder.isOpen() && !m_recorder.close())
+    {
+        std::cerr<<"the recording could not be written in full, it has no frame index\n";
+        m_recordingFailed = true;
+    }
+}
+//----------------------------------------------------------------------------------------------------------------------
+bool SimulationThread::runCommands()
+{
+    std::vector <Command> commands;
+    {
+        std::lock_guard <std::mutex> lock(m_commandMutex);
+        commands.swap(m_commands);
+    }
+    for(unsigned int i=0; i<commands.size(); ++i)
+    {
+        try
+        {
+            commands[i](*m_flock);
+        }
+        catch(const std::bad_alloc &)
+        {
+            // a flock too large for memory drops the command instead of ending the program
+            std::cerr<<"out of memory, the flock keeps its "<<m_flock->getState().size()<<" boids\n";
+            m_outOfMemory = m_flock->getState().size();
+        }
+    }
+    return !commands.empty();
+}
+//----------------------------------------------------------------------------------------------------------------------
+bool SimulationThread::takeOutOfMemory(int &_boids)
+{
+    _boids = m_outOfMemory.exchange(-1);
+    return _boids >= 0;
+}
+//----------------------------------------------------------------------------------------------------------------------
+void SimulationThread::publishFrame()
+{
+    FLOCK_PROFILE_SCOPE(PUBLISH);
+    FLOCK_TRACE_SCOPE("publish");
+    m_frames.back().copyDrawData(m_flock->getState());
+    m_frames.publish();
+}
+//----------------------------------------------------------------------------------------------------------------------
+void SimulationThread::run()
+{
+    FLOCK_TRACE_THREAD("simulation");
+    typedef std::chrono::steady_clock Clock;
+    const Clock::duration step = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(m_stepSeconds));
+
+    publishFrame();
+    Clock::time_point next = Clock::now();
+    while(!m_quit)
+    {
+        bool changed = runCommands();
+        if(!m_paused)
+        {
+            m_flock->update();
+            changed = true;
+            if(m_recorder.isOpen())
+            {
+                // only the copy happens here, a full queue drops the frame rather than wait for the disk
+                m_recorder.record(m_flock->getState());
+            }
+        }
+        if(changed)
+        {
+            publishFrame();
+        }
+
+        next += step;
+        Clock::time_point now = Clock::now();
+        if(next < now)
+        {
+            // the step took longer than the time step, carry on from now instead of running the missed steps
+            next = now;
+        }
+        else
+        {
+            std::this_thread::sleep_until(next);
+        }
+    }
+}
+//----------------------------------------------------------------------------------------------------------------------
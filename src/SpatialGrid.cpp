@@ -0,0 +1,115 @@
+#include "SpatialGrid.h"
+#include <algorithm>
+#include <cmath>
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the smallest cell we allow, stops the cell coordinates overflowing for tiny behaviour distances.
+const static float s_minCellSize = 1.0f;
+//----------------------------------------------------------------------------------------------------------------------
+SpatialGrid::SpatialGrid()
+{
+    m_cellSize = s_minCellSize;
+    m_invCellSize = 1.0f / s_minCellSize;
+    m_tableMask = 0;
+}
+//----------------------------------------------------------------------------------------------------------------------
+int SpatialGrid::cellCoord(float _value) const
+{
+    return (int)std::floor(_value * m_invCellSize);
+}
+//----------------------------------------------------------------------------------------------------------------------
+unsigned int SpatialGrid::hashCell(int _x, int _y, int _z) const
+{
+    // large primes from Teschner et al. "Optimized Spatial Hashing for Collision Detection of Deformable Objects"
+    return (((unsigned int)_x * 73856093u) ^ ((unsigned int)_y * 19349663u) ^ ((unsigned int)_z * 83492791u)) & m_tableMask;
+}
+//----------------------------------------------------------------------------------------------------------------------
+void SpatialGrid::rebuild(const FlockState &_state, float _cellSize)
+{
+    if(_state.size() == 0)
+    {
+        rebuild(0, 0, 0, 0, _cellSize);
+        return;
+    }
+    rebuild(&_state.m_posX[0], &_state.m_posY[0], &_state.m_posZ[0], _state.size(), _cellSize);
+}
+//----------------------------------------------------------------------------------------------------------------------
+void SpatialGrid::rebuild(const float *_x, const float *_y, const float *_z, int _count, float _cellSize)
+{
+    m_cellSize = std::max(_cellSize, s_minCellSize);
+    m_invCellSize = 1.0f / m_cellSize;
+
+    // twice as many buckets as boids keeps the collisions between cells low
+    unsigned int boidCount = _count;
+    unsigned int tableSize = 64;
+    while(tableSize < 2 * boidCount)
+    {
+        tableSize <<= 1;
+    }
+    m_tableMask = tableSize - 1;
+
+    m_cellStart.assign(tableSize + 1, 0);
+    m_boidBucket.resize(boidCount);
+    m_sortedBoids.resize(boidCount);
+
+    // count the boids in each bucket
+    for(unsigned int i=0; i<boidCount; ++i)
+    {
+        unsigned int bucket = hashCell(cellCoord(_x[i]), cellCoord(_y[i]), cellCoord(_z[i]));
+        m_boidBucket[i] = bucket;
+        ++m_cellStart[bucket + 1];
+    }
+    // turn the counts into the start of every bucket
+    for(unsigned int i=0; i<tableSize; ++i)
+    {
+        m_cellStart[i + 1] += m_cellStart[i];
+    }
+    // and scatter the boids, m_cellStart is shifted back to the bucket starts at the end
+    for(unsigned int i=0; i<boidCount; ++i)
+    {
+        m_sortedBoids[m_cellStart[m_boidBucket[i]]++] = i;
+    }
+    for(unsigned int i=tableSize; i>0; --i)
+    {
+        m_cellStart[i] = m_cellStart[i - 1];
+    }
+    m_cellStart[0] = 0;
+}
+//----------------------------------------------------------------------------------------------------------------------
+void SpatialGrid::gatherNeighbours(const ngl::Vector &_position, std::vector <int> &_neighbours) const
+{
+    _neighbours.clear();
+    if(m_sortedBoids.empty())
+    {
+        return;
+    }
+
+    int cx = cellCoord(_position.m_x);
+    int cy = cellCoord(_position.m_y);
+    int cz = cellCoord(_position.m_z);
+
+    // two of the surrounding cells can hash to the same bucket, so the buckets are made unique
+    // before visiting them otherwise a boid would be counted twice.
+    unsigned int buckets[27];
+    int bucketCount = 0;
+    for(int z=-1; z<=1; ++z)
+    {
+        for(int y=-1; y<=1; ++y)
+        {
+            for(int x=-1; x<=1; ++x)
+            {
+                buckets[bucketCount++] = hashCell(cx + x, cy + y, cz + z);
+            }
+        }
+    }
+    std::sort(buckets, buckets + bucketCount);
+    bucketCount = std::unique(buckets, buckets + bucketCount) - buckets;
+
+    for(int i=0; i<bucketCount; ++i)
+    {
+        _neighbours.insert(_neighbours.end(),
+                           m_sortedBoids.begin() + m_cellStart[buckets[i]],
+                           m_sortedBoids.begin() + m_cellStart[buckets[i] + 1]);
+    }
+}
+//----------------------------------------------------------------------------------------------------------------------
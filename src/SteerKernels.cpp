@@ -0,0 +1,400 @@
+#include "SteerKernels.h"
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+    #define FLOCK_X86 1
+    #include <immintrin.h>
+#endif
+
+//----------------------------------------------------------------------------------------------------------------------
+const float SteerKernels::s_farAway = 1.0e18f;
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the rules that need the neighbours within the behaviour distance and their count
+static const int s_nearRules = SteerKernels::COHESION | SteerKernels::ALIGNMENT;
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the reference kernel, one candidate at a time
+template <int Rules>
+static void accumulateScalar(const NeighbourBatch &_batch,
+                             float _px, float _py, float _pz,
+                             float _behaviourDistanceSq, float _flockDistanceSq,
+                             NeighbourSums &_sums)
+{
+    std::memset(&_sums, 0, sizeof(NeighbourSums));
+    for(int i=0; i<_batch.m_count; ++i)
+    {
+        float dx = _px - _batch.m_x[i];
+        float dy = _py - _batch.m_y[i];
+        float dz = _pz - _batch.m_z[i];
+        float distanceSq = dx * dx + dy * dy + dz * dz;
+
+        if((Rules & s_nearRules) && distanceSq < _behaviourDistanceSq)
+        {
+            if(Rules & SteerKernels::COHESION)
+            {
+                _sums.m_cohesionX += _batch.m_x[i];
+                _sums.m_cohesionY += _batch.m_y[i];
+                _sums.m_cohesionZ += _batch.m_z[i];
+            }
+            if(Rules & SteerKernels::ALIGNMENT)
+            {
+                _sums.m_alignmentX += _batch.m_vx[i];
+                _sums.m_alignmentY += _batch.m_vy[i];
+                _sums.m_alignmentZ += _batch.m_vz[i];
+            }
+            ++_sums.m_count;
+        }
+        if((Rules & SteerKernels::SEPARATION) && distanceSq < _flockDistanceSq)
+        {
+            _sums.m_separationX -= dx;
+            _sums.m_separationY -= dy;
+            _sums.m_separationZ -= dz;
+        }
+    }
+}
+
+#ifdef FLOCK_X86
+//----------------------------------------------------------------------------------------------------------------------
+static inline float horizontalSum(__m128 _v)
+{
+    __m128 shuffled = _mm_shuffle_ps(_v, _v, _MM_SHUFFLE(2, 3, 0, 1));
+    __m128 sums = _mm_add_ps(_v, shuffled);
+    shuffled = _mm_movehl_ps(shuffled, sums);
+    sums = _mm_add_ss(sums, shuffled);
+    return _mm_cvtss_f32(sums);
+}
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief 4 candidates per instruction, SSE is part of the x86_64 baseline so this needs no dispatch guard.
+template <int Rules>
+static void accumulateSSE(const NeighbourBatch &_batch,
+                          float _px, float _py, float _pz,
+                          float _behaviourDistanceSq, float _flockDistanceSq,
+                          NeighbourSums &_sums)
+{
+    const __m128 px = _mm_set1_ps(_px);
+    const __m128 py = _mm_set1_ps(_py);
+    const __m128 pz = _mm_set1_ps(_pz);
+    const __m128 behaviourDistanceSq = _mm_set1_ps(_behaviourDistanceSq);
+    const __m128 flockDistanceSq = _mm_set1_ps(_flockDistanceSq);
+    const __m128 one = _mm_set1_ps(1.0f);
+    __m128 cohesionX = _mm_setzero_ps(), cohesionY = _mm_setzero_ps(), cohesionZ = _mm_setzero_ps();
+    __m128 alignmentX = _mm_setzero_ps(), alignmentY = _mm_setzero_ps(), alignmentZ = _mm_setzero_ps();
+    __m128 separationX = _mm_setzero_ps(), separationY = _mm_setzero_ps(), separationZ = _mm_setzero_ps();
+    __m128 count = _mm_setzero_ps();
+
+    for(int i=0; i<_batch.m_count; i+=4)
+    {
+        __m128 x = _mm_loadu_ps(_batch.m_x + i);
+        __m128 y = _mm_loadu_ps(_batch.m_y + i);
+        __m128 z = _mm_loadu_ps(_batch.m_z + i);
+        __m128 dx = _mm_sub_ps(px, x);
+        __m128 dy = _mm_sub_ps(py, y);
+        __m128 dz = _mm_sub_ps(pz, z);
+        __m128 distanceSq = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+        __m128 near = _mm_cmplt_ps(distanceSq, behaviourDistanceSq);
+        __m128 close = _mm_cmplt_ps(distanceSq, flockDistanceSq);
+
+        if(Rules & SteerKernels::COHESION)
+        {
+            cohesionX = _mm_add_ps(cohesionX, _mm_and_ps(near, x));
+            cohesionY = _mm_add_ps(cohesionY, _mm_and_ps(near, y));
+            cohesionZ = _mm_add_ps(cohesionZ, _mm_and_ps(near, z));
+        }
+        if(Rules & SteerKernels::ALIGNMENT)
+        {
+            alignmentX = _mm_add_ps(alignmentX, _mm_and_ps(near, _mm_loadu_ps(_batch.m_vx + i)));
+            alignmentY = _mm_add_ps(alignmentY, _mm_and_ps(near, _mm_loadu_ps(_batch.m_vy + i)));
+            alignmentZ = _mm_add_ps(alignmentZ, _mm_and_ps(near, _mm_loadu_ps(_batch.m_vz + i)));
+        }
+        if(Rules & s_nearRules)
+        {
+            count = _mm_add_ps(count, _mm_and_ps(near, one));
+        }
+        if(Rules & SteerKernels::SEPARATION)
+        {
+            separationX = _mm_sub_ps(separationX, _mm_and_ps(close, dx));
+            separationY = _mm_sub_ps(separationY, _mm_and_ps(close, dy));
+            separationZ = _mm_sub_ps(separationZ, _mm_and_ps(close, dz));
+        }
+    }
+
+    _sums.m_cohesionX = horizontalSum(cohesionX);
+    _sums.m_cohesionY = horizontalSum(cohesionY);
+    _sums.m_cohesionZ = horizontalSum(cohesionZ);
+    _sums.m_alignmentX = horizontalSum(alignmentX);
+    _sums.m_alignmentY = horizontalSum(alignmentY);
+    _sums.m_alignmentZ = horizontalSum(alignmentZ);
+    _sums.m_separationX = horizontalSum(separationX);
+    _sums.m_separationY = horizontalSum(separationY);
+    _sums.m_separationZ = horizontalSum(separationZ);
+    _sums.m_count = (int)(horizontalSum(count) + 0.5f);
+}
+//----------------------------------------------------------------------------------------------------------------------
+__attribute__((target("avx2")))
+static inline float horizontalSum(__m256 _v)
+{
+    return horizontalSum(_mm_add_ps(_mm256_castps256_ps128(_v), _mm256_extractf128_ps(_v, 1)));
+}
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief 8 candidates per instruction, only called when CPUID reports AVX2
+template <int Rules>
+__attribute__((target("avx2")))
+static void accumulateAVX2(const NeighbourBatch &_batch,
+                           float _px, float _py, float _pz,
+                           float _behaviourDistanceSq, float _flockDistanceSq,
+                           NeighbourSums &_sums)
+{
+    const __m256 px = _mm256_set1_ps(_px);
+    const __m256 py = _mm256_set1_ps(_py);
+    const __m256 pz = _mm256_set1_ps(_pz);
+    const __m256 behaviourDistanceSq = _mm256_set1_ps(_behaviourDistanceSq);
+    const __m256 flockDistanceSq = _mm256_set1_ps(_flockDistanceSq);
+    const __m256 one = _mm256_set1_ps(1.0f);
+    __m256 cohesionX = _mm256_setzero_ps(), cohesionY = _mm256_setzero_ps(), cohesionZ = _mm256_setzero_ps();
+    __m256 alignmentX = _mm256_setzero_ps(), alignmentY = _mm256_setzero_ps(), alignmentZ = _mm256_setzero_ps();
+    __m256 separationX = _mm256_setzero_ps(), separationY = _mm256_setzero_ps(), separationZ = _mm256_setzero_ps();
+    __m256 count = _mm256_setzero_ps();
+
+    for(int i=0; i<_batch.m_count; i+=8)
+    {
+        __m256 x = _mm256_loadu_ps(_batch.m_x + i);
+        __m256 y = _mm256_loadu_ps(_batch.m_y + i);
+        __m256 z = _mm256_loadu_ps(_batch.m_z + i);
+        __m256 dx = _mm256_sub_ps(px, x);
+        __m256 dy = _mm256_sub_ps(py, y);
+        __m256 dz = _mm256_sub_ps(pz, z);
+        __m256 distanceSq = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)), _mm256_mul_ps(dz, dz));
+        __m256 near = _mm256_cmp_ps(distanceSq, behaviourDistanceSq, _CMP_LT_OQ);
+        __m256 close = _mm256_cmp_ps(distanceSq, flockDistanceSq, _CMP_LT_OQ);
+
+        if(Rules & SteerKernels::COHESION)
+        {
+            cohesionX = _mm256_add_ps(cohesionX, _mm256_and_ps(near, x));
+            cohesionY = _mm256_add_ps(cohesionY, _mm256_and_ps(near, y));
+            cohesionZ = _mm256_add_ps(cohesionZ, _mm256_and_ps(near, z));
+        }
+        if(Rules & SteerKernels::ALIGNMENT)
+        {
+            alignmentX = _mm256_add_ps(alignmentX, _mm256_and_ps(near, _mm256_loadu_ps(_batch.m_vx + i)));
+            alignmentY = _mm256_add_ps(alignmentY, _mm256_and_ps(near, _mm256_loadu_ps(_batch.m_vy + i)));
+            alignmentZ = _mm256_add_ps(alignmentZ, _mm256_and_ps(near, _mm256_loadu_ps(_batch.m_vz + i)));
+        }
+        if(Rules & s_nearRules)
+        {
+            count = _mm256_add_ps(count, _mm256_and_ps(near, one));
+        }
+        if(Rules & SteerKernels::SEPARATION)
+        {
+            separationX = _mm256_sub_ps(separationX, _mm256_and_ps(close, dx));
+            separationY = _mm256_sub_ps(separationY, _mm256_and_ps(close, dy));
+            separationZ = _mm256_sub_ps(separationZ, _mm256_and_ps(close, dz));
+        }
+    }
+
+    _sums.m_cohesionX = horizontalSum(cohesionX);
+    _sums.m_cohesionY = horizontalSum(cohesionY);
+    _sums.m_cohesionZ = horizontalSum(cohesionZ);
+    _sums.m_alignmentX = horizontalSum(alignmentX);
+    _sums.m_alignmentY = horizontalSum(alignmentY);
+    _sums.m_alignmentZ = horizontalSum(alignmentZ);
+    _sums.m_separationX = horizontalSum(separationX);
+    _sums.m_separationY = horizontalSum(separationY);
+    _sums.m_separationZ = horizontalSum(separationZ);
+    _sums.m_count = (int)(horizontalSum(count) + 0.5f);
+}
+//----------------------------------------------------------------------------------------------------------------------
+__attribute__((target("avx512f")))
+static inline float horizontalSum(__m512 _v)
+{
+    float lanes[16] __attribute__((aligned(64)));
+    _mm512_store_ps(lanes, _v);
+    float sum = 0.0f;
+    for(int i=0; i<16; ++i)
+    {
+        sum += lanes[i];
+    }
+    return sum;
+}
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief 16 candidates per instruction, only called when CPUID reports AVX-512F. The radius tests go into
+/// mask registers and the sums use masked adds.
+template <int Rules>
+__attribute__((target("avx512f")))
+static void accumulateAVX512(const NeighbourBatch &_batch,
+                             float _px, float _py, float _pz,
+                             float _behaviourDistanceSq, float _flockDistanceSq,
+                             NeighbourSums &_sums)
+{
+    const __m512 px = _mm512_set1_ps(_px);
+    const __m512 py = _mm512_set1_ps(_py);
+    const __m512 pz = _mm512_set1_ps(_pz);
+    const __m512 behaviourDistanceSq = _mm512_set1_ps(_behaviourDistanceSq);
+    const __m512 flockDistanceSq = _mm512_set1_ps(_flockDistanceSq);
+    __m512 cohesionX = _mm512_setzero_ps(), cohesionY = _mm512_setzero_ps(), cohesionZ = _mm512_setzero_ps();
+    __m512 alignmentX = _mm512_setzero_ps(), alignmentY = _mm512_setzero_ps(), alignmentZ = _mm512_setzero_ps();
+    __m512 separationX = _mm512_setzero_ps(), separationY = _mm512_setzero_ps(), separationZ = _mm512_setzero_ps();
+    int count = 0;
+
+    for(int i=0; i<_batch.m_count; i+=16)
+    {
+        __m512 x = _mm512_loadu_ps(_batch.m_x + i);
+        __m512 y = _mm512_loadu_ps(_batch.m_y + i);
+        __m512 z = _mm512_loadu_ps(_batch.m_z + i);
+        __m512 dx = _mm512_sub_ps(px, x);
+        __m512 dy = _mm512_sub_ps(py, y);
+        __m512 dz = _mm512_sub_ps(pz, z);
+        __m512 distanceSq = _mm512_add_ps(_mm512_add_ps(_mm512_mul_ps(dx, dx), _mm512_mul_ps(dy, dy)), _mm512_mul_ps(dz, dz));
+        __mmask16 near = _mm512_cmp_ps_mask(distanceSq, behaviourDistanceSq, _CMP_LT_OQ);
+        __mmask16 close = _mm512_cmp_ps_mask(distanceSq, flockDistanceSq, _CMP_LT_OQ);
+
+        if(Rules & SteerKernels::COHESION)
+        {
+            cohesionX = _mm512_mask_add_ps(cohesionX, near, cohesionX, x);
+            cohesionY = _mm512_mask_add_ps(cohesionY, near, cohesionY, y);
+            cohesionZ = _mm512_mask_add_ps(cohesionZ, near, cohesionZ, z);
+        }
+        if(Rules & SteerKernels::ALIGNMENT)
+        {
+            alignmentX = _mm512_mask_add_ps(alignmentX, near, alignmentX, _mm512_loadu_ps(_batch.m_vx + i));
+            alignmentY = _mm512_mask_add_ps(alignmentY, near, alignmentY, _mm512_loadu_ps(_batch.m_vy + i));
+            alignmentZ = _mm512_mask_add_ps(alignmentZ, near, alignmentZ, _mm512_loadu_ps(_batch.m_vz + i));
+        }
+        if(Rules & SteerKernels::SEPARATION)
+        {
+            separationX = _mm512_mask_sub_ps(separationX, close, separationX, dx);
+            separationY = _mm512_mask_sub_ps(separationY, close, separationY, dy);
+            separationZ = _mm512_mask_sub_ps(separationZ, close, separationZ, dz);
+        }
+        if(Rules & s_nearRules)
+        {
+            count += __builtin_popcount(near);
+        }
+    }
+
+    _sums.m_cohesionX = horizontalSum(cohesionX);
+    _sums.m_cohesionY = horizontalSum(cohesionY);
+    _sums.m_cohesionZ = horizontalSum(cohesionZ);
+    _sums.m_alignmentX = horizontalSum(alignmentX);
+    _sums.m_alignmentY = horizontalSum(alignmentY);
+    _sums.m_alignmentZ = horizontalSum(alignmentZ);
+    _sums.m_separationX = horizontalSum(separationX);
+    _sums.m_separationY = horizontalSum(separationY);
+    _sums.m_separationZ = horizontalSum(separationZ);
+    _sums.m_count = count;
+}
+#endif // FLOCK_X86
+
+//----------------------------------------------------------------------------------------------------------------------
+SteerKernels::ISA SteerKernels::detect()
+{
+    // a function local static is set by the first caller, C++11 makes the callers of other threads wait for it
+    static const ISA s_detected = []()
+    {
+#ifdef FLOCK_X86
+        // __builtin_cpu_supports also checks the OS saves the wider registers (XGETBV)
+        __builtin_cpu_init();
+        if(__builtin_cpu_supports("avx512f"))
+        {
+            return AVX512;
+        }
+        if(__builtin_cpu_supports("avx2"))
+        {
+            return AVX2;
+        }
+        return SSE;
+#else
+        return SCALAR;
+#endif
+    }();
+    return s_detected;
+}
+//----------------------------------------------------------------------------------------------------------------------
+SteerKernels::ISA SteerKernels::active()
+{
+    static const ISA s_active = []()
+    {
+        ISA isa = detect();
+        const char *forced = std::getenv("FLOCK_SIMD");
+        if(forced != 0)
+        {
+            for(int i=SCALAR; i<=AVX512; ++i)
+            {
+                if(std::strcmp(forced, name((ISA)i)) == 0 && i < isa)
+                {
+                    isa = (ISA)i;
+                }
+            }
+        }
+        return isa;
+    }();
+    return s_active;
+}
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the instantiations of a kernel for every set of rules, indexed by the rule flags
+#define FLOCK_RULE_KERNELS(_kernel) {_kernel<0>, _kernel<1>, _kernel<2>, _kernel<3>, \
+                                     _kernel<4>, _kernel<5>, _kernel<6>, _kernel<7>}
+//----------------------------------------------------------------------------------------------------------------------
+AccumulateKernel SteerKernels::accumulate()
+{
+    return accumulate(ALL_RULES);
+}
+//----------------------------------------------------------------------------------------------------------------------
+AccumulateKernel SteerKernels::accumulate(int _rules)
+{
+    // every flock of flock_sweep makes its Behaviours on its own worker, the table is built once for all of them
+    struct Table
+    {
+        AccumulateKernel m_kernels[s_ruleSets];
+    };
+    static const Table s_table = []()
+    {
+        Table table;
+        for(int r=0; r<s_ruleSets; ++r)
+        {
+            table.m_kernels[r] = kernel(active(), r);
+        }
+        return table;
+    }();
+    return s_table.m_kernels[_rules & ALL_RULES];
+}
+//----------------------------------------------------------------------------------------------------------------------
+AccumulateKernel SteerKernels::kernel(ISA _isa)
+{
+    return kernel(_isa, ALL_RULES);
+}
+//----------------------------------------------------------------------------------------------------------------------
+AccumulateKernel SteerKernels::kernel(ISA _isa, int _rules)
+{
+    static const AccumulateKernel s_scalar[s_ruleSets] = FLOCK_RULE_KERNELS(accumulateScalar);
+#ifdef FLOCK_X86
+    static const AccumulateKernel s_sse[s_ruleSets] = FLOCK_RULE_KERNELS(accumulateSSE);
+    static const AccumulateKernel s_avx2[s_ruleSets] = FLOCK_RULE_KERNELS(accumulateAVX2);
+    static const AccumulateKernel s_avx512[s_ruleSets] = FLOCK_RULE_KERNELS(accumulateAVX512);
+#endif
+    if(_isa > detect())
+    {
+        return 0;
+    }
+    const int rules = _rules & ALL_RULES;
+    switch(_isa)
+    {
+#ifdef FLOCK_X86
+        case AVX512 : return s_avx512[rules];
+        case AVX2 : return s_avx2[rules];
+        case SSE : return s_sse[rules];
+#endif
+        default : return s_scalar[rules];
+    }
+}
+//----------------------------------------------------------------------------------------------------------------------
+const char *SteerKernels::name(ISA _isa)
+{
+    switch(_isa)
+    {
+        case AVX512 : return "avx512";
+        case AVX2 : return "avx2";
+        case SSE : return "sse";
+        default : return "scalar";
+    }
+}
+//----------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,123 @@
+#include "ThreadPool.h"
+#include <algorithm>
+#include <string>
+#include "Tracer.h"
+#include "PerfCounters.h"
+
+ThreadPool::ThreadPool(int _workers)
+{
+    m_task = 0;
+    m_count = 0;
+    m_grain = 1;
+    m_next = 0;
+    m_busy = 0;
+    m_job = 0;
+    m_quit = false;
+
+    int workers = _workers > 0 ? _workers : hardwareThreads();
+    for(int i=1; i<workers; ++i)
+    {
+        m_threads.push_back(std::thread(&ThreadPool::workerLoop, this, i));
+    }
+}
+//----------------------------------------------------------------------------------------------------------------------
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard <std::mutex> lock(m_mutex);
+        m_quit = true;
+    }
+    m_wake.notify_all();
+    for(unsigned int i=0; i<m_threads.size(); ++i)
+    {
+        m_threads[i].join();
+    }
+}
+//----------------------------------------------------------------------------------------------------------------------
+int ThreadPool::hardwareThreads()
+{
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+//----------------------------------------------------------------------------------------------------------------------
+void ThreadPool::parallelFor(int _count, int _grain, const Task &_task)
+{
+    if(_count <= 0)
+    {
+        return;
+    }
+    // not worth waking anybody for a single chunk
+    if(m_threads.empty() || _count <= _grain)
+    {
+        FLOCK_TRACE_CHUNK("chunk", 0, _count);
+        _task(0, _count, 0);
+        return;
+    }
+    {
+        std::lock_guard <std::mutex> lock(m_mutex);
+        m_task = &_task;
+        m_count = _count;
+        m_grain = std::max(1, _grain);
+        m_next = 0;
+        m_busy = (int)m_threads.size();
+        ++m_job;
+    }
+    m_wake.notify_all();
+
+    runChunks(0);
+
+    // the time the caller waits here is the imbalance between the workers
+    FLOCK_TRACE_SCOPE("wait for workers");
+    std::unique_lock <std::mutex> lock(m_mutex);
+    while(m_busy > 0)
+    {
+        m_finished.wait(lock);
+    }
+    m_task = 0;
+}
+//----------------------------------------------------------------------------------------------------------------------
+void ThreadPool::runChunks(int _worker)
+{
+    for(;;)
+    {
+        int begin = m_next.fetch_add(m_grain);
+        if(begin >= m_count)
+        {
+            return;
+        }
+        int end = std::min(begin + m_grain, m_count);
+        FLOCK_TRACE_CHUNK("chunk", begin, end);
+        (*m_task)(begin, end, _worker);
+    }
+}
+//----------------------------------------------------------------------------------------------------------------------
+void ThreadPool::workerLoop(int _worker)
+{
+    FLOCK_TRACE_THREAD("worker " + std::to_string(_worker));
+    // the chunks this worker runs are counted with the phase that handed them out
+    FLOCK_PERF_THREAD();
+    unsigned int lastJob = 0;
+    for(;;)
+    {
+        {
+            std::unique_lock <std::mutex> lock(m_mutex);
+            while(!m_quit && m_job == lastJob)
+            {
+                m_wake.wait(lock);
+            }
+            if(m_quit)
+            {
+                return;
+            }
+            lastJob = m_job;
+        }
+
+        runChunks(_worker);
+
+        std::lock_guard <std::mutex> lock(m_mutex);
+        if(--m_busy == 0)
+        {
+            m_finished.notify_one();
+        }
+    }
+}
+//----------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,121 @@
+#include "Tracer.h"
+#include <algorithm>
+#include <cstdio>
+
+//----------------------------------------------------------------------------------------------------------------------
+Tracer &Tracer::instance()
+{
+    static Tracer tracer;
+    return tracer;
+}
+//----------------------------------------------------------------------------------------------------------------------
+bool Tracer::isEnabled()
+{
+#ifdef FLOCK_TRACE
+    return true;
+#else
+    return false;
+#endif
+}
+//----------------------------------------------------------------------------------------------------------------------
+Tracer::Tracer()
+{
+    m_epoch = std::chrono::steady_clock::now();
+}
+//----------------------------------------------------------------------------------------------------------------------
+Tracer::~Tracer()
+{
+    for(unsigned int i=0; i<m_rings.size(); ++i)
+    {
+        delete m_rings[i];
+    }
+}
+//----------------------------------------------------------------------------------------------------------------------
+Tracer::Ring &Tracer::ring()
+{
+    // every thread has its own, 0 until it records
+    static thread_local Ring *t_ring = 0;
+    if(t_ring == 0)
+    {
+        Ring *ring = new Ring;
+        ring->m_written = 0;
+        std::lock_guard <std::mutex> lock(m_mutex);
+        ring->m_thread = (int)m_rings.size() + 1;
+        m_rings.push_back(ring);
+        t_ring = ring;
+    }
+    return *t_ring;
+}
+//----------------------------------------------------------------------------------------------------------------------
+void Tracer::record(const char *_name, uint64_t _start, uint64_t _end, int _first, int _last)
+{
+    Ring &thread = ring();
+    // only this thread writes the ring, the release makes the event visible before the count that covers it
+    uint64_t written = thread.m_written.load(std::memory_order_relaxed);
+    Event &event = thread.m_events[written & (s_capacity - 1)];
+    event.m_name = _name;
+    event.m_start = _start;
+    event.m_duration = _end - _start;
+    event.m_first = _first;
+    event.m_last = _last;
+    thread.m_written.store(written + 1, std::memory_order_release);
+}
+//----------------------------------------------------------------------------------------------------------------------
+void Tracer::setThreadName(const std::string &_name)
+{
+    Ring &thread = ring();
+    std::lock_guard <std::mutex> lock(m_mutex);
+    thread.m_name = _name;
+}
+//----------------------------------------------------------------------------------------------------------------------
+bool Tracer::writeJson(const std::string &_file)
+{
+    FILE *file = _file == "-" ? stdout : std::fopen(_file.c_str(), "w");
+    if(file == 0)
+    {
+        return false;
+    }
+    std::lock_guard <std::mutex> lock(m_mutex);
+    std::fprintf(file, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+    bool first = true;
+    std::vector <Event> events;
+    for(unsigned int r=0; r<m_rings.size(); ++r)
+    {
+        const Ring &ring = *m_rings[r];
+        std::string name = ring.m_name.empty() ? "thread" : ring.m_name;
+        std::fprintf(file, "%s{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %d, \"args\": {\"name\": \"%s\"}}",
+                     first ? "" : ",\n", ring.m_thread, name.c_str());
+        first = false;
+
+        // the owner keeps writing while the ring is copied, every slot it reached by the end of the copy, and the
+        // one it may be writing into, could be torn
+        uint64_t end = ring.m_written.load(std::memory_order_acquire);
+        uint64_t begin = end > (uint64_t)s_capacity ? end - s_capacity : 0;
+        events.resize(end - begin);
+        for(uint64_t e=begin; e<end; ++e)
+        {
+            events[e - begin] = ring.m_events[e & (s_capacity - 1)];
+        }
+        uint64_t after = ring.m_written.load(std::memory_order_acquire);
+        uint64_t valid = after + 1 > (uint64_t)s_capacity ? std::max(begin, after + 1 - s_capacity) : begin;
+        for(uint64_t e=valid; e<end; ++e)
+        {
+            const Event &event = events[e - begin];
+            std::fprintf(file, ",\n{\"name\": \"%s\", \"ph\": \"X\", \"pid\": 1, \"tid\": %d, \"ts\": %.3f, \"dur\": %.3f",
+                         event.m_name, ring.m_thread, event.m_start / 1000.0, event.m_duration / 1000.0);
+            if(event.m_first >= 0)
+            {
+                std::fprintf(file, ", \"args\": {\"begin\": %d, \"end\": %d}", event.m_first, event.m_last);
+            }
+            std::fprintf(file, "}");
+        }
+    }
+    std::fprintf(file, "\n]}\n");
+    bool good = !std::ferror(file);
+    if(file != stdout)
+    {
+        good = std::fclose(file) == 0 && good;
+    }
+    return good;
+}
+//----------------------------------------------------------------------------------------------------------------------
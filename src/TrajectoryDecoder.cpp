@@ -0,0 +1,234 @@
+#include "TrajectoryDecoder.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include "RansCoder.h"
+#include "TrajectoryRecorder.h"
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief undoes the folding of TrajectoryEncoder, 0, 1, 2, 3 to 0, -1, 1, -2
+static inline uint16_t unzigzag(uint16_t _value)
+{
+    return (uint16_t)((_value >> 1) ^ (uint16_t)(-(int)(_value & 1)));
+}
+//----------------------------------------------------------------------------------------------------------------------
+TrajectoryDecoder::TrajectoryDecoder()
+{
+    std::memset(&m_header, 0, sizeof(m_header));
+    m_pool = 0;
+    m_decoded = -1;
+}
+//----------------------------------------------------------------------------------------------------------------------
+TrajectoryDecoder::~TrajectoryDecoder()
+{
+    delete m_pool;
+}
+//----------------------------------------------------------------------------------------------------------------------
+void TrajectoryDecoder::close()
+{
+    m_file.close();
+    m_offsets.clear();
+    m_keyframes.clear();
+    m_decoded = -1;
+}
+//----------------------------------------------------------------------------------------------------------------------
+bool TrajectoryDecoder::open(const std::string &_file, int _threads)
+{
+    close();
+    TrajectoryFooter footer;
+    TrajectoryIndexHeader index;
+    if(!m_file.open(_file) || m_file.size() < sizeof(m_header) + sizeof(index) + sizeof(footer))
+    {
+        close();
+        return false;
+    }
+    const char *data = m_file.data();
+    const uint64_t bytes = m_file.size();
+    std::memcpy(&m_header, data, sizeof(m_header));
+    std::memcpy(&footer, data + bytes - sizeof(footer), sizeof(footer));
+    bool valid = std::memcmp(m_header.m_magic, "FQTJ", 4) == 0 && m_header.m_version == TrajectoryEncoder::s_version &&
+                 m_header.m_blockSize > 0 && std::memcmp(footer.m_magic, "FEND", 4) == 0 &&
+                 footer.m_indexOffset >= sizeof(m_header) && footer.m_indexOffset <= bytes - sizeof(footer) - sizeof(index);
+    if(valid)
+    {
+        std::memcpy(&index, data + footer.m_indexOffset, sizeof(index));
+        valid = std::memcmp(index.m_magic, "FIDX", 4) == 0 &&
+                index.m_frames * sizeof(uint64_t) == bytes - sizeof(footer) - footer.m_indexOffset - sizeof(index);
+    }
+    if(valid)
+    {
+        m_offsets.resize(index.m_frames);
+        if(!m_offsets.empty())
+        {
+            std::memcpy(&m_offsets[0], data + footer.m_indexOffset + sizeof(index), m_offsets.size() * sizeof(uint64_t));
+        }
+        // every frame has to fit before the index and start from a keyframe
+        m_keyframes.resize(m_offsets.size());
+        int keyframe = -1;
+        for(unsigned int f=0; valid && f<m_offsets.size(); ++f)
+        {
+            valid = m_offsets[f] >= sizeof(m_header) && m_offsets[f] + sizeof(QuantizedFrameHeader) <= footer.m_indexOffset;
+            if(valid)
+            {
+                QuantizedFrameHeader frame = frameHeader(f);
+                valid = std::memcmp(frame.m_magic, "QFRM", 4) == 0 &&
+                        m_offsets[f] + sizeof(frame) + frame.m_payloadBytes <= footer.m_indexOffset &&
+                        frame.m_blocks == (frame.m_count + m_header.m_blockSize - 1) / m_header.m_blockSize &&
+                        frame.m_payloadBytes >= 3 * (uint64_t)frame.m_blocks * sizeof(uint32_t);
+                if(frame.m_predictor == QuantizedFrameHeader::KEY)
+                {
+                    keyframe = f;
+                }
+                valid = valid && keyframe >= 0;
+                m_keyframes[f] = keyframe;
+            }
+        }
+    }
+    if(!valid)
+    {
+        close();
+        return false;
+    }
+    delete m_pool;
+    m_pool = new ThreadPool(_threads);
+    return true;
+}
+//----------------------------------------------------------------------------------------------------------------------
+QuantizedFrameHeader TrajectoryDecoder::frameHeader(int _frame) const
+{
+    QuantizedFrameHeader header;
+    std::memcpy(&header, m_file.data() + m_offsets[_frame], sizeof(header));
+    return header;
+}
+//----------------------------------------------------------------------------------------------------------------------
+int TrajectoryDecoder::getCount(int _frame) const
+{
+    return frameHeader(_frame).m_count;
+}
+//----------------------------------------------------------------------------------------------------------------------
+float TrajectoryDecoder::getMaxError(int _frame) const
+{
+    const QuantizedFrameHeader header = frameHeader(_frame);
+    return TrajectoryEncoder::getMaxError(ngl::Vector(header.m_min[0], header.m_min[1], header.m_min[2]),
+                                          ngl::Vector(header.m_max[0], header.m_max[1], header.m_max[2]));
+}
+//----------------------------------------------------------------------------------------------------------------------
+bool TrajectoryDecoder::step(int _frame)
+{
+    const QuantizedFrameHeader header = frameHeader(_frame);
+    const int count = header.m_count;
+    const int blocks = header.m_blocks;
+    const int blockSize = m_header.m_blockSize;
+    if(header.m_predictor != QuantizedFrameHeader::KEY && (int)m_previous[0].size() != count)
+    {
+        return false;
+    }
+    const char *payload = m_file.data() + m_offsets[_frame] + sizeof(header);
+    std::vector <uint32_t> sizes(3 * blocks);
+    std::vector <uint64_t> starts(3 * blocks);
+    uint64_t start = sizes.size() * sizeof(uint32_t);
+    if(!sizes.empty())
+    {
+        std::memcpy(&sizes[0], payload, sizes.size() * sizeof(uint32_t));
+    }
+    for(int b=0; b<3 * blocks; ++b)
+    {
+        starts[b] = start;
+        start += sizes[b];
+    }
+    if(start != header.m_payloadBytes)
+    {
+        return false;
+    }
+
+    for(int a=0; a<3; ++a)
+    {
+        m_current[a].resize(count);
+    }
+    // set by any worker that finds a damaged block
+    std::atomic<bool> damaged(false);
+    m_pool->parallelFor(3 * blocks, 1, [&](int _begin, int _end, int)
+    {
+        for(int task=_begin; task<_end; ++task)
+        {
+            const int axis = task / blocks;
+            const int first = (task % blocks) * blockSize;
+            const int last = std::min(count, first + blockSize);
+            uint16_t *current = &m_current[axis][0];
+            if(!RansCoder::decode((const uint8_t *)payload + starts[task], sizes[task], current + first, last - first))
+            {
+                damaged = true;
+                continue;
+            }
+            if(header.m_predictor == QuantizedFrameHeader::PREVIOUS)
+            {
+                const uint16_t *previous = &m_previous[axis][0];
+                for(int i=first; i<last; ++i)
+                {
+                    current[i] = (uint16_t)(previous[i] + unzigzag(current[i]));
+                }
+            }
+            else if(header.m_predictor == QuantizedFrameHeader::MOTION)
+            {
+                const uint16_t *previous = &m_previous[axis][0];
+                const uint16_t *before = &m_beforePrevious[axis][0];
+                for(int i=first; i<last; ++i)
+                {
+                    current[i] = (uint16_t)(2 * previous[i] - before[i] + unzigzag(current[i]));
+                }
+            }
+        }
+    });
+    if(damaged)
+    {
+        return false;
+    }
+    for(int a=0; a<3; ++a)
+    {
+        m_beforePrevious[a].swap(m_previous[a]);
+        m_previous[a].swap(m_current[a]);
+    }
+    m_decoded = _frame;
+    return true;
+}
+//----------------------------------------------------------------------------------------------------------------------
+bool TrajectoryDecoder::decode(int _frame, float *_x, float *_y, float *_z)
+{
+    if(_frame < 0 || _frame >= getFrameCount())
+    {
+        return false;
+    }
+    // carry on from the last frame if it is on the way, otherwise start again from the keyframe
+    int from = m_keyframes[_frame];
+    if(m_decoded >= from && m_decoded <= _frame)
+    {
+        from = m_decoded == _frame ? _frame + 1 : m_decoded + 1;
+    }
+    for(int f=from; f<=_frame; ++f)
+    {
+        if(!step(f))
+        {
+            m_decoded = -1;
+            return false;
+        }
+    }
+
+    const QuantizedFrameHeader header = frameHeader(_frame);
+    const int count = m_previous[0].size();
+    float *positions[3] = {_x, _y, _z};
+    m_pool->parallelFor(count, 65536, [&](int _begin, int _end, int)
+    {
+        for(int a=0; a<3; ++a)
+        {
+            const float low = header.m_min[a];
+            const float step = (header.m_max[a] - header.m_min[a]) / 65535.0f;
+            const uint16_t *quantised = &m_previous[a][0];
+            for(int i=_begin; i<_end; ++i)
+            {
+                positions[a][i] = low + quantised[i] * step;
+            }
+        }
+    });
+    return true;
+}
+//----------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,302 @@
+#include "TrajectoryEncoder.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include "RansCoder.h"
+#include "TrajectoryRecorder.h"
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the largest quantised value
+const static float s_steps = 65535.0f;
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the boids a worker takes at a time when finding the box
+const static int s_grain = 16384;
+//----------------------------------------------------------------------------------------------------------------------
+const float TrajectoryEncoder::s_margin = 0.25f;
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief folds a 16 bit difference so small steps either way become small values, 0, -1, 1, -2 to 0, 1, 2, 3
+static inline uint16_t zigzag(uint16_t _difference)
+{
+    // the sign is spread over the bits by hand, a shift of a negative value is not defined
+    uint16_t sign = (uint16_t)(0u - (_difference >> 15));
+    return (uint16_t)((_difference << 1) ^ sign);
+}
+//----------------------------------------------------------------------------------------------------------------------
+float TrajectoryEncoder::getMaxError(const ngl::Vector &_min, const ngl::Vector &_max)
+{
+    // half a quantisation step, plus the rounding of the float arithmetic on either side of it
+    float extent = std::max(_max.m_x - _min.m_x, std::max(_max.m_y - _min.m_y, _max.m_z - _min.m_z));
+    float largest = std::max(std::max(std::fabs(_min.m_x), std::fabs(_max.m_x)),
+                             std::max(std::max(std::fabs(_min.m_y), std::fabs(_max.m_y)), std::max(std::fabs(_min.m_z), std::fabs(_max.m_z))));
+    return 0.5f * extent / s_steps + 4.0f * std::numeric_limits<float>::epsilon() * largest;
+}
+//----------------------------------------------------------------------------------------------------------------------
+TrajectoryEncoder::TrajectoryEncoder()
+{
+    m_file = 0;
+    m_offset = 0;
+    m_good = false;
+    m_pool = 0;
+    m_keyframeInterval = 30;
+    m_history = 0;
+}
+//----------------------------------------------------------------------------------------------------------------------
+TrajectoryEncoder::~TrajectoryEncoder()
+{
+    close();
+    delete m_pool;
+}
+//----------------------------------------------------------------------------------------------------------------------
+bool TrajectoryEncoder::open(const std::string &_file, int _keyframeInterval, int _threads)
+{
+    close();
+    m_file = std::fopen(_file.c_str(), "wb");
+    if(m_file == 0)
+    {
+        return false;
+    }
+    delete m_pool;
+    m_pool = new ThreadPool(_threads);
+    m_offset = 0;
+    m_good = true;
+    m_index.clear();
+    m_history = 0;
+    m_keyframeInterval = std::max(1, _keyframeInterval);
+
+    QuantizedFileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.m_magic, "FQTJ", 4);
+    header.m_version = s_version;
+    header.m_keyframeInterval = m_keyframeInterval;
+    header.m_blockSize = s_blockSize;
+    write(&header, sizeof(header));
+    return true;
+}
+//----------------------------------------------------------------------------------------------------------------------
+void TrajectoryEncoder::bounds(const float *const *_positions, int _count, float *_min, float *_max)
+{
+    // six floats per worker, a position that is not a number is left out by the comparisons
+    const float largest = std::numeric_limits<float>::max();
+    m_workerBounds.resize(6 * m_pool->size());
+    for(int w=0; w<m_pool->size(); ++w)
+    {
+        std::fill(m_workerBounds.begin() + 6 * w, m_workerBounds.begin() + 6 * w + 3, largest);
+        std::fill(m_workerBounds.begin() + 6 * w + 3, m_workerBounds.begin() + 6 * w + 6, -largest);
+    }
+    m_pool->parallelFor(_count, s_grain, [&](int _begin, int _end, int _worker)
+    {
+        float *bounds = &m_workerBounds[6 * _worker];
+        for(int a=0; a<3; ++a)
+        {
+            const float *position = _positions[a];
+            for(int i=_begin; i<_end; ++i)
+            {
+                bounds[a] = position[i] < bounds[a] ? position[i] : bounds[a];
+                bounds[3 + a] = position[i] > bounds[3 + a] ? position[i] : bounds[3 + a];
+            }
+        }
+    });
+    for(int a=0; a<3; ++a)
+    {
+        _min[a] = largest;
+        _max[a] = -largest;
+        for(int w=0; w<m_pool->size(); ++w)
+        {
+            _min[a] = std::min(_min[a], m_workerBounds[6 * w + a]);
+            _max[a] = std::max(_max[a], m_workerBounds[6 * w + 3 + a]);
+        }
+    }
+}
+//----------------------------------------------------------------------------------------------------------------------
+void TrajectoryEncoder::fitBox(const float *_min, const float *_max)
+{
+    for(int a=0; a<3; ++a)
+    {
+        // an empty or flat flock still needs a step that is not 0
+        float low = _min[a] <= _max[a] ? _min[a] : 0.0f;
+        float high = _min[a] <= _max[a] ? _max[a] : 0.0f;
+        float margin = std::max(s_margin * (high - low), 1.0e-3f * std::max(1.0f, std::max(std::fabs(low), std::fabs(high))));
+        m_min[a] = low - margin;
+        m_max[a] = high + margin;
+        m_scale[a] = s_steps / (m_max[a] - m_min[a]);
+    }
+}
+//----------------------------------------------------------------------------------------------------------------------
+void TrajectoryEncoder::encode(const FlockState &_state)
+{
+    const int count = _state.size();
+    if(count == 0)
+    {
+        encode(0, 0, 0, 0);
+        return;
+    }
+    encode(&_state.m_posX[0], &_state.m_posY[0], &_state.m_posZ[0], count);
+}
+//----------------------------------------------------------------------------------------------------------------------
+void TrajectoryEncoder::encode(const float *_x, const float *_y, const float *_z, int _count)
+{
+    if(m_file == 0)
+    {
+        return;
+    }
+    if(m_history > 0 && (int)m_previous[0].size() != _count)
+    {
+        m_history = 0;
+    }
+    const uint64_t number = m_index.size();
+    if(number % m_keyframeInterval == 0)
+    {
+        m_history = 0;
+    }
+    const float *positions[3] = {_x, _y, _z};
+    float lowest[3], highest[3];
+    bounds(positions, _count, lowest, highest);
+    for(int a=0; a<3 && m_history > 0; ++a)
+    {
+        if(lowest[a] < m_min[a] || highest[a] > m_max[a])
+        {
+            m_history = 0;
+        }
+    }
+    if(m_history == 0)
+    {
+        fitBox(lowest, highest);
+    }
+    const QuantizedFrameHeader::Predictor predictor = m_history == 0 ? QuantizedFrameHeader::KEY :
+                                                      (m_history == 1 ? QuantizedFrameHeader::PREVIOUS : QuantizedFrameHeader::MOTION);
+
+    const int blocks = (_count + s_blockSize - 1) / s_blockSize;
+    m_blocks.resize(3 * blocks);
+    m_residuals.resize(m_pool->size());
+    for(int a=0; a<3; ++a)
+    {
+        m_current[a].resize(_count);
+    }
+    // every block of every axis is quantised, predicted and coded on its own
+    m_pool->parallelFor(3 * blocks, 1, [&](int _begin, int _end, int _worker)
+    {
+        std::vector <uint16_t> &residuals = m_residuals[_worker];
+        for(int task=_begin; task<_end; ++task)
+        {
+            const int axis = task / blocks;
+            const int first = (task % blocks) * s_blockSize;
+            const int last = std::min(_count, first + s_blockSize);
+            const float *position = positions[axis];
+            uint16_t *current = &m_current[axis][0];
+            const float low = m_min[axis];
+            const float scale = m_scale[axis];
+            for(int i=first; i<last; ++i)
+            {
+                // every finite position is inside the box, the test only keeps a position that is not a number in range
+                float step = std::floor((position[i] - low) * scale + 0.5f);
+                current[i] = (uint16_t)(step >= 0.0f ? std::min(step, s_steps) : 0.0f);
+            }
+            residuals.resize(last - first);
+            if(predictor == QuantizedFrameHeader::KEY)
+            {
+                std::copy(current + first, current + last, residuals.begin());
+            }
+            else if(predictor == QuantizedFrameHeader::PREVIOUS)
+            {
+                const uint16_t *previous = &m_previous[axis][0];
+                for(int i=first; i<last; ++i)
+                {
+                    residuals[i - first] = zigzag((uint16_t)(current[i] - previous[i]));
+                }
+            }
+            else
+            {
+                // the boid is expected to move as far as it did the frame before, all in 16 bit wrap around
+                const uint16_t *previous = &m_previous[axis][0];
+                const uint16_t *before = &m_beforePrevious[axis][0];
+                for(int i=first; i<last; ++i)
+                {
+                    uint16_t expected = (uint16_t)(2 * previous[i] - before[i]);
+                    residuals[i - first] = zigzag((uint16_t)(current[i] - expected));
+                }
+            }
+            m_blocks[task].clear();
+            RansCoder::encode(residuals.empty() ? 0 : &residuals[0], last - first, m_blocks[task]);
+        }
+    });
+
+    std::vector <uint32_t> sizes(3 * blocks);
+    uint64_t payload = sizes.size() * sizeof(uint32_t);
+    for(int b=0; b<3 * blocks; ++b)
+    {
+        sizes[b] = (uint32_t)m_blocks[b].size();
+        payload += sizes[b];
+    }
+    QuantizedFrameHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.m_magic, "QFRM", 4);
+    header.m_count = _count;
+    header.m_number = number;
+    header.m_predictor = predictor;
+    header.m_blocks = blocks;
+    header.m_payloadBytes = payload;
+    for(int a=0; a<3; ++a)
+    {
+        header.m_min[a] = m_min[a];
+        header.m_max[a] = m_max[a];
+    }
+    m_index.push_back(m_offset);
+    write(&header, sizeof(header));
+    if(!sizes.empty())
+    {
+        write(&sizes[0], sizes.size() * sizeof(uint32_t));
+    }
+    for(int b=0; b<3 * blocks; ++b)
+    {
+        write(&m_blocks[b][0], m_blocks[b].size());
+    }
+
+    for(int a=0; a<3; ++a)
+    {
+        m_beforePrevious[a].swap(m_previous[a]);
+        m_previous[a].swap(m_current[a]);
+    }
+    ++m_history;
+}
+//----------------------------------------------------------------------------------------------------------------------
+bool TrajectoryEncoder::close()
+{
+    if(m_file == 0)
+    {
+        return true;
+    }
+    TrajectoryIndexHeader index;
+    std::memset(&index, 0, sizeof(index));
+    std::memcpy(index.m_magic, "FIDX", 4);
+    index.m_frames = m_index.size();
+    TrajectoryFooter footer;
+    std::memset(&footer, 0, sizeof(footer));
+    footer.m_indexOffset = m_offset;
+    std::memcpy(footer.m_magic, "FEND", 4);
+    footer.m_version = s_version;
+    // after a failed write the offsets no longer match the disk, the file is left without a footer so no
+    // reader takes it for a finished one
+    if(m_good)
+    {
+        write(&index, sizeof(index));
+        if(!m_index.empty())
+        {
+            write(&m_index[0], m_index.size() * sizeof(uint64_t));
+        }
+        write(&footer, sizeof(footer));
+    }
+    bool closed = std::fclose(m_file) == 0;
+    m_file = 0;
+    return m_good && closed;
+}
+//----------------------------------------------------------------------------------------------------------------------
+void TrajectoryEncoder::write(const void *_data, size_t _bytes)
+{
+    if(m_good && std::fwrite(_data, 1, _bytes, m_file) != _bytes)
+    {
+        m_good = false;
+    }
+    m_offset += _bytes;
+}
+//----------------------------------------------------------------------------------------------------------------------
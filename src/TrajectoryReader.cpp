@@ -0,0 +1,137 @@
+#include "TrajectoryReader.h"
+#include <cstring>
+
+//----------------------------------------------------------------------------------------------------------------------
+TrajectoryReader::TrajectoryReader()
+{
+    m_data = 0;
+    m_bytes = 0;
+    m_indexed = false;
+}
+//----------------------------------------------------------------------------------------------------------------------
+TrajectoryReader::~TrajectoryReader()
+{
+    close();
+}
+//----------------------------------------------------------------------------------------------------------------------
+void TrajectoryReader::close()
+{
+    m_file.close();
+    m_data = 0;
+    m_bytes = 0;
+    m_offsets.clear();
+    m_indexed = false;
+}
+//----------------------------------------------------------------------------------------------------------------------
+bool TrajectoryReader::open(const std::string &_file)
+{
+    close();
+    if(!m_file.open(_file) || m_file.size() < sizeof(TrajectoryFileHeader))
+    {
+        m_file.close();
+        return false;
+    }
+    m_data = m_file.data();
+    m_bytes = m_file.size();
+
+    TrajectoryFileHeader header;
+    std::memcpy(&header, m_data, sizeof(header));
+    if(std::memcmp(header.m_magic, "FTRJ", 4) != 0 || header.m_version != TrajectoryRecorder::s_version || header.m_arrays != 6)
+    {
+        close();
+        return false;
+    }
+    m_indexed = readIndex();
+    if(!m_indexed)
+    {
+        scanFrames();
+    }
+    return true;
+}
+//----------------------------------------------------------------------------------------------------------------------
+bool TrajectoryReader::readIndex()
+{
+    TrajectoryFooter footer;
+    if(m_bytes < sizeof(TrajectoryFileHeader) + sizeof(TrajectoryIndexHeader) + sizeof(footer))
+    {
+        return false;
+    }
+    std::memcpy(&footer, m_data + m_bytes - sizeof(footer), sizeof(footer));
+    if(std::memcmp(footer.m_magic, "FEND", 4) != 0 || footer.m_version != TrajectoryRecorder::s_version ||
+       footer.m_indexOffset < sizeof(TrajectoryFileHeader) ||
+       footer.m_indexOffset > m_bytes - sizeof(footer) - sizeof(TrajectoryIndexHeader))
+    {
+        return false;
+    }
+    TrajectoryIndexHeader index;
+    std::memcpy(&index, m_data + footer.m_indexOffset, sizeof(index));
+    uint64_t space = m_bytes - sizeof(footer) - footer.m_indexOffset - sizeof(index);
+    if(std::memcmp(index.m_magic, "FIDX", 4) != 0 || index.m_frames * sizeof(uint64_t) != space)
+    {
+        return false;
+    }
+    m_offsets.resize(index.m_frames);
+    if(index.m_frames > 0)
+    {
+        std::memcpy(&m_offsets[0], m_data + footer.m_indexOffset + sizeof(index), space);
+    }
+    // every frame has to fit before the index
+    for(unsigned int i=0; i<m_offsets.size(); ++i)
+    {
+        TrajectoryFrameHeader frame;
+        if(m_offsets[i] + sizeof(frame) > footer.m_indexOffset)
+        {
+            m_offsets.clear();
+            return false;
+        }
+        std::memcpy(&frame, m_data + m_offsets[i], sizeof(frame));
+        if(std::memcmp(frame.m_magic, "FRAM", 4) != 0 ||
+           frame.m_payloadBytes != 6 * sizeof(float) * (uint64_t)TrajectoryRecorder::arrayStride(frame.m_count) ||
+           m_offsets[i] + sizeof(frame) + frame.m_payloadBytes > footer.m_indexOffset)
+        {
+            m_offsets.clear();
+            return false;
+        }
+    }
+    return true;
+}
+//----------------------------------------------------------------------------------------------------------------------
+void TrajectoryReader::scanFrames()
+{
+    m_offsets.clear();
+    uint64_t offset = sizeof(TrajectoryFileHeader);
+    TrajectoryFrameHeader frame;
+    while(offset + sizeof(frame) <= m_bytes)
+    {
+        std::memcpy(&frame, m_data + offset, sizeof(frame));
+        uint64_t end = offset + sizeof(frame) + frame.m_payloadBytes;
+        if(std::memcmp(frame.m_magic, "FRAM", 4) != 0 ||
+           frame.m_payloadBytes != 6 * sizeof(float) * (uint64_t)TrajectoryRecorder::arrayStride(frame.m_count) ||
+           end > m_bytes)
+        {
+            break;
+        }
+        m_offsets.push_back(offset);
+        offset = end;
+    }
+}
+//----------------------------------------------------------------------------------------------------------------------
+TrajectoryFrame TrajectoryReader::getFrame(int _frame) const
+{
+    TrajectoryFrameHeader header;
+    const char *chunk = m_data + m_offsets[_frame];
+    std::memcpy(&header, chunk, sizeof(header));
+    const float *arrays = (const float *)(chunk + sizeof(header));
+    const uint32_t stride = TrajectoryRecorder::arrayStride(header.m_count);
+    TrajectoryFrame frame;
+    frame.m_count = header.m_count;
+    frame.m_number = header.m_number;
+    frame.m_posX = arrays;
+    frame.m_posY = arrays + stride;
+    frame.m_posZ = arrays + 2 * stride;
+    frame.m_velX = arrays + 3 * stride;
+    frame.m_velY = arrays + 4 * stride;
+    frame.m_velZ = arrays + 5 * stride;
+    return frame;
+}
+//----------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,198 @@
+#include "TrajectoryRecorder.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+//----------------------------------------------------------------------------------------------------------------------
+TrajectoryRecorder::TrajectoryRecorder()
+{
+    m_file = 0;
+    m_offset = 0;
+    m_good = false;
+    m_quit = false;
+    m_nextNumber = 0;
+    m_written = 0;
+    m_dropped = 0;
+}
+//----------------------------------------------------------------------------------------------------------------------
+TrajectoryRecorder::~TrajectoryRecorder()
+{
+    close();
+    for(unsigned int i=0; i<m_buffers.size(); ++i)
+    {
+        delete m_buffers[i];
+    }
+}
+//----------------------------------------------------------------------------------------------------------------------
+bool TrajectoryRecorder::open(const std::string &_file, int _buffers)
+{
+    close();
+    m_file = std::fopen(_file.c_str(), "wb");
+    if(m_file == 0)
+    {
+        return false;
+    }
+    m_offset = 0;
+    m_good = true;
+    m_index.clear();
+    m_quit = false;
+    m_nextNumber = 0;
+    m_written = 0;
+    m_dropped = 0;
+
+    // the buffers of an earlier recording are kept, their memory is already the size of the flock
+    while((int)m_buffers.size() < std::max(1, _buffers))
+    {
+        m_buffers.push_back(new Frame);
+    }
+    m_free = m_buffers;
+    m_queue.clear();
+
+    TrajectoryFileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.m_magic, "FTRJ", 4);
+    header.m_version = s_version;
+    header.m_arrays = 6;
+    write(&header, sizeof(header));
+
+    m_thread = std::thread(&TrajectoryRecorder::run, this);
+    return true;
+}
+//----------------------------------------------------------------------------------------------------------------------
+bool TrajectoryRecorder::record(const FlockState &_state)
+{
+    if(m_file == 0)
+    {
+        return false;
+    }
+    Frame *frame = 0;
+    uint64_t number = m_nextNumber++;
+    {
+        std::lock_guard <std::mutex> lock(m_mutex);
+        if(!m_free.empty())
+        {
+            frame = m_free.back();
+            m_free.pop_back();
+        }
+    }
+    if(frame == 0)
+    {
+        ++m_dropped;
+        return false;
+    }
+
+    // the copy happens outside of the lock, the buffer belongs to this thread until it is queued
+    const uint32_t count = _state.size();
+    const uint32_t stride = arrayStride(count);
+    frame->m_number = number;
+    frame->m_count = count;
+    frame->m_data.resize(6 * (size_t)stride);
+    const FloatArray *arrays[6] = {&_state.m_posX, &_state.m_posY, &_state.m_posZ, &_state.m_velX, &_state.m_velY, &_state.m_velZ};
+    for(int a=0; a<6; ++a)
+    {
+        float *destination = &frame->m_data[a * (size_t)stride];
+        if(count > 0)
+        {
+            std::memcpy(destination, &(*arrays[a])[0], count * sizeof(float));
+        }
+        std::fill(destination + count, destination + stride, 0.0f);
+    }
+    {
+        std::lock_guard <std::mutex> lock(m_mutex);
+        m_queue.push_back(frame);
+    }
+    m_wake.notify_one();
+    return true;
+}
+//----------------------------------------------------------------------------------------------------------------------
+bool TrajectoryRecorder::close()
+{
+    if(m_file == 0)
+    {
+        return true;
+    }
+    {
+        std::lock_guard <std::mutex> lock(m_mutex);
+        m_quit = true;
+    }
+    m_wake.notify_one();
+    m_thread.join();
+
+    // the index goes after the last frame and the footer after it, a file without a footer was not closed
+    TrajectoryIndexHeader index;
+    std::memset(&index, 0, sizeof(index));
+    std::memcpy(index.m_magic, "FIDX", 4);
+    index.m_frames = m_index.size();
+    TrajectoryFooter footer;
+    std::memset(&footer, 0, sizeof(footer));
+    footer.m_indexOffset = m_offset;
+    std::memcpy(footer.m_magic, "FEND", 4);
+    footer.m_version = s_version;
+    // after a failed write the offsets no longer match the disk, the file is left without a footer so no
+    // reader takes it for a finished one
+    if(m_good)
+    {
+        write(&index, sizeof(index));
+        if(!m_index.empty())
+        {
+            write(&m_index[0], m_index.size() * sizeof(uint64_t));
+        }
+        write(&footer, sizeof(footer));
+    }
+    bool closed = std::fclose(m_file) == 0;
+    m_file = 0;
+    return m_good && closed;
+}
+//----------------------------------------------------------------------------------------------------------------------
+void TrajectoryRecorder::write(const void *_data, size_t _bytes)
+{
+    if(m_good && std::fwrite(_data, 1, _bytes, m_file) != _bytes)
+    {
+        m_good = false;
+    }
+    m_offset += _bytes;
+}
+//----------------------------------------------------------------------------------------------------------------------
+void TrajectoryRecorder::run()
+{
+    for(;;)
+    {
+        Frame *frame = 0;
+        {
+            std::unique_lock <std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [this]{return m_quit || !m_queue.empty();});
+            if(m_queue.empty())
+            {
+                // quit is only seen once every queued frame is written
+                return;
+            }
+            frame = m_queue.front();
+            m_queue.pop_front();
+        }
+
+        TrajectoryFrameHeader header;
+        std::memset(&header, 0, sizeof(header));
+        std::memcpy(header.m_magic, "FRAM", 4);
+        header.m_count = frame->m_count;
+        header.m_number = frame->m_number;
+        header.m_payloadBytes = frame->m_data.size() * sizeof(float);
+        if(m_good)
+        {
+            m_index.push_back(m_offset);
+            write(&header, sizeof(header));
+            if(!frame->m_data.empty())
+            {
+                write(&frame->m_data[0], frame->m_data.size() * sizeof(float));
+            }
+            ++m_written;
+        }
+        else
+        {
+            ++m_dropped;
+        }
+
+        std::lock_guard <std::mutex> lock(m_mutex);
+        m_free.push_back(frame);
+    }
+}
+//----------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,458 @@
+#include "avoidance.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sys/stat.h>
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the version of the cache layout, a cache with another version is baked again
+const static uint32_t s_cacheVersion = 1;
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the grid points within this many cells of a triangle get the exact distance, the rest is swept out
+const static int s_exactBand = 1;
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the sign rays run through the grid points moved by this much, in cells, so they never hit an edge
+/// or a vertex the mesh shares between two triangles exactly and count it twice.
+const static double s_rayOffsetY = 1.234567e-4;
+const static double s_rayOffsetZ = 3.712383e-4;
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the distance from _p to the triangle _a _b _c, from Ericson's closest point on a triangle.
+static float pointTriangleDistance(const float *_p, const float *_a, const float *_b, const float *_c)
+{
+    float ab[3], ac[3], ap[3], bp[3], cp[3];
+    for(int i=0; i<3; ++i)
+    {
+        ab[i] = _b[i] - _a[i];
+        ac[i] = _c[i] - _a[i];
+        ap[i] = _p[i] - _a[i];
+        bp[i] = _p[i] - _b[i];
+        cp[i] = _p[i] - _c[i];
+    }
+    float d1 = ab[0] * ap[0] + ab[1] * ap[1] + ab[2] * ap[2];
+    float d2 = ac[0] * ap[0] + ac[1] * ap[1] + ac[2] * ap[2];
+    float d3 = ab[0] * bp[0] + ab[1] * bp[1] + ab[2] * bp[2];
+    float d4 = ac[0] * bp[0] + ac[1] * bp[1] + ac[2] * bp[2];
+    float d5 = ab[0] * cp[0] + ab[1] * cp[1] + ab[2] * cp[2];
+    float d6 = ac[0] * cp[0] + ac[1] * cp[1] + ac[2] * cp[2];
+    float vc = d1 * d4 - d3 * d2;
+    float vb = d5 * d2 - d1 * d6;
+    float va = d3 * d6 - d5 * d4;
+
+    // the weights of b and c of the closest point
+    float v, w;
+    if(d1 <= 0.0f && d2 <= 0.0f)
+    {
+        v = 0.0f; w = 0.0f;
+    }
+    else if(d3 >= 0.0f && d4 <= d3)
+    {
+        v = 1.0f; w = 0.0f;
+    }
+    else if(vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f)
+    {
+        v = d1 / (d1 - d3); w = 0.0f;
+    }
+    else if(d6 >= 0.0f && d5 <= d6)
+    {
+        v = 0.0f; w = 1.0f;
+    }
+    else if(vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f)
+    {
+        v = 0.0f; w = d2 / (d2 - d6);
+    }
+    else if(va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f)
+    {
+        w = (d4 - d3) / ((d4 - d3) + (d5 - d6)); v = 1.0f - w;
+    }
+    else
+    {
+        float denom = 1.0f / (va + vb + vc);
+        v = vb * denom; w = vc * denom;
+    }
+    float distance2 = 0.0f;
+    for(int i=0; i<3; ++i)
+    {
+        float d = ap[i] - ab[i] * v - ac[i] * w;
+        distance2 += d * d;
+    }
+    return std::sqrt(distance2);
+}
+//----------------------------------------------------------------------------------------------------------------------
+Avoidance::Avoidance()
+{
+    m_grid = 0;
+    m_size[0] = m_size[1] = m_size[2] = 0;
+    m_origin[0] = m_origin[1] = m_origin[2] = 0.0f;
+    m_cellSize = 1.0f;
+    m_invCellSize = 1.0f;
+    m_fromCache = false;
+}
+//----------------------------------------------------------------------------------------------------------------------
+Avoidance::~Avoidance()
+{
+    release();
+}
+//----------------------------------------------------------------------------------------------------------------------
+void Avoidance::release()
+{
+    m_file.close();
+    m_baked.clear();
+    m_grid = 0;
+}
+//----------------------------------------------------------------------------------------------------------------------
+bool Avoidance::load(const std::string &_objFile, int _resolution, float _padding)
+{
+    struct stat source;
+    if(stat(_objFile.c_str(), &source) != 0)
+    {
+        return false;
+    }
+    CacheHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.m_magic, "FSDF", 4);
+    header.m_version = s_cacheVersion;
+    header.m_resolution = std::max(_resolution, 2);
+    header.m_padding = std::max(_padding, 0.0f);
+    header.m_sourceBytes = (uint64_t)source.st_size;
+    header.m_sourceTime = (int64_t)source.st_mtime;
+
+    std::string cachePath = _objFile + ".sdf";
+    if(mapCache(cachePath, header))
+    {
+        m_cachePath = cachePath;
+        m_fromCache = true;
+        return true;
+    }
+
+    std::vector <float> vertices;
+    std::vector <int> triangles;
+    if(!readObj(_objFile, vertices, triangles) || triangles.empty())
+    {
+        return false;
+    }
+    float lo[3] = {vertices[0], vertices[1], vertices[2]};
+    float hi[3] = {lo[0], lo[1], lo[2]};
+    for(unsigned int v=0; v<vertices.size(); v+=3)
+    {
+        for(int a=0; a<3; ++a)
+        {
+            lo[a] = std::min(lo[a], vertices[v + a]);
+            hi[a] = std::max(hi[a], vertices[v + a]);
+        }
+    }
+    float longest = std::max(hi[0] - lo[0], std::max(hi[1] - lo[1], hi[2] - lo[2]));
+    if(!(longest > 0.0f))
+    {
+        // every vertex on one point (or a NaN in the file) gives no cell size to build the grid with
+        return false;
+    }
+    float pad = longest * header.m_padding;
+    header.m_cellSize = (longest + 2.0f * pad) / header.m_resolution;
+    for(int a=0; a<3; ++a)
+    {
+        header.m_origin[a] = lo[a] - pad;
+        header.m_size[a] = (int)std::ceil((hi[a] - lo[a] + 2.0f * pad) / header.m_cellSize) + 1;
+        header.m_size[a] = std::max(header.m_size[a], 2);
+    }
+
+    std::vector <float> grid;
+    bake(vertices, triangles, header, grid);
+    // map what was written so the baked and the cached fields are read the same way
+    if(writeCache(cachePath, header, grid) && mapCache(cachePath, header))
+    {
+        m_cachePath = cachePath;
+        m_fromCache = false;
+        return true;
+    }
+    release();
+    m_baked.swap(grid);
+    m_grid = &m_baked[0];
+    for(int a=0; a<3; ++a)
+    {
+        m_size[a] = header.m_size[a];
+        m_origin[a] = header.m_origin[a];
+    }
+    m_cellSize = header.m_cellSize;
+    m_invCellSize = 1.0f / m_cellSize;
+    m_cachePath.clear();
+    m_fromCache = false;
+    return true;
+}
+//----------------------------------------------------------------------------------------------------------------------
+bool Avoidance::readObj(const std::string &_file, std::vector <float> &_vertices, std::vector <int> &_triangles)
+{
+    FILE *file = std::fopen(_file.c_str(), "r");
+    if(file == 0)
+    {
+        return false;
+    }
+    char line[4096];
+    std::vector <int> face;
+    while(std::fgets(line, sizeof(line), file) != 0)
+    {
+        if(line[0] == 'v' && line[1] == ' ')
+        {
+            char *end = line + 2;
+            for(int a=0; a<3; ++a)
+            {
+                _vertices.push_back(std::strtof(end, &end));
+            }
+        }
+        else if(line[0] == 'f' && line[1] == ' ')
+        {
+            // a corner is v, v/vt, v//vn or v/vt/vn, only v is used. Negative indices count back from the end.
+            face.clear();
+            char *token = std::strtok(line + 2, " \t\r\n");
+            while(token != 0)
+            {
+                int index = std::atoi(token);
+                int count = (int)_vertices.size() / 3;
+                index = index < 0 ? count + index : index - 1;
+                if(index >= 0 && index < count)
+                {
+                    face.push_back(index);
+                }
+                token = std::strtok(0, " \t\r\n");
+            }
+            for(unsigned int i=2; i<face.size(); ++i)
+            {
+                _triangles.push_back(face[0]);
+                _triangles.push_back(face[i - 1]);
+                _triangles.push_back(face[i]);
+            }
+        }
+    }
+    std::fclose(file);
+    return !_vertices.empty();
+}
+//----------------------------------------------------------------------------------------------------------------------
+void Avoidance::bake(const std::vector <float> &_vertices, const std::vector <int> &_triangles, const CacheHeader &_header,
+                     std::vector <float> &_grid)
+{
+    const int nx = _header.m_size[0];
+    const int ny = _header.m_size[1];
+    const int nz = _header.m_size[2];
+    const float h = _header.m_cellSize;
+    const float *origin = _header.m_origin;
+    const int triangleCount = (int)_triangles.size() / 3;
+    const size_t points = (size_t)nx * ny * nz;
+    std::vector <float> distance(points, 3.0e30f);
+    std::vector <int> closest(points, -1);
+
+    // exact distances to the grid points around every triangle
+    for(int t=0; t<triangleCount; ++t)
+    {
+        const float *a = &_vertices[3 * _triangles[3 * t]];
+        const float *b = &_vertices[3 * _triangles[3 * t + 1]];
+        const float *c = &_vertices[3 * _triangles[3 * t + 2]];
+        int lo[3], hi[3];
+        for(int i=0; i<3; ++i)
+        {
+            float fmin = (std::min(a[i], std::min(b[i], c[i])) - origin[i]) / h;
+            float fmax = (std::max(a[i], std::max(b[i], c[i])) - origin[i]) / h;
+            lo[i] = std::max((int)std::floor(fmin) - s_exactBand, 0);
+            hi[i] = std::min((int)std::ceil(fmax) + s_exactBand, _header.m_size[i] - 1);
+        }
+        for(int k=lo[2]; k<=hi[2]; ++k)
+        {
+            for(int j=lo[1]; j<=hi[1]; ++j)
+            {
+                for(int i=lo[0]; i<=hi[0]; ++i)
+                {
+                    float p[3] = {origin[0] + i * h, origin[1] + j * h, origin[2] + k * h};
+                    float d = pointTriangleDistance(p, a, b, c);
+                    size_t n = (size_t)i + (size_t)nx * (j + (size_t)ny * k);
+                    if(d < distance[n])
+                    {
+                        distance[n] = d;
+                        closest[n] = t;
+                    }
+                }
+            }
+        }
+    }
+
+    // sweep the closest triangles out to the rest of the grid, every point tries the triangles of the
+    // neighbours it was reached from. Two rounds of the eight directions as in Bridson's makelevelset3.
+    for(int round=0; round<2; ++round)
+    {
+        for(int direction=0; direction<8; ++direction)
+        {
+            const int di = (direction & 1) ? -1 : 1;
+            const int dj = (direction & 2) ? -1 : 1;
+            const int dk = (direction & 4) ? -1 : 1;
+            for(int k=(dk > 0 ? 1 : nz - 2); k>=0 && k<nz; k+=dk)
+            {
+                for(int j=(dj > 0 ? 1 : ny - 2); j>=0 && j<ny; j+=dj)
+                {
+                    for(int i=(di > 0 ? 1 : nx - 2); i>=0 && i<nx; i+=di)
+                    {
+                        size_t n = (size_t)i + (size_t)nx * (j + (size_t)ny * k);
+                        float p[3] = {origin[0] + i * h, origin[1] + j * h, origin[2] + k * h};
+                        for(int neighbour=1; neighbour<8; ++neighbour)
+                        {
+                            int ni = i - ((neighbour & 1) ? di : 0);
+                            int nj = j - ((neighbour & 2) ? dj : 0);
+                            int nk = k - ((neighbour & 4) ? dk : 0);
+                            int t = closest[(size_t)ni + (size_t)nx * (nj + (size_t)ny * nk)];
+                            if(t < 0 || t == closest[n])
+                            {
+                                continue;
+                            }
+                            float d = pointTriangleDistance(p, &_vertices[3 * _triangles[3 * t]],
+                                                            &_vertices[3 * _triangles[3 * t + 1]],
+                                                            &_vertices[3 * _triangles[3 * t + 2]]);
+                            if(d < distance[n])
+                            {
+                                distance[n] = d;
+                                closest[n] = t;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    // the sign from the number of surface crossings of a ray running down x to every grid point, an odd
+    // count is inside. Each triangle adds a crossing to the first grid point past it on every ray it covers.
+    std::vector <int> crossings(points, 0);
+    for(int t=0; t<triangleCount; ++t)
+    {
+        double x[3], y[3], z[3];
+        for(int v=0; v<3; ++v)
+        {
+            const float *p = &_vertices[3 * _triangles[3 * t + v]];
+            x[v] = (p[0] - origin[0]) / h;
+            y[v] = (p[1] - origin[1]) / h - s_rayOffsetY;
+            z[v] = (p[2] - origin[2]) / h - s_rayOffsetZ;
+        }
+        int jlo = std::max((int)std::ceil(std::min(y[0], std::min(y[1], y[2]))), 0);
+        int jhi = std::min((int)std::floor(std::max(y[0], std::max(y[1], y[2]))), ny - 1);
+        int klo = std::max((int)std::ceil(std::min(z[0], std::min(z[1], z[2]))), 0);
+        int khi = std::min((int)std::floor(std::max(z[0], std::max(z[1], z[2]))), nz - 1);
+        for(int k=klo; k<=khi; ++k)
+        {
+            for(int j=jlo; j<=jhi; ++j)
+            {
+                // the signed areas of the ray point with each edge seen down x
+                double w0 = (y[1] - j) * (z[2] - k) - (y[2] - j) * (z[1] - k);
+                double w1 = (y[2] - j) * (z[0] - k) - (y[0] - j) * (z[2] - k);
+                double w2 = (y[0] - j) * (z[1] - k) - (y[1] - j) * (z[0] - k);
+                bool inside = (w0 > 0.0 && w1 > 0.0 && w2 > 0.0) || (w0 < 0.0 && w1 < 0.0 && w2 < 0.0);
+                if(!inside)
+                {
+                    continue;
+                }
+                double hit = (w0 * x[0] + w1 * x[1] + w2 * x[2]) / (w0 + w1 + w2);
+                int i = std::max((int)std::ceil(hit), 0);
+                if(i < nx)
+                {
+                    ++crossings[(size_t)i + (size_t)nx * (j + (size_t)ny * k)];
+                }
+            }
+        }
+    }
+    for(int k=0; k<nz; ++k)
+    {
+        for(int j=0; j<ny; ++j)
+        {
+            int total = 0;
+            for(int i=0; i<nx; ++i)
+            {
+                size_t n = (size_t)i + (size_t)nx * (j + (size_t)ny * k);
+                total += crossings[n];
+                if(total & 1)
+                {
+                    distance[n] = -distance[n];
+                }
+            }
+        }
+    }
+
+    // the gradient by central differences, one sided on the border of the grid
+    _grid.resize(points * 4);
+    const int stride[3] = {1, nx, nx * ny};
+    for(int k=0; k<nz; ++k)
+    {
+        for(int j=0; j<ny; ++j)
+        {
+            for(int i=0; i<nx; ++i)
+            {
+                const int coord[3] = {i, j, k};
+                size_t n = (size_t)i + (size_t)nx * (j + (size_t)ny * k);
+                float g[3];
+                for(int a=0; a<3; ++a)
+                {
+                    size_t lo = coord[a] > 0 ? n - stride[a] : n;
+                    size_t hi = coord[a] < _header.m_size[a] - 1 ? n + stride[a] : n;
+                    g[a] = (distance[hi] - distance[lo]) / (h * (float)((hi - lo) / stride[a]));
+                }
+                float length = std::sqrt(g[0] * g[0] + g[1] * g[1] + g[2] * g[2]);
+                float scale = length > 0.0f ? 1.0f / length : 0.0f;
+                _grid[4 * n] = distance[n];
+                _grid[4 * n + 1] = g[0] * scale;
+                _grid[4 * n + 2] = g[1] * scale;
+                _grid[4 * n + 3] = g[2] * scale;
+            }
+        }
+    }
+}
+//----------------------------------------------------------------------------------------------------------------------
+bool Avoidance::writeCache(const std::string &_file, const CacheHeader &_header, const std::vector <float> &_grid)
+{
+    std::string temporary = _file + ".tmp";
+    FILE *file = std::fopen(temporary.c_str(), "wb");
+    if(file == 0)
+    {
+        return false;
+    }
+    bool written = std::fwrite(&_header, sizeof(_header), 1, file) == 1 &&
+                   std::fwrite(&_grid[0], sizeof(float), _grid.size(), file) == _grid.size();
+    written = std::fclose(file) == 0 && written;
+    if(!written || std::rename(temporary.c_str(), _file.c_str()) != 0)
+    {
+        std::remove(temporary.c_str());
+        return false;
+    }
+    return true;
+}
+//----------------------------------------------------------------------------------------------------------------------
+bool Avoidance::mapCache(const std::string &_file, const CacheHeader &_expected)
+{
+    // the cache is mapped next to the current field, which is only let go once the new one checks out
+    MappedFile file;
+    if(!file.open(_file) || file.size() < sizeof(CacheHeader))
+    {
+        return false;
+    }
+    CacheHeader header;
+    std::memcpy(&header, file.data(), sizeof(header));
+    if(std::memcmp(header.m_magic, _expected.m_magic, 4) != 0 || header.m_version != _expected.m_version ||
+       header.m_resolution != _expected.m_resolution || header.m_padding != _expected.m_padding ||
+       header.m_sourceBytes != _expected.m_sourceBytes || header.m_sourceTime != _expected.m_sourceTime)
+    {
+        return false;
+    }
+    size_t points = (size_t)header.m_size[0] * header.m_size[1] * header.m_size[2];
+    size_t expectedBytes = sizeof(header) + points * 4 * sizeof(float);
+    if(header.m_size[0] < 2 || header.m_size[1] < 2 || header.m_size[2] < 2 || file.size() != expectedBytes)
+    {
+        return false;
+    }
+
+    release();
+    m_file.swap(file);
+    m_grid = (const float *)(m_file.data() + sizeof(header));
+    for(int a=0; a<3; ++a)
+    {
+        m_size[a] = header.m_size[a];
+        m_origin[a] = header.m_origin[a];
+    }
+    m_cellSize = header.m_cellSize;
+    m_invCellSize = 1.0f / m_cellSize;
+    return true;
+}
+//----------------------------------------------------------------------------------------------------------------------
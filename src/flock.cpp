@@ -1,239 +1,361 @@
 #include "flock.h"
+#include "Profiler.h"
+#include "Tracer.h"
+#include "PerfCounters.h"
 #include "boost/foreach.hpp"
-#include "ngl/Random.h"
-#include "QDebug"
-#include <ngl/Util.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
 
 
 
 //----------------------------------------------------------------------------------------------------------------------
-const static int s_extents=5;
 //----------------------------------------------------------------------------------------------------------------------
-Flock::Flock(ngl::BBox *bbox, Obstacle *obstacle)
+/// @brief the number of boids a worker takes at a time, large enough that the handing out is not noticed
+const static int s_grain=256;
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief how many radii away the boids react to an obstacle
+const static float s_obstacleReach=3.0f;
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief sphereSphereCollision reports a hit up to the square root of three times the summed radii, the
+/// broadphase boxes and queries are grown by the same factor so they never miss a hit.
+const static float s_hitScale=1.7320508f;
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the default margin of the neighbour lists over the behaviour radius
+const static float s_neighbourSkin=16.0f;
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the default number of neighbours of the topological mode, the seven starlings of Ballerini et al.
+const static int s_topologicalCount=7;
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the default opening angle of the approximate mode
+const static float s_openingAngle=0.5f;
+//----------------------------------------------------------------------------------------------------------------------
+Flock::Flock(float _width, float _height, float _depth, Obstacle *_obstacle, int _threads)
 {
-    m_behaviours = new Behaviours();
-    m_bbox = bbox;
+    m_pool = new ThreadPool(_threads);
+    m_behaviours.resize(m_pool->size());
     m_numberOfBoids = 200;
+    m_rngCounter = 0;
     m_checkSphereSphere=true;
-    m_obstacle = obstacle;
+    m_specialised = true;
+    m_obstacle = _obstacle;
+    m_obstacles = ObstacleSet(s_obstacleReach * s_hitScale);
+    m_obstacleId = -1;
+    m_avoidance = 0;
+    m_neighbourSkin = s_neighbourSkin;
+    m_neighbourMode = METRIC;
+    m_topologicalCount = s_topologicalCount;
+    m_openingAngle = s_openingAngle;
+    if(m_obstacle != 0)
+    {
+        m_obstacleId = m_obstacles.add(m_obstacle->getSpherePosition(), m_obstacle->getSphereRadius());
+    }
+
+    setBoxSize(_width, _height, _depth);
 
     resetBoids();
 }
 //----------------------------------------------------------------------------------------------------------------------
-
-void Flock::draw(const std::string &_shaderName, ngl::TransformStack &_transformStack, ngl::Camera *_cam)const
+void Flock::setBoxSize(float _width, float _height, float _depth)
 {
-    ngl::ShaderLib *shader=ngl::ShaderLib::instance();
-    shader->use(_shaderName);
-    _transformStack.pushTransform();
-
-    loadMatricesToShader(_transformStack, _cam);
-
+    m_boundary.setSize(_width, _height, _depth);
+}
+//----------------------------------------------------------------------------------------------------------------------
+Flock::~Flock()
+{
+    delete m_pool;
+}
+//----------------------------------------------------------------------------------------------------------------------
+void Flock::setThreadCount(int _threads)
+{
+    delete m_pool;
+    m_pool = new ThreadPool(_threads);
+    // the new behaviours take the settings of the first one, copied out as the resize may move it
+    const Behaviours first = m_behaviours[0];
+    m_behaviours.resize(m_pool->size(), first);
+}
+//----------------------------------------------------------------------------------------------------------------------
 
-    BOOST_FOREACH(Boid *b, m_boidList)
+void Flock::spawn(int _count, const SpawnDistribution &_distribution)
+{
+    // the size of the flock is an int, a count that would take it past that is cut down
+    _count = std::min(_count, std::numeric_limits<int>::max() - m_state.size());
+    if (_count <= 0)
     {
-        b->draw(_shaderName,_transformStack,_cam);
+        return;
     }
-
-    _transformStack.popTransform();
-    glPolygonMode(GL_FRONT_AND_BACK,GL_FILL);
-
+    int first = m_state.addBoids(_count);
+    // four numbers per boid, the fourth only used to pick the radius of a ball, then two per boid for the
+    // headings if they are drawn
+    const uint64_t counter = m_rngCounter;
+    const uint64_t headings = counter + 4 * (uint64_t)_count;
+    const float speed = _distribution.m_speed;
+    m_rngCounter += (speed > 0.0f ? 6 : 4) * (uint64_t)_count;
+    m_pool->parallelFor(_count, s_grain, [&](int _begin, int _end, int)
+    {
+        const ngl::Vector &c = _distribution.m_centre;
+        const float e = _distribution.m_extent;
+        for(int i=_begin; i<_end; ++i)
+        {
+            uint64_t n = counter + 4 * (uint64_t)i;
+            float x = m_rng.symmetric(n, 1.0f);
+            float y = m_rng.symmetric(n + 1, 1.0f);
+            float z = m_rng.symmetric(n + 2, 1.0f);
+            if (_distribution.m_shape == SpawnDistribution::BALL)
+            {
+                // a direction on the sphere pushed out by the cube root so the ball fills evenly
+                float length = std::sqrt(x * x + y * y + z * z);
+                float scale = length > 0.0f ? std::cbrt(m_rng.uniform(n + 3)) / length : 0.0f;
+                x *= scale;
+                y *= scale;
+                z *= scale;
+            }
+            m_state.m_posX[first + i] = c.m_x + x * e;
+            m_state.m_posY[first + i] = c.m_y + y * e;
+            m_state.m_posZ[first + i] = c.m_z + z * e;
+            if (speed > 0.0f)
+            {
+                // a direction on the sphere, z uniform in [-1, 1] and an angle around it
+                uint64_t h = headings + 2 * (uint64_t)i;
+                float hz = m_rng.symmetric(h, 1.0f);
+                float angle = m_rng.uniform(h + 1) * 6.2831853f;
+                float r = std::sqrt(std::max(0.0f, 1.0f - hz * hz));
+                m_state.m_velX[first + i] = r * std::cos(angle) * speed;
+                m_state.m_velY[first + i] = r * std::sin(angle) * speed;
+                m_state.m_velZ[first + i] = hz * speed;
+            }
+        }
+    });
+    m_numberOfBoids = m_state.size();
+    m_neighbourList.invalidate();
 }
-//----------------------------------------------------------------------------------------------------------------------
-void Flock::loadMatricesToShader(ngl::TransformStack &_tx, ngl::Camera *_cam) const
 
+//-----------------------------------------------------------------------------------------------------------------------
+void Flock::despawn(int _count)
 {
-    ngl::ShaderLib *shader = ngl::ShaderLib::instance();
-    ngl::Matrix MV;
-    ngl::Matrix MVP;
-    ngl::Mat3x3 normalMatrix;
-    ngl::Matrix M;
-
-    M = _tx.getCurrentTransform().getMatrix();
-    MV = _tx.getCurrAndGlobal().getMatrix() *_cam->getViewMatrix();
-    MVP = MV * _cam->getProjectionMatrix();
-    normalMatrix = MV;
-    normalMatrix.inverse();
-    shader->setShaderParamFromMatrix("MV", MV);
-    shader->setShaderParamFromMatrix("MVP", MVP);
-    shader->setShaderParamFromMat3x3("normalMatrix", normalMatrix);
-    shader->setShaderParamFromMatrix("M", M);
-
+    m_state.removeLast(std::max(0, _count));
+    m_numberOfBoids = m_state.size();
+    m_neighbourList.invalidate();
 }
 //-----------------------------------------------------------------------------------------------------------------------
-void Flock::addBoids()
+void Flock::removeBoid(int _index)
 {
-    if (m_numberOfBoids <= 1990)
+    if (_index >= 0 && _index < m_numberOfBoids)
     {
-        ngl::Random *rng=ngl::Random::instance();
-        ngl::Vector dir;
-        dir=rng->getRandomVector();
-        // add the spheres to the end of the particle list
-        for(int i=0; i<10; i++)
-        {
-            //std::cout<<"adding boid"<<endl;
-            m_boidList.push_back(new Boid(rng->getRandomPoint(s_extents,s_extents,s_extents),dir));
-
-            ++m_numberOfBoids;
-        }
+        m_state.swapRemove(_index);
+        --m_numberOfBoids;
+        m_neighbourList.invalidate();
     }
 }
-
 //-----------------------------------------------------------------------------------------------------------------------
-void Flock::removeBoids()
+void Flock::resetBoids(const SpawnDistribution &_distribution)
 {
-    if (m_numberOfBoids > 10)
+    // clear keeps the memory of the arrays, so resetting to the same size or smaller never allocates
+    int count = m_numberOfBoids;
+    m_state.clear();
+    // a spawn that runs out of memory then leaves an empty flock that still steps
+    m_numberOfBoids = 0;
+    m_neighbourList.invalidate();
+    spawn(count, _distribution);
+}
+//----------------------------------------------------------------------------------------------------------------------
+
+void Flock::update()
+{
+    FLOCK_PROFILE_SCOPE(UPDATE);
+    FLOCK_TRACE_SCOPE("update");
+    FLOCK_PERF_SCOPE(UPDATE);
+    bool obstacles;
+    {
+        // the collisions themselves are resolved in the steering pass, only the obstacles are refitted here
+        FLOCK_PROFILE_SCOPE(COLLISIONS);
+        FLOCK_TRACE_SCOPE("collisions");
+        FLOCK_PERF_SCOPE(COLLISIONS);
+        obstacles = refitObstacles();
+    }
+    const int rules = m_specialised ? m_behaviours[0].activeRules() : (int)SteerKernels::ALL_RULES;
+    for(unsigned int i=0; i<m_behaviours.size(); ++i)
+    {
+        if(m_behaviours[i].getRules() != rules)
+        {
+            m_behaviours[i].setRules(rules);
+        }
+    }
+    // the cells and the lists have to cover the largest radius of the rules in use
+    float radius = 0.0f;
+    if(rules & (SteerKernels::COHESION | SteerKernels::ALIGNMENT))
+    {
+        radius = m_behaviours[0].getBehaviourDistance();
+    }
+    if(rules & SteerKernels::SEPARATION)
+    {
+        radius = std::max(radius, (float)m_behaviours[0].getFlockDistance());
+    }
     {
-        for (int i = 0; i < 10; i++)
+        FLOCK_PROFILE_SCOPE(NEIGHBOURS);
+        FLOCK_TRACE_SCOPE("neighbours");
+        FLOCK_PERF_SCOPE(NEIGHBOURS);
+        if(rules == 0)
+        {
+            // nothing steers so no boid needs its neighbours
+        }
+        else if(m_neighbourMode == TOPOLOGICAL)
+        {
+            m_kdTree.build(m_state, *m_pool);
+        }
+        else if(m_neighbourMode == APPROXIMATE)
         {
-            m_boidList.pop_back();
-            --m_numberOfBoids;
+            m_octree.build(m_state, *m_pool);
+        }
+        else
+        {
+            // the lists give up on a flock too dense for them, the grid steers it until they fit again
+            if(m_neighbourSkin > 0.0f)
+            {
+                m_neighbourList.update(m_state, radius, m_neighbourSkin, *m_pool);
+            }
+            if(!useNeighbourList())
+            {
+                m_grid.rebuild(m_state, radius);
+            }
         }
     }
+    FLOCK_PROFILE_SCOPE(STEER);
+    FLOCK_TRACE_SCOPE("steer");
+    FLOCK_PERF_SCOPE(STEER);
+    m_next.resizeMotion(m_state.size());
+    const SteerPass pass = steerPass(rules, m_boundary.m_mode, obstacles);
+    m_pool->parallelFor(m_state.size(), s_grain, [this, pass](int _begin, int _end, int _worker)
+    {
+        (this->*pass)(_begin, _end, _worker);
+    });
+    m_state.swapMotion(m_next);
 }
-//-----------------------------------------------------------------------------------------------------------------------
-void Flock::resetBoids()
+//----------------------------------------------------------------------------------------------------------------------
+template <int Rules, Boundary::Mode Mode, bool Obstacles>
+void Flock::steerBoids(int _begin, int _end, int _worker)
 {
-    m_boidList.clear();
-    ngl::Vector dir;
-    ngl::Random *rng=ngl::Random::instance();
-    for(int i=0; i<m_numberOfBoids; ++i)
+    Behaviours &behaviours = m_behaviours[_worker];
+    for(int count=_begin; count<_end; ++count)
+    {
+        if(Rules == 0)
+        {
+            // without any rule the steering is 0 and the neighbours are never looked at
+        }
+        else if(m_neighbourMode == TOPOLOGICAL)
+        {
+            behaviours.Steer(count, m_state, m_kdTree, m_topologicalCount);
+        }
+        else if(m_neighbourMode == APPROXIMATE)
+        {
+            behaviours.Steer(count, m_state, m_octree, m_openingAngle);
+        }
+        else if(useNeighbourList())
+        {
+            behaviours.Steer(count, m_state, m_neighbourList);
+        }
+        else
+        {
+            behaviours.Steer(count, m_state, m_grid);
+        }
+        m_state.integrate(count, behaviours.steering<Rules>(count, m_state), m_next);
+    }
+    // the range was just written so the boundary and the obstacles find it in the cache
+    m_state.constrain<Mode>(_begin, _end, m_boundary, m_next);
+    if(Obstacles)
     {
-        dir=rng->getRandomVector();
-        m_boidList.push_back(new Boid(rng->getRandomPoint(s_extents,s_extents,s_extents),dir));
+        collideBoids(_begin, _end, m_next);
     }
 }
 //----------------------------------------------------------------------------------------------------------------------
-
-void Flock::update()
+/// @brief the steering passes of one set of rules, indexed by the boundary mode and the obstacles
+#define FLOCK_STEER_PASSES(_rules) \
+    {{&Flock::steerBoids<_rules, Boundary::REFLECT, false>, &Flock::steerBoids<_rules, Boundary::REFLECT, true>}, \
+     {&Flock::steerBoids<_rules, Boundary::CLAMP, false>, &Flock::steerBoids<_rules, Boundary::CLAMP, true>}, \
+     {&Flock::steerBoids<_rules, Boundary::WRAP, false>, &Flock::steerBoids<_rules, Boundary::WRAP, true>}}
+//----------------------------------------------------------------------------------------------------------------------
+Flock::SteerPass Flock::steerPass(int _rules, Boundary::Mode _mode, bool _obstacles)
 {
-    checkCollisions();
-    int count = 0;
-    BOOST_FOREACH(Boid *s,m_boidList)
+    static const SteerPass s_passes[SteerKernels::s_ruleSets][3][2] =
     {
-        m_behaviours->Cohesion(count, m_boidList);
-        m_behaviours->Alignment(count, m_boidList);
-        m_behaviours->Seperation(count, m_boidList);
-        m_behaviours->Destination(count,m_boidList);
-        s->updateVelocity(m_behaviours->BehaviourSetup());
-        s->velocityConstraint();
-        s->boidDirection();
-
-        count++;
-    }
+        FLOCK_STEER_PASSES(0), FLOCK_STEER_PASSES(1), FLOCK_STEER_PASSES(2), FLOCK_STEER_PASSES(3),
+        FLOCK_STEER_PASSES(4), FLOCK_STEER_PASSES(5), FLOCK_STEER_PASSES(6), FLOCK_STEER_PASSES(7)
+    };
+    return s_passes[_rules & SteerKernels::ALL_RULES][_mode][_obstacles ? 1 : 0];
 }
 //----------------------------------------------------------------------------------------------------------------------
 void Flock::setBoidSize(double size)
 {
-    BOOST_FOREACH(Boid *s,m_boidList)
-    {
-        s->setScale(size);
-    }
+    std::fill(m_state.m_scale.begin(), m_state.m_scale.end(), ngl::Vector(size, size, size));
 }
 //----------------------------------------------------------------------------------------------------------------------
 void Flock::setColour(ngl::Colour colour)
 {
-    BOOST_FOREACH(Boid *s,m_boidList)
-    {
-        s->setColour(colour);
-    }
+    std::fill(m_state.m_colour.begin(), m_state.m_colour.end(), colour);
 }
 //----------------------------------------------------------------------------------------------------------------------
 void Flock::setWireframe(bool value)
 {
-    BOOST_FOREACH(Boid *s,m_boidList)
-    {
-        s->setWireframe(value);
-    }
+    std::fill(m_state.m_wireframe.begin(), m_state.m_wireframe.end(), value);
 }
 //----------------------------------------------------------------------------------------------------------------------
 void Flock::setSimDistance(double distance)
 {
-    m_behaviours->setBehaviourDistance(distance);
+    for(unsigned int i=0; i<m_behaviours.size(); ++i)
+    {
+        m_behaviours[i].setBehaviourDistance(distance);
+    }
 }
 //----------------------------------------------------------------------------------------------------------------------
 void Flock::setSimFlockDistance(double distance)
 {
-    m_behaviours->setFlockDistance(distance);
+    for(unsigned int i=0; i<m_behaviours.size(); ++i)
+    {
+        m_behaviours[i].setFlockDistance(distance);
+    }
 }
 //----------------------------------------------------------------------------------------------------------------------
 void Flock::setSimCohesion(double cohesion)
 {
-    m_behaviours->setCohesionForce(cohesion);
+    for(unsigned int i=0; i<m_behaviours.size(); ++i)
+    {
+        m_behaviours[i].setCohesionForce(cohesion);
+    }
 }
 //----------------------------------------------------------------------------------------------------------------------
 void Flock::setSimSeparation(double separation)
 {
-    m_behaviours->setSeparationForce(separation);
+    for(unsigned int i=0; i<m_behaviours.size(); ++i)
+    {
+        m_behaviours[i].setSeparationForce(separation);
+    }
 }
 //----------------------------------------------------------------------------------------------------------------------
 void Flock::setSimAlignment(double alignment)
 {
-    m_behaviours->setAlignment(alignment);
-}
-//----------------------------------------------------------------------------------------------------------------------
-
-/// The following section is modified from :-
-/// John Macey(2011).Collisions Example, BoundingBox. [Accessed 2012]
-/// Available from: bzr branch http://nccastaff.bournemouth.ac.uk/jmacey/Code/Collisions
-void Flock::validateBoundingBoxCollision()
-{
-    //create an array of the extents of the bounding box
-    float ext[6];
-    ext[0]=ext[1]=(m_bbox->height()/2.0f);
-    ext[2]=ext[3]=(m_bbox->width()/2.0f);
-    ext[4]=ext[5]=(m_bbox->depth()/2.0f);
-    // Dot product needs a Vector so we convert The Point Temp into a Vector so we can
-    // do a dot product on it
-    ngl::Vector point;
-    // D is the distance of the Agent from the Plane. If it is less than ext[i] then there is
-    // no collision
-    GLfloat Distance;
-    // Loop for each sphere in the vector list
-    BOOST_FOREACH(Boid *s, m_boidList)
+    for(unsigned int i=0; i<m_behaviours.size(); ++i)
     {
-        point=s->getPosition();
-        //Now we need to check the Sphere agains all 6 planes of the BBOx
-        //If a collision is found we change the dir of the Sphere then Break
-        for(int i=0; i<6; ++i)
-        {
-            //to calculate the distance we take the dotporduct of the Plane Normal
-            //with the new point P
-            Distance=m_bbox->getNormalArray()[i].dot(point);
-            //Now Add the Radius of the sphere to the offsett
-            Distance+=s->getSize();
-            // If this is greater or equal to the BBox extent /2 then there is a collision
-            //So we calculate the Spheres new direction
-            if(Distance >=ext[i])
-            {
-                //We use the same calculation as in raytracing to determine the
-                // the new direction
-                GLfloat x= 2*( s->getVelocity().dot((m_bbox->getNormalArray()[i])));
-                ngl::Vector d =m_bbox->getNormalArray()[i]*x;
-                s->setVelocity(s->getNextPosition()-d * 5.0);
-                s->isHit();
-            }//end of hit test
-        }//end of each face test
-    }//end of for
+        m_behaviours[i].setAlignment(alignment);
+    }
 }
-/// end of Citation
 //----------------------------------------------------------------------------------------------------------------------
+
 /// The following section is modified from :-
 /// John Macey(2011).Collisions Example, BoundingBox. [Accessed 2012]
 /// Available from: bzr branch http://nccastaff.bournemouth.ac.uk/jmacey/Code/Collisions
 bool Flock::sphereSphereCollision(
         ngl::Vector _pos,
-        GLfloat _rad,
+        float _rad,
         ngl::Vector _pos1,
-        GLfloat _rad1
+        float _rad1
         )
 {
     // the relative position of the spheres
     ngl::Vector relPos;
     //min an max distances of the spheres
-    GLfloat dist;
-    GLfloat minDist;
-    GLfloat len;
+    float dist;
+    float minDist;
+    float len;
     relPos =_pos-_pos1;
     // and the distance
     len=relPos.length();
@@ -251,54 +373,104 @@ bool Flock::sphereSphereCollision(
 }
 /// end of citation
 //----------------------------------------------------------------------------------------------------------------------
-void  Flock::checkSphereCollisions()
+bool Flock::refitObstacles()
 {
-    bool collide;
-    unsigned int size=m_boidList.size();
-
+    if(m_obstacleId >= 0)
     {
-        for(unsigned int Current=0; Current<size; ++Current)
+        // the GUI moves and resizes its obstacle directly, only the boxes above it are refitted
+        m_obstacles.move(m_obstacleId, m_obstacle->getSpherePosition());
+        m_obstacles.setRadius(m_obstacleId, m_obstacle->getSphereRadius());
+    }
+    m_obstacles.update();
+    return (m_checkSphereSphere && m_obstacles.size() > 0) || (m_avoidance != 0 && m_avoidance->isLoaded());
+}
+//----------------------------------------------------------------------------------------------------------------------
+void  Flock::checkSphereCollisions(int _begin, int _end, FlockState &_target)
+{
+    // the first boid never collides with the obstacle
+    for(int Current=std::max(_begin, 1); Current<_end; ++Current)
+    {
+        // only the obstacles whose boxes the boid touches are tested
+        m_obstacles.query(_target.getPosition(Current), m_state.m_size[Current] * s_hitScale, [&](int _obstacle)
         {
-            if(Current)
-
-            {
-                collide =sphereSphereCollision(
-
-                            m_boidList.at(Current)->getPosition(),m_boidList.at(Current)->getSize(),
-                            m_obstacle->getSpherePosition(),m_obstacle->getSphereRadius() * 3.0
+            ngl::Vector spherePosition = m_obstacles.getCentre(_obstacle);
+            float sphereRadius = m_obstacles.getRadius(_obstacle);
+            bool collide =sphereSphereCollision(
 
-                            );
+                        _target.getPosition(Current),m_state.m_size[Current],
+                        spherePosition,sphereRadius * s_obstacleReach
 
-                if(collide)
-                {
-                    m_boidList.at(Current)->reverse();
-                    m_boidList.at(Current)->setHit();
+                        );
 
-                    ngl::Vector v = m_boidList.at(Current)->getPosition() - m_obstacle->getSpherePosition();
-                    GLfloat l = v.length();
+            if(collide)
+            {
+                // reverse the boid, the next position of a boid always sat at the origin
+                _target.m_velX[Current] = _target.m_newDirX[Current] * -20.0f;
+                _target.m_velY[Current] = _target.m_newDirY[Current] * -20.0f;
+                _target.m_velZ[Current] = _target.m_newDirZ[Current] * -20.0f;
+                m_state.m_hit[Current] = true;
 
+                ngl::Vector v = _target.getPosition(Current) - spherePosition;
+                float l = v.length();
 
-                    if (l <m_obstacle->getSphereRadius())
-                    {
 
-                        m_boidList.at(Current)->setPosition(v * (m_obstacle->getSphereRadius() - l));
-                        v.normalize();
-                    }
+                if (l <sphereRadius)
+                {
+                    _target.setPosition(Current, v * (sphereRadius - l));
                 }
+            }
+        });
+    }
+}
+//----------------------------------------------------------------------------------------------------------------------
+void  Flock::checkMeshCollisions(int _begin, int _end, FlockState &_target)
+{
+    const Avoidance &field = *m_avoidance;
+    ngl::Vector outwards;
+    for(int Current=_begin; Current<_end; ++Current)
+    {
+        float distance = field.sample(_target.getPosition(Current), outwards);
+        // the boids turn back as they come within their reach of the mesh, the same as the sphere
+        if(distance < m_state.m_size[Current] * s_obstacleReach)
+        {
+            _target.m_velX[Current] = _target.m_newDirX[Current] * -20.0f;
+            _target.m_velY[Current] = _target.m_newDirY[Current] * -20.0f;
+            _target.m_velZ[Current] = _target.m_newDirZ[Current] * -20.0f;
+            m_state.m_hit[Current] = true;
 
+            // a boid touching or inside the mesh is put back on its surface
+            float depth = m_state.m_size[Current] - distance;
+            if(depth > 0.0f)
+            {
+                _target.m_posX[Current] += outwards.m_x * depth;
+                _target.m_posY[Current] += outwards.m_y * depth;
+                _target.m_posZ[Current] += outwards.m_z * depth;
             }
         }
     }
 }
 //----------------------------------------------------------------------------------------------------------------------
+void Flock::collideBoids(int _begin, int _end, FlockState &_target)
+{
+    if(m_checkSphereSphere == true && m_obstacles.size() > 0)
+    {
+        checkSphereCollisions(_begin, _end, _target);
+    }
+    if(m_avoidance != 0 && m_avoidance->isLoaded())
+    {
+        checkMeshCollisions(_begin, _end, _target);
+    }
+}
+//----------------------------------------------------------------------------------------------------------------------
 void  Flock::checkCollisions()
 {
-    if(m_checkSphereSphere == true)
+    if(!refitObstacles())
     {
-        checkSphereCollisions();
+        return;
     }
-
-    validateBoundingBoxCollision();
+    m_pool->parallelFor(m_state.size(), s_grain, [this](int _begin, int _end, int)
+    {
+        collideBoids(_begin, _end, m_state);
+    });
 }
 //----------------------------------------------------------------------------------------------------------------------
-
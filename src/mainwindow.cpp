@@ -1,5 +1,6 @@
 #include "include/mainwindow.h"
 #include "ui_mainwindow.h"
+#include "Profiler.h"
 
 MainWindow::MainWindow(QWidget *parent) :
     QMainWindow(parent),
@@ -9,6 +10,10 @@ MainWindow::MainWindow(QWidget *parent) :
     m_gl = new GLWindow(this);
     m_ui->s_mainWindowGridLayout->addWidget(m_gl, 0, 0 ,2, 1);
     this->setWindowTitle(QString("Swarm Flock"));
+    // the slider follows the replay as it plays
+    connect(m_gl, SIGNAL(replayFrameChanged(int)), m_ui->m_replayFrame, SLOT(setValue(int)));
+    connect(m_gl, SIGNAL(flockOutOfMemory(int)), this, SLOT(flockOutOfMemory(int)));
+    connect(m_gl, SIGNAL(recordingFailed()), this, SLOT(recordingFailed()));
 
 
 }
@@ -20,20 +25,8 @@ MainWindow::~MainWindow()
 
 void MainWindow::on_m_flockDensity_valueChanged(int arg1)
 {
-    if (arg1 != m_gl->getCurrentBoidSize() && arg1 != m_gl->getCurrentBoidSize())
-        m_ui->m_applyFlock->setEnabled(true);
-    else
-        m_ui->m_applyFlock->setEnabled(false);
-
-    if (m_gl->getCurrentBoidSize() > 1990)
-        m_ui->m_addBoids->setEnabled(false);
-    else
-        m_ui->m_addBoids->setEnabled(true);
-
-    if (m_gl->getCurrentBoidSize() < 10)
-        m_ui->m_removeBoids->setEnabled(false);
-    else
-        m_ui->m_removeBoids->setEnabled(true);
+    m_ui->m_applyFlock->setEnabled(arg1 != m_gl->getCurrentBoidSize());
+    m_ui->m_removeBoids->setEnabled(m_gl->getCurrentBoidSize() > 0);
 }
 
 void MainWindow::on_m_resetFlock_clicked()
@@ -45,38 +38,24 @@ void MainWindow::on_m_resetFlock_clicked()
 
 void MainWindow::on_m_applyFlock_clicked()
 {
+    // the flock is rebuilt on the simulation thread so even a large count does not hold up the GUI
     m_gl->applyFlock(m_ui->m_flockDensity->value());
     m_ui->m_applyFlock->setEnabled(false);
-
-    if (m_gl->getCurrentBoidSize() > 1990)
-        m_ui->m_addBoids->setEnabled(false);
-    else
-        m_ui->m_addBoids->setEnabled(true);
-
-    if (m_gl->getCurrentBoidSize() < 30)
-        m_ui->m_removeBoids->setEnabled(false);
-    else
-        m_ui->m_removeBoids->setEnabled(true);
+    m_ui->m_removeBoids->setEnabled(m_gl->getCurrentBoidSize() > 0);
 }
 
 void MainWindow::on_m_addBoids_clicked()
 {
-    if (m_gl->getCurrentBoidSize() <= 1990)
-    {
-        m_ui->m_flockDensity->setValue(m_ui->m_flockDensity->value() + 10);
-        m_gl->addBoidsToFlock();
-        m_ui->m_applyFlock->setEnabled(false);
-    }
+    m_gl->addBoidsToFlock();
+    m_ui->m_flockDensity->setValue(m_gl->getCurrentBoidSize());
+    m_ui->m_applyFlock->setEnabled(false);
 }
 
 void MainWindow::on_m_removeBoids_clicked()
 {
-    if (m_gl->getCurrentBoidSize() > 30)
-    {
-        m_ui->m_flockDensity->setValue(m_ui->m_flockDensity->value() - 10);
-        m_gl->removeBoidsFromFlock();
-        m_ui->m_applyFlock->setEnabled(false);
-    }
+    m_gl->removeBoidsFromFlock();
+    m_ui->m_flockDensity->setValue(m_gl->getCurrentBoidSize());
+    m_ui->m_applyFlock->setEnabled(false);
 }
 
 void MainWindow::on_m_changeBoidSize_valueChanged(double arg1)
@@ -160,6 +139,16 @@ void MainWindow::on_m_simAlignment_valueChanged(double arg1)
     m_gl->setSimAlignment(arg1);
 }
 
+void MainWindow::on_m_simTopological_toggled(bool checked)
+{
+    m_gl->setSimTopological(checked);
+}
+
+void MainWindow::on_m_simNeighbourCount_valueChanged(int arg1)
+{
+    m_gl->setSimNeighbourCount(arg1);
+}
+
 void MainWindow::on_m_backColour_clicked()
 {
     QColor colour = QColorDialog::getColor();
@@ -175,3 +164,110 @@ void MainWindow::on_m_bboxSize_valueChanged(double arg1)
 
     m_gl->setBBoxSize(size);
 }
+
+void MainWindow::on_m_record_toggled(bool checked)
+{
+    if(!checked)
+    {
+        m_gl->stopRecording();
+        return;
+    }
+    QString file = QFileDialog::getSaveFileName(this, "Record Trajectory", QString(), "Trajectories (*.ftrj)");
+    if(file.isEmpty())
+    {
+        m_ui->m_record->blockSignals(true);
+        m_ui->m_record->setChecked(false);
+        m_ui->m_record->blockSignals(false);
+        return;
+    }
+    m_gl->startRecording(file.toStdString());
+}
+
+void MainWindow::on_m_replay_toggled(bool checked)
+{
+    if(!checked)
+    {
+        m_gl->closeReplay();
+        m_ui->m_replayFrame->setEnabled(false);
+        return;
+    }
+    QString file = QFileDialog::getOpenFileName(this, "Replay Trajectory", QString(), "Trajectories (*.ftrj)");
+    if(file.isEmpty() || !m_gl->openReplay(file.toStdString()))
+    {
+        m_ui->m_replay->blockSignals(true);
+        m_ui->m_replay->setChecked(false);
+        m_ui->m_replay->blockSignals(false);
+        return;
+    }
+    m_ui->m_replayFrame->setRange(0, m_gl->getReplayFrameCount() - 1);
+    m_ui->m_replayFrame->setValue(0);
+    m_ui->m_replayFrame->setEnabled(true);
+}
+
+void MainWindow::on_m_replayFrame_sliderMoved(int position)
+{
+    m_gl->setReplayFrame(position);
+}
+
+void MainWindow::on_m_saveSnapshot_clicked()
+{
+    QString file = QFileDialog::getSaveFileName(this, "Save Snapshot", QString(), "Snapshots (*.fsnp)");
+    if(!file.isEmpty())
+    {
+        m_gl->saveSnapshot(file.toStdString());
+    }
+}
+
+void MainWindow::on_m_loadSnapshot_clicked()
+{
+    QString file = QFileDialog::getOpenFileName(this, "Load Snapshot", QString(), "Snapshots (*.fsnp)");
+    SnapshotHeader header;
+    if(file.isEmpty() || !Flock::readSnapshotHeader(file.toStdString(), header))
+    {
+        return;
+    }
+    // the widgets hand the settings to the GUI obstacle and box as well, the load then brings in the boids
+    const SnapshotSettings &settings = header.m_settings;
+    m_ui->m_simDistance->setValue(settings.m_behaviourDistance);
+    m_ui->m_simFlockDistance->setValue(settings.m_flockDistance);
+    m_ui->m_simCohesion->setValue(settings.m_cohesion);
+    m_ui->m_simSeparation->setValue(settings.m_separation);
+    m_ui->m_simAlignment->setValue(settings.m_alignment);
+    m_ui->m_simTopological->setChecked(settings.m_neighbourMode == Flock::TOPOLOGICAL);
+    m_ui->m_simNeighbourCount->setValue(settings.m_topologicalCount);
+    if(settings.m_hasObstacle)
+    {
+        m_ui->m_obstaclePosX->setValue(settings.m_obstacleX);
+        m_ui->m_obstaclePosY->setValue(settings.m_obstacleY);
+        m_ui->m_obstaclePosZ->setValue(settings.m_obstacleZ);
+        m_ui->m_obstacleSize->setValue(settings.m_obstacleRadius);
+    }
+    m_ui->m_bboxSize->setValue(settings.m_boxWidth);
+    m_gl->loadSnapshot(file.toStdString(), (int)header.m_boids);
+    m_ui->m_flockDensity->setValue(m_gl->getCurrentBoidSize());
+}
+
+void MainWindow::on_m_dumpProfile_clicked()
+{
+    // without FLOCK_PROFILE the phases are empty and the file says the profiler is not enabled
+    QString file = QFileDialog::getSaveFileName(this, "Dump Profile", QString(), "JSON (*.json)");
+    if(!file.isEmpty())
+    {
+        Profiler::instance().writeJson(file.toStdString());
+    }
+}
+
+void MainWindow::flockOutOfMemory(int boids)
+{
+    m_ui->m_flockDensity->setValue(boids);
+    m_ui->m_applyFlock->setEnabled(false);
+    statusBar()->showMessage(QString("Out of memory, the flock kept %1 boids").arg(boids), 10000);
+}
+
+void MainWindow::recordingFailed()
+{
+    m_ui->m_record->blockSignals(true);
+    m_ui->m_record->setChecked(false);
+    m_ui->m_record->blockSignals(false);
+    statusBar()->showMessage("The recording could not be written in full, check the free disk space", 10000);
+}